@@ -0,0 +1,233 @@
+/*
+ * json_codec_bench.c
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ *
+ * Microbenchmarks for the JSON codec in ring_webview_json.h. Runs the corpus
+ * in benchmarks/json_corpus through json_decode_to_ring_list() and
+ * ring_list_to_json_string() inside an embedded Ring state; no window or
+ * display is needed.
+ *
+ * Usage: json_codec_bench [corpus_dir] [--json]
+ */
+
+#include "ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ring_webview_json.h"
+
+#define BENCH_MIN_ITERATIONS 5
+#define BENCH_MIN_TIME_NS 200000000.0
+
+static const char *aCorpus[] = {"small_args.json", "form_object.json", "chart_series.json", "file_listing.json",
+								"deep_tree.json"};
+
+/* Allocation counting. On glibc the executable's malloc family interposes
+ * the C library's, so allocations made inside libring are counted too. Ring
+ * serves small blocks from its own pool, so only blocks that reach the
+ * system allocator show up. */
+#if defined(__GLIBC__)
+#define BENCH_COUNT_ALLOCS 1
+extern void *__libc_malloc(size_t nSize);
+extern void *__libc_calloc(size_t nCount, size_t nSize);
+extern void *__libc_realloc(void *pPtr, size_t nSize);
+extern void __libc_free(void *pPtr);
+
+static volatile unsigned long long nBenchAllocs = 0;
+
+void *malloc(size_t nSize)
+{
+	nBenchAllocs++;
+	return __libc_malloc(nSize);
+}
+
+void *calloc(size_t nCount, size_t nSize)
+{
+	nBenchAllocs++;
+	return __libc_calloc(nCount, nSize);
+}
+
+void *realloc(void *pPtr, size_t nSize)
+{
+	nBenchAllocs++;
+	return __libc_realloc(pPtr, nSize);
+}
+
+void free(void *pPtr)
+{
+	__libc_free(pPtr);
+}
+#else
+#define BENCH_COUNT_ALLOCS 0
+static unsigned long long nBenchAllocs = 0;
+#endif
+
+typedef struct BenchResult
+{
+	double nIterations;
+	double nNsPerOp;
+	double nNsPerByte;
+	double nAllocsPerOp;
+} BenchResult;
+
+static double bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static char *bench_read_file(const char *cPath, size_t *pSize)
+{
+	FILE *pFile = fopen(cPath, "rb");
+	if (pFile == NULL)
+	{
+		return NULL;
+	}
+	fseek(pFile, 0, SEEK_END);
+	long nSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	char *cData = (char *)malloc((size_t)nSize + 1);
+	if (cData == NULL || fread(cData, 1, (size_t)nSize, pFile) != (size_t)nSize)
+	{
+		free(cData);
+		fclose(pFile);
+		return NULL;
+	}
+	cData[nSize] = '\0';
+	fclose(pFile);
+	*pSize = (size_t)nSize;
+	return cData;
+}
+
+// Decoded lists live in the VM's temporary memory; drop them between runs.
+static void bench_clear_temp(VM *pVM)
+{
+	ring_list_deleteallitems_gc(pVM->pRingState, pVM->pTempMem);
+}
+
+static BenchResult bench_decode(VM *pVM, const char *cJson, size_t nBytes)
+{
+	BenchResult oResult;
+	double nIterations = 0, nElapsed = 0;
+	unsigned long long nAllocs = 0;
+
+	while (nIterations < BENCH_MIN_ITERATIONS || nElapsed < BENCH_MIN_TIME_NS)
+	{
+		unsigned long long nAllocsBefore = nBenchAllocs;
+		double nStart = bench_now_ns();
+		List *pList = json_decode_to_ring_list(pVM, cJson);
+		nElapsed += bench_now_ns() - nStart;
+		nAllocs += nBenchAllocs - nAllocsBefore;
+		if (pList == NULL)
+		{
+			fprintf(stderr, "decode failed\n");
+			exit(1);
+		}
+		bench_clear_temp(pVM);
+		nIterations++;
+	}
+
+	oResult.nIterations = nIterations;
+	oResult.nNsPerOp = nElapsed / nIterations;
+	oResult.nNsPerByte = oResult.nNsPerOp / (double)nBytes;
+	oResult.nAllocsPerOp = (double)nAllocs / nIterations;
+	return oResult;
+}
+
+static BenchResult bench_encode(VM *pVM, const char *cJson, size_t *pOutBytes)
+{
+	BenchResult oResult;
+	double nIterations = 0, nElapsed = 0;
+	unsigned long long nAllocs = 0;
+
+	List *pList = json_decode_to_ring_list(pVM, cJson);
+	*pOutBytes = 0;
+	while (nIterations < BENCH_MIN_ITERATIONS || nElapsed < BENCH_MIN_TIME_NS)
+	{
+		unsigned long long nAllocsBefore = nBenchAllocs;
+		double nStart = bench_now_ns();
+		char *cOut = ring_list_to_json_string(pVM->pRingState, pList);
+		nElapsed += bench_now_ns() - nStart;
+		nAllocs += nBenchAllocs - nAllocsBefore;
+		if (cOut == NULL)
+		{
+			fprintf(stderr, "encode failed\n");
+			exit(1);
+		}
+		*pOutBytes = strlen(cOut);
+		free(cOut);
+		nIterations++;
+	}
+	bench_clear_temp(pVM);
+
+	oResult.nIterations = nIterations;
+	oResult.nNsPerOp = nElapsed / nIterations;
+	oResult.nNsPerByte = oResult.nNsPerOp / (double)(*pOutBytes ? *pOutBytes : 1);
+	oResult.nAllocsPerOp = (double)nAllocs / nIterations;
+	return oResult;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *cCorpusDir = "benchmarks/json_corpus";
+	int bJson = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--json") == 0)
+			bJson = 1;
+		else
+			cCorpusDir = argv[i];
+	}
+
+	RingState *pRingState = ring_state_init();
+	VM *pVM = pRingState->pVM;
+
+	if (bJson)
+		printf("{\"allocs_counted\":%s,\"results\":[", BENCH_COUNT_ALLOCS ? "true" : "false");
+	else
+		printf("%-18s %9s  %12s %9s %10s  %12s %9s %10s\n", "payload", "bytes", "decode ns/op", "ns/byte",
+			   "allocs/op", "encode ns/op", "ns/byte", "allocs/op");
+
+	int nFiles = (int)(sizeof(aCorpus) / sizeof(aCorpus[0]));
+	for (int i = 0; i < nFiles; i++)
+	{
+		char cPath[1024];
+		size_t nBytes = 0, nOutBytes = 0;
+		snprintf(cPath, sizeof(cPath), "%s/%s", cCorpusDir, aCorpus[i]);
+		char *cJson = bench_read_file(cPath, &nBytes);
+		if (cJson == NULL)
+		{
+			fprintf(stderr, "cannot read %s\n", cPath);
+			ring_state_delete(pRingState);
+			return 1;
+		}
+
+		BenchResult oDecode = bench_decode(pVM, cJson, nBytes);
+		BenchResult oEncode = bench_encode(pVM, cJson, &nOutBytes);
+
+		if (bJson)
+			printf("%s\n{\"payload\":\"%s\",\"bytes\":%zu,"
+				   "\"decode\":{\"ns_per_op\":%.0f,\"ns_per_byte\":%.3f,\"allocs_per_op\":%.1f},"
+				   "\"encode\":{\"ns_per_op\":%.0f,\"ns_per_byte\":%.3f,\"allocs_per_op\":%.1f}}",
+				   i ? "," : "", aCorpus[i], nBytes, oDecode.nNsPerOp, oDecode.nNsPerByte, oDecode.nAllocsPerOp,
+				   oEncode.nNsPerOp, oEncode.nNsPerByte, oEncode.nAllocsPerOp);
+		else
+			printf("%-18s %9zu  %12.0f %9.3f %10.1f  %12.0f %9.3f %10.1f\n", aCorpus[i], nBytes, oDecode.nNsPerOp,
+				   oDecode.nNsPerByte, oDecode.nAllocsPerOp, oEncode.nNsPerOp, oEncode.nNsPerByte,
+				   oEncode.nAllocsPerOp);
+		free(cJson);
+	}
+
+	if (bJson)
+		printf("\n]}\n");
+	else if (!BENCH_COUNT_ALLOCS)
+		printf("\nAllocation counts need glibc; they are reported as 0 here.\n");
+
+	ring_state_delete(pRingState);
+	return 0;
+}
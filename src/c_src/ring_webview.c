@@ -7,7 +7,14 @@
 
 #include "ring.h"
 
+#include "ring_webview_cache.h"
 #include "ring_webview_json.h"
+#include "ring_webview_map.h"
+#include "ring_webview_process.h"
+#include "ring_webview_record.h"
+#include "ring_webview_stats.h"
+#include "ring_webview_trace.h"
+#include "ring_webview_watchdog.h"
 
 #include "webview/version.h"
 #include "webview/webview.h"
@@ -22,14 +29,27 @@
 #define WEBVIEW_PLATFORM_UNIX
 #include <adwaita.h>
 #include <gtk/gtk.h>
+#ifdef RING_WEBVIEW_UNIX_PRINT
+#include <gtk/gtkunixprint.h>
+#endif
 #include <webkit/webkit.h>
 #endif
 
+typedef struct RingWebViewGeometry
+{
+	// Set once the toolkit has reported a size; until then it is queried.
+	int bKnown;
+	int nWidth;
+	int nHeight;
+} RingWebViewGeometry;
+
 typedef struct RingWebView
 {
 	webview_t webview;
 	RingState *pMainRingState;
 	int bRunning;
+	// Set by terminate() or when the window closes; webview_step() then returns -1.
+	int bStopped;
 #ifdef WEBVIEW_PLATFORM_UNIX
 	GdkDevice *pLastDevice;
 	GdkSurface *pLastSurface;
@@ -38,7 +58,49 @@ typedef struct RingWebView
 	double dLastX;
 	double dLastY;
 	gboolean bHasClickData;
+	// Toplevel we created for a headless or pooled webview, NULL otherwise.
+	GtkWidget *pOwnedWindow;
+	struct RingWebViewSnapshot *pSnapshots;
+	struct RingWebViewSnapshotBatch *pSnapshotBatch;
+	double nSnapshotId;
+	struct RingWebViewPdfJob *pPdfJobs;
+	struct RingWebViewPdfBatch *pPdfBatch;
+	double nPdfId;
+	struct RingWebViewMemoryRelease *pMemoryRelease;
+	// Background policy, see ring_webview_update_visibility().
+	int nBackgroundPolicy;
+	int nVisibility;
+	int nReportedVisibility;
+	int bBackgroundScript;
+	guint nVisibilitySource;
+	guint nThrottleSource;
+	GdkSurface *pStateSurface;
+	gulong nStateHandler;
+	gulong nLayoutHandler;
+	// Window size kept up to date from the surface, see ring_webview_note_size().
+	RingWebViewGeometry oGeometry;
+	// Size last passed to onResize, and when; nResizeSource holds back the next one.
+	int nReportedWidth;
+	int nReportedHeight;
+	double nResizeReportedMs;
+	guint nResizeSource;
+	// Guards the held dispatches, which other threads add to.
+	RingWebViewMutex oHeldMutex;
+	struct RingWebViewDispatch *pHeld;
+	double nHeldDispatches;
+	double nCoalescedDispatches;
+#endif
+#ifdef WEBVIEW_PLATFORM_MACOS
+	// Set by NSWindowWillCloseNotification; webview_step() then stops the webview.
+	int bClosed;
+	void *pCloseObserver;
 #endif
+	int bHeadless;
+	int bDebug;
+	// Release memory whenever hide() or minimize() is called.
+	int bLowMemory;
+	// Minimum time between two onResize calls, see webview_set_resize_interval().
+	int nResizeIntervalMs;
 	char *cOnClose;
 	char *cOnResize;
 	char *cOnFocus;
@@ -46,20 +108,186 @@ typedef struct RingWebView
 	char *cOnLoad;
 	char *cOnNavigate;
 	char *cOnTitle;
+	char *cOnStall;
+	char *cOnMemory;
+	char *cOnVisibility;
+	char *cOnPostError;
+	struct RingWebViewBind *pBinds;
+	RingWebViewMap *pBindMap;
+	unsigned int nLiveBinds;
+	struct RingWebViewTimer *pTimers;
+	double nTimerId;
+	// Id for webview_post(); every webview is listed in oRingWebViewWorkers.pWindows.
+	double nWindowId;
+	struct RingWebView *pNextWindow;
+	// Own Ring state and thread for bound functions, see webview_set_isolated().
+	struct RingWebViewIsolate *pIsolate;
+	double nLiveBindBytes;
+	int bStats;
+	RingWebViewMap *pStatsMap;
+	int bRouted;
+	int bRouterInstalled;
+	// Calls still waiting, newest first; cancelled ones are kept apart, oldest first.
+	struct RingWebViewPendingCall *pPendingCalls;
+	struct RingWebViewPendingCall *pPendingTail;
+	struct RingWebViewPendingCall *pCancelledCalls;
+	struct RingWebViewPendingCall *pCancelledTail;
+	// Both lists by call id, and by the token ringCall() gave the call.
+	RingWebViewMap *pPendingMap;
+	RingWebViewMap *pCallTokens;
+	unsigned int nPendingCalls;
+	unsigned int nCancelledCalls;
+	double nCallsCompleted;
+	double nCallsCancelled;
+	double nCallsTimedOut;
+	double nLateReturns;
 } RingWebView;
 
 typedef struct RingWebViewBind
 {
 	RingState *pMainRingState;
+	RingWebView *pRingWebView;
 	char *cFunc;
+	char *cName;
+	List *pObject;
+	int nTimeoutMs;
+	// Scheduling class, one of RING_WEBVIEW_PRIORITY_*.
+	int nPriority;
+	// Registered through the router rather than webview_bind(); fixed for the record's life.
+	int bRouted;
+	RingWebViewCache *pCache;
+	// Calls currently running; an unbound record is freed when this drops to 0.
+	int nActiveCalls;
+	int bReleased;
+	struct RingWebViewBind *pPrev;
+	struct RingWebViewBind *pNext;
 } RingWebViewBind;
 
+/* A bound call that JavaScript is still waiting on. Cancelled entries are kept
+ * (up to RING_WEBVIEW_MAX_CANCELLED_CALLS) so a late webview_return() can be
+ * recognised and dropped instead of resolving a promise nobody awaits. */
+typedef struct RingWebViewPendingCall
+{
+	RingWebView *pRingWebView;
+	RingWebViewBind *pBind;
+	char *cId;
+	// Set for calls made through ringCall()/ringAbortable(), which ringCancel() uses.
+	char *cToken;
+	int bCancelled;
+	// Set when the binding is memoized, so the result can be cached on return.
+	char *cCacheReq;
+	uint64_t nCacheHash;
+	// Only set while stats are enabled; used for the round-trip latency.
+	double nStartMs;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	guint nTimeoutSource;
+#endif
+	struct RingWebViewPendingCall *pPrev;
+	struct RingWebViewPendingCall *pNext;
+} RingWebViewPendingCall;
+
 typedef struct RingWebViewDispatch
 {
 	RingState *pRingState;
 	char *cCode;
+	int nPriority;
+	// Next dispatch held while the window is in the background.
+	struct RingWebViewDispatch *pNext;
 } RingWebViewDispatch;
 
+#define RING_WEBVIEW_EVENT_MAX_ARGS 4
+#define RING_WEBVIEW_EVENT_ARG_NUMBER 0
+#define RING_WEBVIEW_EVENT_ARG_STRING 1
+// JSON text, passed to Ring as a list (an empty one if it doesn't decode).
+#define RING_WEBVIEW_EVENT_ARG_JSON 2
+
+typedef struct RingWebViewEventArg
+{
+	int nType;
+	double nValue;
+	const char *cValue;
+	size_t nSize;
+} RingWebViewEventArg;
+
+/* The arguments of an event callback, collected before it runs so that one
+ * which can't run yet is queued with copies of them. */
+typedef struct RingWebViewEventArgs
+{
+	int nCount;
+	RingWebViewEventArg aArgs[RING_WEBVIEW_EVENT_MAX_ARGS];
+} RingWebViewEventArgs;
+
+/* A bind call, event callback or dispatch that arrived while a handler was
+ * yielding; replayed once the outermost handler returns so handlers never
+ * nest inside each other. */
+typedef struct RingWebViewDeferredCall
+{
+	// Bind call.
+	RingWebViewBind *pBind;
+	char *cId;
+	char *cReq;
+	// Event callback; the strings in oArgs are copies owned here.
+	RingWebView *pRingWebView;
+	char *cCallback;
+	char *cRecordArg;
+	size_t nBytesIn;
+	RingWebViewEventArgs oArgs;
+	// Dispatch.
+	RingWebViewDispatch *pDispatch;
+	struct RingWebViewDeferredCall *pNext;
+} RingWebViewDeferredCall;
+
+/* All windows share one Ring VM, so the reentrancy state is process-wide. */
+static int nRingWebViewCallDepth = 0;
+static int bRingWebViewYielding = 0;
+static int bRingWebViewFlushing = 0;
+static RingWebViewDeferredCall *pRingWebViewDeferredHead = NULL;
+static RingWebViewDeferredCall *pRingWebViewDeferredTail = NULL;
+
+#define RING_WEBVIEW_YIELD_MAX_EVENTS 256
+// How soon a timer due while a handler yields tries again.
+#define RING_WEBVIEW_TIMER_RETRY_MS 10
+#define RING_WEBVIEW_STEP_MAX_FDS 64
+#define RING_WEBVIEW_MAX_CANCELLED_CALLS 128
+// Waiting calls tracked per webview; handlers that never call webview_return() would grow the list for good.
+#define RING_WEBVIEW_MAX_PENDING_CALLS 4096
+#define RING_WEBVIEW_CANCEL_BINDING "__ring_webview_cancel__"
+#define RING_WEBVIEW_CALL_TOKEN_MARKER "{\"__ringCall\":\""
+#define RING_WEBVIEW_CALL_TOKEN_SIZE 32
+#define RING_WEBVIEW_ROUTE_BINDING "__ring_webview_route__"
+#define RING_WEBVIEW_MAX_ROUTE_NAME 256
+#define RING_WEBVIEW_HEADLESS_WIDTH 1280
+#define RING_WEBVIEW_HEADLESS_HEIGHT 800
+#define RING_WEBVIEW_SNAPSHOT_VISIBLE 0
+#define RING_WEBVIEW_SNAPSHOT_FULL_DOCUMENT 1
+#define RING_WEBVIEW_SNAPSHOT_PNG 0
+#define RING_WEBVIEW_SNAPSHOT_RGBA 1
+#define RING_WEBVIEW_PDF_PAPER_SIZE 32
+#define RING_WEBVIEW_PDF_MAX_WORKERS 16
+#define RING_WEBVIEW_POOL_MAX 8
+#define RING_WEBVIEW_BACKGROUND_NONE 0
+#define RING_WEBVIEW_BACKGROUND_THROTTLE 1
+#define RING_WEBVIEW_BACKGROUND_PAUSE 2
+#define RING_WEBVIEW_VISIBILITY_VISIBLE 0
+#define RING_WEBVIEW_VISIBILITY_HIDDEN 1
+#define RING_WEBVIEW_VISIBILITY_MINIMIZED 2
+// How often a throttled window runs its held dispatches.
+#define RING_WEBVIEW_THROTTLE_INTERVAL_MS 1000
+// Default for webview_set_resize_interval().
+#define RING_WEBVIEW_RESIZE_INTERVAL_MS 50
+#define RING_WEBVIEW_PROCESS_MODEL_PER_WINDOW 0
+#define RING_WEBVIEW_PROCESS_MODEL_SHARED 1
+// Same values as WebKitCacheModel.
+#define RING_WEBVIEW_CACHE_MODEL_DOCUMENT_VIEWER 0
+#define RING_WEBVIEW_CACHE_MODEL_WEB_BROWSER 1
+#define RING_WEBVIEW_CACHE_MODEL_DOCUMENT_BROWSER 2
+#define RING_WEBVIEW_PRIORITY_INTERACTIVE 0
+#define RING_WEBVIEW_PRIORITY_NORMAL 1
+#define RING_WEBVIEW_PRIORITY_BACKGROUND 2
+#define RING_WEBVIEW_PRIORITY_COUNT 3
+// Default for webview_set_starvation_limit().
+#define RING_WEBVIEW_STARVATION_MS 100
+
 /* ============================================================================
  * Internal Helper Functions
  * ============================================================================ */
@@ -79,15 +307,64 @@ static char *ring_webview_string_strdup(void *pState, const char *cStr)
 	return cString;
 }
 
-// The C callback that webview will call from JavaScript
-void ring_webview_bind_callback(const char *id, const char *req, void *arg)
+void ring_webview_bind_free(void *pState, void *pPointer);
+
+// Stats entry for cName, created on first use; NULL while stats are disabled.
+static RingWebViewStats *ring_webview_stats_for(RingWebView *pRingWebView, const char *cName)
 {
-	RingWebViewBind *pBind = (RingWebViewBind *)arg;
-	if (!pBind || !pBind->pMainRingState || !pBind->cFunc)
+	if (!pRingWebView || !pRingWebView->bStats || !pRingWebView->pStatsMap || !cName)
+		return NULL;
+
+	RingWebViewStats *pStats = (RingWebViewStats *)ring_webview_map_get(pRingWebView->pStatsMap, cName);
+	if (pStats == NULL)
 	{
+		pStats = ring_webview_stats_new(pRingWebView->pMainRingState);
+		if (pStats == NULL)
+			return NULL;
+		if (!ring_webview_map_set(pRingWebView->pStatsMap, cName, pStats))
+		{
+			ring_state_free(pRingWebView->pMainRingState, pStats);
+			return NULL;
+		}
+	}
+	return pStats;
+}
+
+static void ring_webview_free_stats(RingWebView *pRingWebView)
+{
+	RingWebViewMap *pMap = pRingWebView->pStatsMap;
+	if (!pMap)
 		return;
+	for (unsigned int i = 0; i < pMap->nBuckets; i++)
+	{
+		for (RingWebViewMapEntry *pEntry = pMap->aBuckets[i]; pEntry; pEntry = pEntry->pNext)
+		{
+			ring_state_free(pRingWebView->pMainRingState, pEntry->pValue);
+		}
 	}
+	ring_webview_map_free(pMap);
+	pRingWebView->pStatsMap = NULL;
+}
+
+// Record the VM-side timings of one bind invocation; negative timings are skipped.
+static void ring_webview_stats_record_invoke(RingWebViewBind *pBind, double nMutexWaitMs, double nDecodeMs,
+											 double nVMMs, int bError)
+{
+	RingWebViewStats *pStats = ring_webview_stats_for(pBind->pRingWebView, pBind->cName);
+	if (!pStats)
+		return;
+	ring_webview_hist_record(&pStats->hMutexWait, nMutexWaitMs * 1000.0);
+	if (nDecodeMs >= 0)
+		ring_webview_hist_record(&pStats->hDecode, nDecodeMs * 1000.0);
+	if (nVMMs >= 0)
+		ring_webview_hist_record(&pStats->hVM, nVMMs * 1000.0);
+	if (bError)
+		pStats->nErrors++;
+}
 
+// Run a bound Ring function with (id, req) on the main VM.
+static void ring_webview_invoke_bind(RingWebViewBind *pBind, const char *id, const char *req)
+{
 	RingState *pRingState = pBind->pMainRingState;
 	VM *pVM = pRingState->pVM;
 	if (pVM == NULL)
@@ -95,27 +372,49 @@ void ring_webview_bind_callback(const char *id, const char *req, void *arg)
 		return;
 	}
 
+	// Clock reads are only taken while stats are enabled for this webview.
+	int bStats = pBind->pRingWebView && pBind->pRingWebView->bStats;
+	double nStart = bStats ? ring_webview_now_ms() : 0;
+	double nMutexWaitMs = 0, nDecodeMs = 0;
+	int bDecodeError = 0;
+	double nTrace = ring_webview_trace_begin();
+
 	// Mutex Lock
 	ring_vm_mutexlock(pVM);
+	if (bStats)
+		nMutexWaitMs = ring_webview_now_ms() - nStart;
+	nRingWebViewCallDepth++;
+	ring_webview_watchdog_enter("bind", pBind->cName);
+	pBind->nActiveCalls++;
+	List *pObject = pBind->pObject;
 
 	// Save current stack and call state.
 	int nSP_before = pVM->nSP;
 	int nFuncSP_before = pVM->nFuncSP;
 	int nCallListSize_before = RING_VM_FUNCCALLSCOUNT;
 
-	// Validate parameters before calling Ring function
-	if (id == NULL || req == NULL)
+	// Method bindings resolve cFunc against the object, like obj { method() }.
+	// As with any braces, the object's braceStart/braceEnd methods run too.
+	if (pObject)
 	{
-		ring_vm_mutexunlock(pVM);
-		return;
+		ring_vm_oop_setbraceobj(pVM, pObject);
+		ring_vm_oop_bracestart(pVM);
 	}
 
 	// Load the function by name.
 	if (!ring_vm_loadfunc2(pVM, pBind->cFunc, RING_FALSE))
 	{
 		// Function not found; clean up and return.
+		if (pObject)
+			ring_vm_oop_braceend(pVM);
 		pVM->nSP = nSP_before;
 		pVM->nFuncSP = nFuncSP_before;
+		if (bStats)
+			ring_webview_stats_record_invoke(pBind, nMutexWaitMs, -1, -1, 1);
+		ring_webview_trace_end("bind", pBind->cName, nTrace);
+		pBind->nActiveCalls--;
+		ring_webview_watchdog_leave();
+		nRingWebViewCallDepth--;
 		ring_vm_mutexunlock(pVM);
 		return;
 	}
@@ -124,16 +423,23 @@ void ring_webview_bind_callback(const char *id, const char *req, void *arg)
 	RING_VM_STACK_PUSHCVALUE2(id, strlen(id));
 
 	{
+		double nDecodeStart = bStats ? ring_webview_now_ms() : 0;
+		double nDecodeTrace = ring_webview_trace_begin();
 		List *pReqList = json_decode_to_ring_list(pVM, req);
+		ring_webview_trace_end("json", "decode", nDecodeTrace);
 		if (!pReqList)
 		{
 			fprintf(stderr, "webview bind call: invalid JSON request; passing an empty list\n");
 			pReqList = ring_vm_api_newlist(pVM);
+			bDecodeError = 1;
 		}
 		ring_vm_api_retlist2(pVM, pReqList, RING_OUTPUT_RETLISTBYREF);
+		if (bStats)
+			nDecodeMs = ring_webview_now_ms() - nDecodeStart;
 	}
 
 	// Finalize call setup (jump PC to Ring function).
+	double nVMStart = bStats ? ring_webview_now_ms() : 0;
 	ring_vm_call2(pVM);
 
 	// Run VM until function returns.
@@ -142,852 +448,6992 @@ void ring_webview_bind_callback(const char *id, const char *req, void *arg)
 		ring_vm_fetch(pVM);
 	}
 
+	if (pObject)
+		ring_vm_oop_braceend(pVM);
+
+	if (bStats)
+		ring_webview_stats_record_invoke(pBind, nMutexWaitMs, nDecodeMs, ring_webview_now_ms() - nVMStart,
+										 bDecodeError);
+
 	// Restore stack pointer to discard any return value.
 	pVM->nSP = nSP_before;
 	pVM->nFuncSP = nFuncSP_before;
+	ring_webview_trace_end("bind", pBind->cName, nTrace);
+
+	// The handler unbound its own binding; the record was kept alive until now.
+	pBind->nActiveCalls--;
+	if (pBind->bReleased && pBind->nActiveCalls == 0)
+		ring_webview_bind_free(pRingState, pBind);
 
 	// Mutex Unlock
+	ring_webview_watchdog_leave();
+	nRingWebViewCallDepth--;
 	ring_vm_mutexunlock(pVM);
 }
 
-// Custom free function for the bind object to be used by the GC
-void ring_webview_bind_free(void *pState, void *pPointer)
+static void ring_webview_defer(RingWebViewDeferredCall *pCall)
 {
-	RingWebViewBind *pBind = (RingWebViewBind *)pPointer;
-	if (pBind)
-	{
-		if (pBind->cFunc)
-		{
-			ring_state_free(pState, pBind->cFunc);
-			pBind->cFunc = NULL;
-		}
-		ring_state_free(pState, pPointer);
-	}
+	pCall->pNext = NULL;
+	if (pRingWebViewDeferredTail)
+		pRingWebViewDeferredTail->pNext = pCall;
+	else
+		pRingWebViewDeferredHead = pCall;
+	pRingWebViewDeferredTail = pCall;
 }
 
-// The C callback that webview will call on the main thread for dispatch
-void ring_webview_dispatch_callback(webview_t w, void *arg)
+static void ring_webview_free_deferred_call(RingState *pRingState, RingWebViewDeferredCall *pCall)
 {
-	if (arg == NULL)
+	ring_state_free(pRingState, pCall->cId);
+	ring_state_free(pRingState, pCall->cReq);
+	ring_state_free(pRingState, pCall->cCallback);
+	ring_state_free(pRingState, pCall->cRecordArg);
+	for (int i = 0; i < pCall->oArgs.nCount; i++)
+		ring_state_free(pRingState, (void *)pCall->oArgs.aArgs[i].cValue);
+	ring_state_free(pRingState, pCall);
+}
+
+static void ring_webview_defer_call(RingWebViewBind *pBind, const char *id, const char *req)
+{
+	RingState *pRingState = pBind->pMainRingState;
+	RingWebViewDeferredCall *pCall =
+		(RingWebViewDeferredCall *)ring_state_calloc(pRingState, 1, sizeof(RingWebViewDeferredCall));
+	if (pCall == NULL)
 	{
 		return;
 	}
-
-	RingWebViewDispatch *pDispatch = (RingWebViewDispatch *)arg;
-	RingState *pRingState = pDispatch->pRingState;
-
-	// Use the main VM from RingState
-	if (pRingState == NULL || pRingState->pVM == NULL)
+	pCall->pBind = pBind;
+	pCall->cId = ring_webview_string_strdup(pRingState, id);
+	pCall->cReq = ring_webview_string_strdup(pRingState, req);
+	if (pCall->cId == NULL || pCall->cReq == NULL)
 	{
+		ring_webview_free_deferred_call(pRingState, pCall);
 		return;
 	}
-
-	// Execute the Ring code using the main VM
-	ring_vm_runcodefromthread(pRingState->pVM, pDispatch->cCode);
-
-	// Free the allocated memory
-	ring_state_free(pRingState, pDispatch->cCode);
-	ring_state_free(pRingState, pDispatch);
+	ring_webview_defer(pCall);
 }
 
-// Helper to destroy webview and free resources to avoid duplication.
-void ring_webview_destroy_internal(RingWebView *pRingWebView)
+// Queues an event callback with copies of its arguments. Returns 0 when out of memory.
+static int ring_webview_defer_event(RingWebView *pRingWebView, const char *cCallback, const char *cRecordArg,
+									size_t nBytesIn, const RingWebViewEventArgs *pArgs)
 {
-	if (pRingWebView && pRingWebView->webview)
+	RingState *pRingState = pRingWebView->pMainRingState;
+	RingWebViewDeferredCall *pCall =
+		(RingWebViewDeferredCall *)ring_state_calloc(pRingState, 1, sizeof(RingWebViewDeferredCall));
+	if (pCall == NULL)
+		return 0;
+	pCall->pRingWebView = pRingWebView;
+	pCall->cCallback = ring_webview_string_strdup(pRingState, cCallback);
+	pCall->cRecordArg = cRecordArg ? ring_webview_string_strdup(pRingState, cRecordArg) : NULL;
+	pCall->nBytesIn = nBytesIn;
+	int bFailed = !pCall->cCallback || (cRecordArg && !pCall->cRecordArg);
+	for (int i = 0; !bFailed && i < pArgs->nCount; i++)
+	{
+		RingWebViewEventArg *pArg = &pCall->oArgs.aArgs[i];
+		*pArg = pArgs->aArgs[i];
+		pCall->oArgs.nCount = i + 1;
+		if (pArg->nType == RING_WEBVIEW_EVENT_ARG_NUMBER || !pArg->cValue)
+			continue;
+		char *cCopy = (char *)ring_state_malloc(pRingState, pArg->nSize + 1);
+		pArg->cValue = cCopy;
+		if (!cCopy)
+		{
+			bFailed = 1;
+			break;
+		}
+		memcpy(cCopy, pArgs->aArgs[i].cValue, pArg->nSize);
+		cCopy[pArg->nSize] = '\0';
+	}
+	if (bFailed)
 	{
-		webview_destroy(pRingWebView->webview);
-		pRingWebView->webview = NULL;
+		ring_webview_free_deferred_call(pRingState, pCall);
+		return 0;
 	}
+	ring_webview_defer(pCall);
+	return 1;
 }
 
-static void ring_webview_call_event(RingWebView *pRingWebView, const char *cCallback, const char *cArg)
+// Queues a dispatch; it is freed when it runs. Returns 0 when out of memory.
+static int ring_webview_defer_dispatch(RingWebViewDispatch *pDispatch)
 {
-	if (!pRingWebView || !pRingWebView->pMainRingState || !cCallback)
-		return;
-
-	if (!pRingWebView->bRunning)
-		return;
-
-	RingState *pRingState = pRingWebView->pMainRingState;
-	VM *pVM = pRingState->pVM;
-	if (!pVM)
-		return;
-
-	ring_vm_mutexlock(pVM);
+	RingWebViewDeferredCall *pCall =
+		(RingWebViewDeferredCall *)ring_state_calloc(pDispatch->pRingState, 1, sizeof(RingWebViewDeferredCall));
+	if (pCall == NULL)
+		return 0;
+	pCall->pDispatch = pDispatch;
+	ring_webview_defer(pCall);
+	return 1;
+}
 
-	int nSP_before = pVM->nSP;
-	int nFuncSP_before = pVM->nFuncSP;
-	int nCallListSize_before = RING_VM_FUNCCALLSCOUNT;
+static int ring_webview_is_call_cancelled(RingWebView *pRingWebView, const char *cId);
+void ring_webview_dispatch_callback(webview_t w, void *arg);
+static void ring_webview_run_event(RingWebView *pRingWebView, const char *cCallback, const char *cRecordArg,
+								   size_t nBytesIn, const RingWebViewEventArgs *pArgs);
+static void ring_webview_deliver_stall_report(void);
+static void ring_webview_clear_timers(RingWebView *pRingWebView);
+static void ring_webview_detach_jobs(RingWebView *pRingWebView);
+static void ring_webview_stop_isolate(RingWebView *pRingWebView);
+static void ring_webview_scheduler_discard_calls(RingWebViewBind *pBind);
+static int ring_webview_scheduler_should_queue(int nPriority);
+static int ring_webview_scheduler_push_call(RingWebViewBind *pBind, const char *id, const char *req);
+static void ring_webview_scheduler_record(int nPriority, double nArrivalMs, double nStartMs);
+#ifndef WEBVIEW_PLATFORM_UNIX
+static webview_t ring_webview_any_window(void);
+#endif
+static const char *ring_webview_isolate_call(RingWebView *pRingWebView, const char *cFunc, const char *cId,
+											 const char *cReq);
+#ifdef WEBVIEW_PLATFORM_UNIX
+static void ring_webview_cancel_snapshots(RingWebView *pRingWebView);
+static void ring_webview_cancel_pdf_jobs(RingWebView *pRingWebView);
+static void ring_webview_detach_memory_release(RingWebView *pRingWebView);
+static void ring_webview_stop_background(RingWebView *pRingWebView);
+static void ring_webview_note_size(RingWebView *pRingWebView, int nWidth, int nHeight);
+#endif
 
-	if (!ring_vm_loadfunc2(pVM, (char *)cCallback, RING_FALSE))
-	{
-		pVM->nSP = nSP_before;
-		pVM->nFuncSP = nFuncSP_before;
-		ring_vm_mutexunlock(pVM);
+// Replay work deferred during a yield, once no handler is running.
+static void ring_webview_flush_deferred_calls(void)
+{
+	// Replayed handlers flush on return; the outer loop picks up from there.
+	if (bRingWebViewFlushing)
 		return;
-	}
-
-	if (cArg)
+	bRingWebViewFlushing = 1;
+	while (pRingWebViewDeferredHead && nRingWebViewCallDepth == 0 && !bRingWebViewYielding)
 	{
-		RING_VM_STACK_PUSHCVALUE2(cArg, strlen(cArg));
+		RingWebViewDeferredCall *pCall = pRingWebViewDeferredHead;
+		pRingWebViewDeferredHead = pCall->pNext;
+		if (pRingWebViewDeferredHead == NULL)
+			pRingWebViewDeferredTail = NULL;
+		if (pCall->pDispatch)
+		{
+			RingState *pRingState = pCall->pDispatch->pRingState;
+			// Frees the dispatch.
+			ring_webview_dispatch_callback(NULL, pCall->pDispatch);
+			ring_state_free(pRingState, pCall);
+		}
+		else if (pCall->pRingWebView)
+		{
+			// The callback may destroy its webview; that only discards the calls still queued.
+			RingState *pRingState = pCall->pRingWebView->pMainRingState;
+			ring_webview_run_event(pCall->pRingWebView, pCall->cCallback, pCall->cRecordArg, pCall->nBytesIn,
+								   &pCall->oArgs);
+			ring_webview_free_deferred_call(pRingState, pCall);
+		}
+		else
+		{
+			// The handler may unbind its own binding, so don't reach pBind afterwards.
+			RingState *pRingState = pCall->pBind->pMainRingState;
+			// Calls cancelled while they waited in the queue never reach Ring.
+			if (!ring_webview_is_call_cancelled(pCall->pBind->pRingWebView, pCall->cId))
+				ring_webview_invoke_bind(pCall->pBind, pCall->cId, pCall->cReq);
+			ring_webview_free_deferred_call(pRingState, pCall);
+		}
 	}
+	bRingWebViewFlushing = 0;
+}
 
-	ring_vm_call2(pVM);
-
-	while (RING_VM_FUNCCALLSCOUNT > nCallListSize_before)
+/* Drop deferred calls that still point at a bind record about to be freed,
+ * or event callbacks for a webview about to be destroyed. */
+static void ring_webview_discard_deferred(RingWebViewBind *pBind, RingWebView *pRingWebView)
+{
+	RingState *pRingState = pBind ? pBind->pMainRingState : pRingWebView->pMainRingState;
+	RingWebViewDeferredCall *pCall = pRingWebViewDeferredHead;
+	RingWebViewDeferredCall *pPrev = NULL;
+	while (pCall)
 	{
-		ring_vm_fetch(pVM);
+		RingWebViewDeferredCall *pNext = pCall->pNext;
+		if ((pBind && pCall->pBind == pBind) || (pRingWebView && pCall->pRingWebView == pRingWebView))
+		{
+			if (pPrev)
+				pPrev->pNext = pNext;
+			else
+				pRingWebViewDeferredHead = pNext;
+			if (pRingWebViewDeferredTail == pCall)
+				pRingWebViewDeferredTail = pPrev;
+			ring_webview_free_deferred_call(pRingState, pCall);
+		}
+		else
+		{
+			pPrev = pCall;
+		}
+		pCall = pNext;
 	}
-
-	pVM->nSP = nSP_before;
-	pVM->nFuncSP = nFuncSP_before;
-
-	ring_vm_mutexunlock(pVM);
+	if (pBind)
+		ring_webview_scheduler_discard_calls(pBind);
 }
 
 /* ============================================================================
- * Platform-specific Helpers (Windows)
+ * Pending Call Tracking
  * ============================================================================ */
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-static HWND ring_webview_get_hwnd(RingWebView *pRingWebView)
+/* Injected into every page. ringCall(name, ...args) calls the public stub of
+ * a bound function with {"__ringCall": token} appended to its arguments;
+ * the token is stripped natively and kept on the promise as callId. Adds
+ * ringCancel(promise) and ringAbortable(signal, name, ...args) on top. */
+static const char *cRingWebViewCancelScript =
+	"(function () {"
+	"  if (window.ringCall) return;"
+	"  var lastToken = 0;"
+	"  window.ringCall = function (name) {"
+	"    var fn = typeof window[name] === 'function' ? window[name] : window.ring && window.ring[name];"
+	"    if (typeof fn !== 'function')"
+	"      return Promise.reject(new TypeError(name + ' is not a bound function'));"
+	"    var token = String(++lastToken);"
+	"    var args = Array.prototype.slice.call(arguments, 1);"
+	"    args.push({ __ringCall: token });"
+	"    var promise = fn.apply(window, args);"
+	"    promise.callId = token;"
+	"    return promise;"
+	"  };"
+	"  window.ringCancel = function (promise) {"
+	"    return promise && promise.callId ?"
+	"      window." RING_WEBVIEW_CANCEL_BINDING "(promise.callId) : Promise.resolve(false);"
+	"  };"
+	"  window.ringAbortable = function (signal, name) {"
+	"    if (signal && signal.aborted)"
+	"      return Promise.reject(new DOMException('Aborted', 'AbortError'));"
+	"    var promise = window.ringCall.apply(window, Array.prototype.slice.call(arguments, 1));"
+	"    if (!signal) return promise;"
+	"    return new Promise(function (resolve, reject) {"
+	"      var onAbort = function () {"
+	"        window.ringCancel(promise);"
+	"        reject(new DOMException('Aborted', 'AbortError'));"
+	"      };"
+	"      signal.addEventListener('abort', onAbort, { once: true });"
+	"      promise.then(function (value) {"
+	"        signal.removeEventListener('abort', onAbort); resolve(value);"
+	"      }, function (error) {"
+	"        signal.removeEventListener('abort', onAbort); reject(error);"
+	"      });"
+	"    });"
+	"  };"
+	"})();";
+
+/* Splits the token that ringCall() appends off the arguments. Returns the
+ * arguments without it (freed by the caller) and copies the token into
+ * cToken, or returns NULL when the call has no token. */
+static char *ring_webview_strip_call_token(RingState *pRingState, const char *req, char *cToken, size_t nTokenSize)
 {
-	if (!pRingWebView || !pRingWebView->webview)
+	size_t nLen = strlen(req);
+	size_t nMarker = strlen(RING_WEBVIEW_CALL_TOKEN_MARKER);
+	cToken[0] = '\0';
+	if (nLen < nMarker + 5 || memcmp(req + nLen - 3, "\"}]", 3) != 0)
 		return NULL;
-	return (HWND)webview_get_window(pRingWebView->webview);
+	// The token is made of digits, so the marker starts at the last brace.
+	const char *pMarker = strrchr(req, '{');
+	if (!pMarker || strncmp(pMarker, RING_WEBVIEW_CALL_TOKEN_MARKER, nMarker) != 0)
+		return NULL;
+	const char *pToken = pMarker + nMarker;
+	size_t nToken = (size_t)(req + nLen - 3 - pToken);
+	if (nToken == 0 || nToken >= nTokenSize || strspn(pToken, "0123456789") != nToken)
+		return NULL;
+	if (pMarker > req && pMarker[-1] == ',')
+		pMarker--;
+	else if (pMarker == req || pMarker[-1] != '[')
+		return NULL;
+
+	size_t nKeep = (size_t)(pMarker - req);
+	char *cReq = (char *)ring_state_malloc(pRingState, nKeep + 2);
+	if (cReq == NULL)
+		return NULL;
+	memcpy(cReq, req, nKeep);
+	cReq[nKeep] = ']';
+	cReq[nKeep + 1] = '\0';
+	memcpy(cToken, pToken, nToken);
+	cToken[nToken] = '\0';
+	return cReq;
 }
 
-static BOOL CALLBACK ring_webview_monitor_enum_proc(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor,
-													LPARAM dwData)
+static RingWebViewPendingCall *ring_webview_find_pending_call(RingWebView *pRingWebView, const char *cId)
 {
-	(void)hdcMonitor;
-	(void)lprcMonitor;
-	List *pList = (List *)dwData;
-	MONITORINFOEXW mi;
-	mi.cbSize = sizeof(mi);
-	if (GetMonitorInfoW(hMonitor, (LPMONITORINFO)&mi))
-	{
-		char name[64];
-		WideCharToMultiByte(CP_UTF8, 0, mi.szDevice, -1, name, sizeof(name), NULL, NULL);
-
-		List *pScreenList = ring_list_newlist_gc(NULL, pList);
-		ring_list_addstring_gc(NULL, pScreenList, name);
-		ring_list_adddouble_gc(NULL, pScreenList, (double)mi.rcMonitor.left);
-		ring_list_adddouble_gc(NULL, pScreenList, (double)mi.rcMonitor.top);
-		ring_list_adddouble_gc(NULL, pScreenList, (double)(mi.rcMonitor.right - mi.rcMonitor.left));
-		ring_list_adddouble_gc(NULL, pScreenList, (double)(mi.rcMonitor.bottom - mi.rcMonitor.top));
-	}
-	return TRUE;
+	if (!pRingWebView->pPendingMap)
+		return NULL;
+	return (RingWebViewPendingCall *)ring_webview_map_get(pRingWebView->pPendingMap, cId);
 }
-#endif
-
-/* ============================================================================
- * Platform-specific Helpers (Linux/FreeBSD)
- * ============================================================================ */
 
-#ifdef WEBVIEW_PLATFORM_UNIX
-static GtkWindow *ring_webview_get_gtk_window(RingWebView *pRingWebView)
+// Takes a call off its list: the waiting calls, or the cancelled ones.
+static void ring_webview_unlink_pending_call(RingWebView *pRingWebView, RingWebViewPendingCall *pCall)
 {
-	if (!pRingWebView || !pRingWebView->webview)
-		return NULL;
-	return GTK_WINDOW(webview_get_window(pRingWebView->webview));
+	if (pCall->pPrev)
+		pCall->pPrev->pNext = pCall->pNext;
+	else if (pCall->bCancelled)
+		pRingWebView->pCancelledCalls = pCall->pNext;
+	else
+		pRingWebView->pPendingCalls = pCall->pNext;
+	if (pCall->pNext)
+		pCall->pNext->pPrev = pCall->pPrev;
+	else if (pCall->bCancelled)
+		pRingWebView->pCancelledTail = pCall->pPrev;
+	else
+		pRingWebView->pPendingTail = pCall->pPrev;
+	pCall->pPrev = NULL;
+	pCall->pNext = NULL;
 }
 
-static void ring_webview_on_click(GtkGestureClick *gesture, gint n_press, gdouble x, gdouble y, gpointer user_data)
+static void ring_webview_free_pending_call(RingWebView *pRingWebView, RingWebViewPendingCall *pCall)
 {
-	(void)n_press;
-	RingWebView *pRingWebView = (RingWebView *)user_data;
-	if (!pRingWebView)
-		return;
+	ring_webview_unlink_pending_call(pRingWebView, pCall);
+	ring_webview_map_remove(pRingWebView->pPendingMap, pCall->cId, pCall);
+	if (pCall->cToken)
+		ring_webview_map_remove(pRingWebView->pCallTokens, pCall->cToken, pCall);
 
-	GtkEventController *controller = GTK_EVENT_CONTROLLER(gesture);
-	GdkEvent *event = gtk_event_controller_get_current_event(controller);
-	if (!event)
-		return;
+	if (pCall->bCancelled)
+		pRingWebView->nCancelledCalls--;
+	else
+		pRingWebView->nPendingCalls--;
 
-	GtkWidget *widget = gtk_event_controller_get_widget(controller);
-	GtkNative *native = gtk_widget_get_native(widget);
-	GdkSurface *surface = gtk_native_get_surface(native);
+#ifdef WEBVIEW_PLATFORM_UNIX
+	if (pCall->nTimeoutSource)
+		g_source_remove(pCall->nTimeoutSource);
+#endif
 
-	pRingWebView->pLastDevice = gdk_event_get_device(event);
-	pRingWebView->pLastSurface = surface;
-	pRingWebView->nLastButton = (int)gdk_button_event_get_button(event);
-	pRingWebView->nLastTime = gdk_event_get_time(event);
-	pRingWebView->dLastX = x;
-	pRingWebView->dLastY = y;
-	pRingWebView->bHasClickData = TRUE;
+	if (pCall->cCacheReq)
+		ring_state_free(pRingWebView->pMainRingState, pCall->cCacheReq);
+	if (pCall->cToken)
+		ring_state_free(pRingWebView->pMainRingState, pCall->cToken);
+	ring_state_free(pRingWebView->pMainRingState, pCall->cId);
+	ring_state_free(pRingWebView->pMainRingState, pCall);
 }
 
-static void ring_webview_setup_drag_handler(RingWebView *pRingWebView)
+// Keep only the most recent cancelled entries.
+static void ring_webview_trim_cancelled_calls(RingWebView *pRingWebView)
 {
-	if (!pRingWebView || !pRingWebView->webview)
-		return;
-
-	GtkWidget *webview_widget =
-		(GtkWidget *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WIDGET);
-	if (!webview_widget)
-		return;
-
-	GtkGesture *gesture = gtk_gesture_click_new();
-	gtk_gesture_single_set_button(GTK_GESTURE_SINGLE(gesture), 0);
-	g_signal_connect(gesture, "pressed", G_CALLBACK(ring_webview_on_click), pRingWebView);
-	gtk_widget_add_controller(webview_widget, GTK_EVENT_CONTROLLER(gesture));
-
-	pRingWebView->bHasClickData = FALSE;
+	while (pRingWebView->nCancelledCalls > RING_WEBVIEW_MAX_CANCELLED_CALLS && pRingWebView->pCancelledCalls)
+		ring_webview_free_pending_call(pRingWebView, pRingWebView->pCancelledCalls);
 }
 
-static void ring_webview_on_load_changed(WebKitWebView *web_view, WebKitLoadEvent load_event, gpointer user_data)
+// Reject the JavaScript promise of a pending call and mark it cancelled.
+static int ring_webview_cancel_pending_call(RingWebView *pRingWebView, RingWebViewPendingCall *pCall, int bTimedOut)
 {
-	RingWebView *pRingWebView = (RingWebView *)user_data;
-	if (!pRingWebView)
-		return;
+	if (pCall->bCancelled)
+		return 0;
+
+	ring_webview_unlink_pending_call(pRingWebView, pCall);
+	pCall->bCancelled = 1;
+	pCall->pPrev = pRingWebView->pCancelledTail;
+	if (pRingWebView->pCancelledTail)
+		pRingWebView->pCancelledTail->pNext = pCall;
+	else
+		pRingWebView->pCancelledCalls = pCall;
+	pRingWebView->pCancelledTail = pCall;
+	pRingWebView->nPendingCalls--;
+	pRingWebView->nCancelledCalls++;
+	if (bTimedOut)
+		pRingWebView->nCallsTimedOut++;
+	else
+		pRingWebView->nCallsCancelled++;
 
-	if (load_event == WEBKIT_LOAD_FINISHED && pRingWebView->cOnLoad)
-	{
-		ring_webview_call_event(pRingWebView, pRingWebView->cOnLoad, "finished");
-	}
-	else if (load_event == WEBKIT_LOAD_STARTED && pRingWebView->cOnLoad)
+#ifdef WEBVIEW_PLATFORM_UNIX
+	if (pCall->nTimeoutSource)
 	{
-		ring_webview_call_event(pRingWebView, pRingWebView->cOnLoad, "started");
+		g_source_remove(pCall->nTimeoutSource);
+		pCall->nTimeoutSource = 0;
 	}
+#endif
 
-	if (load_event == WEBKIT_LOAD_FINISHED && pRingWebView->cOnDomReady)
+	if (pRingWebView->webview)
 	{
-		ring_webview_call_event(pRingWebView, pRingWebView->cOnDomReady, NULL);
+		const char *cReason = bTimedOut ? "\"timeout\"" : "\"cancelled\"";
+		webview_return(pRingWebView->webview, pCall->cId, 1, cReason);
+		ring_webview_record(RING_WEBVIEW_RECORD_RETURN, pCall->cId, NULL, cReason, 1);
 	}
+
+	ring_webview_trim_cancelled_calls(pRingWebView);
+	return 1;
 }
 
-static void ring_webview_on_title_changed(GObject *object, GParamSpec *pspec, gpointer user_data)
+#ifdef WEBVIEW_PLATFORM_UNIX
+static gboolean ring_webview_on_call_timeout(gpointer user_data)
 {
-	RingWebView *pRingWebView = (RingWebView *)user_data;
-	if (!pRingWebView || !pRingWebView->cOnTitle)
-		return;
-
-	WebKitWebView *web_view = WEBKIT_WEB_VIEW(object);
-	const char *title = webkit_web_view_get_title(web_view);
-	if (title)
-	{
-		ring_webview_call_event(pRingWebView, pRingWebView->cOnTitle, title);
-	}
+	RingWebViewPendingCall *pCall = (RingWebViewPendingCall *)user_data;
+	// The source is removed by returning G_SOURCE_REMOVE; forget it first.
+	pCall->nTimeoutSource = 0;
+	ring_webview_cancel_pending_call(pCall->pRingWebView, pCall, 1);
+	return G_SOURCE_REMOVE;
 }
+#endif
 
-static void ring_webview_on_uri_changed(GObject *object, GParamSpec *pspec, gpointer user_data)
+static void ring_webview_track_call(RingWebViewBind *pBind, const char *id, const char *req, uint64_t nCacheHash,
+									const char *cToken)
 {
-	RingWebView *pRingWebView = (RingWebView *)user_data;
-	if (!pRingWebView || !pRingWebView->cOnNavigate)
+	RingWebView *pRingWebView = pBind->pRingWebView;
+	if (!pRingWebView || !pRingWebView->pPendingMap)
 		return;
 
-	WebKitWebView *web_view = WEBKIT_WEB_VIEW(object);
-	const char *uri = webkit_web_view_get_uri(web_view);
-	if (uri)
+	RingWebViewPendingCall *pCall =
+		(RingWebViewPendingCall *)ring_state_malloc(pBind->pMainRingState, sizeof(RingWebViewPendingCall));
+	if (pCall == NULL)
+		return;
+	pCall->cId = ring_webview_string_strdup(pBind->pMainRingState, id);
+	if (pCall->cId == NULL)
 	{
-		ring_webview_call_event(pRingWebView, pRingWebView->cOnNavigate, uri);
+		ring_state_free(pBind->pMainRingState, pCall);
+		return;
+	}
+	if (!ring_webview_map_set(pRingWebView->pPendingMap, pCall->cId, pCall))
+	{
+		ring_state_free(pBind->pMainRingState, pCall->cId);
+		ring_state_free(pBind->pMainRingState, pCall);
+		return;
+	}
+	pCall->pRingWebView = pRingWebView;
+	pCall->pBind = pBind;
+	pCall->cToken = NULL;
+	if (cToken[0])
+	{
+		pCall->cToken = ring_webview_string_strdup(pBind->pMainRingState, cToken);
+		// Without its token the call can still be cancelled from Ring, just not by ringCancel().
+		if (pCall->cToken && !ring_webview_map_set(pRingWebView->pCallTokens, pCall->cToken, pCall))
+		{
+			ring_state_free(pBind->pMainRingState, pCall->cToken);
+			pCall->cToken = NULL;
+		}
 	}
+	pCall->bCancelled = 0;
+	pCall->cCacheReq = NULL;
+	pCall->nCacheHash = nCacheHash;
+	pCall->nStartMs = pRingWebView->bStats ? ring_webview_now_ms() : 0;
+	if (pBind->pCache)
+		pCall->cCacheReq = ring_webview_string_strdup(pBind->pMainRingState, req);
+#ifdef WEBVIEW_PLATFORM_UNIX
+	pCall->nTimeoutSource = 0;
+	if (pBind->nTimeoutMs > 0)
+		pCall->nTimeoutSource = g_timeout_add((guint)pBind->nTimeoutMs, ring_webview_on_call_timeout, pCall);
+#endif
+	pCall->pPrev = NULL;
+	pCall->pNext = pRingWebView->pPendingCalls;
+	if (pCall->pNext)
+		pCall->pNext->pPrev = pCall;
+	else
+		pRingWebView->pPendingTail = pCall;
+	pRingWebView->pPendingCalls = pCall;
+	pRingWebView->nPendingCalls++;
+
+	/* Forget the oldest call once too many wait. A late webview_return() for
+	 * it still reaches JavaScript; it just isn't cached or timed. */
+	if (pRingWebView->nPendingCalls > RING_WEBVIEW_MAX_PENDING_CALLS)
+		ring_webview_free_pending_call(pRingWebView, pRingWebView->pPendingTail);
 }
 
-static gboolean ring_webview_on_close_request(GtkWindow *window, gpointer user_data)
+static int ring_webview_is_call_cancelled(RingWebView *pRingWebView, const char *cId)
 {
-	RingWebView *pRingWebView = (RingWebView *)user_data;
-	if (pRingWebView && pRingWebView->cOnClose)
-	{
-		ring_webview_call_event(pRingWebView, pRingWebView->cOnClose, NULL);
-	}
-	return FALSE;
+	if (!pRingWebView)
+		return 0;
+	RingWebViewPendingCall *pCall = ring_webview_find_pending_call(pRingWebView, cId);
+	return pCall && pCall->bCancelled;
 }
 
-static void ring_webview_on_focus_changed(GtkWindow *window, GParamSpec *pspec, gpointer user_data)
+/* Returns 1 (and forgets the call) when Ring is answering a call that was
+ * cancelled or timed out; the result must not reach JavaScript. */
+static int ring_webview_drop_late_return(RingWebView *pRingWebView, const char *cId)
 {
-	RingWebView *pRingWebView = (RingWebView *)user_data;
-	if (!pRingWebView || !pRingWebView->cOnFocus)
-		return;
+	RingWebViewPendingCall *pCall = ring_webview_find_pending_call(pRingWebView, cId);
+	if (!pCall || !pCall->bCancelled)
+		return 0;
 
-	gboolean focused = gtk_window_is_active(window);
-	ring_webview_call_event(pRingWebView, pRingWebView->cOnFocus, focused ? "true" : "false");
+	pRingWebView->nLateReturns++;
+	ring_webview_free_pending_call(pRingWebView, pCall);
+	return 1;
 }
 
-static void ring_webview_setup_event_handlers(RingWebView *pRingWebView)
+// Settle a call that Ring has answered, caching the result of memoized bindings.
+static void ring_webview_finish_call(RingWebView *pRingWebView, const char *cId, int nStatus, const char *cJson)
 {
-	if (!pRingWebView || !pRingWebView->webview)
+	RingWebViewPendingCall *pCall = ring_webview_find_pending_call(pRingWebView, cId);
+	if (!pCall)
 		return;
 
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	GtkWindow *window =
-		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-
-	if (web_view)
+	if (nStatus == 0 && pCall->cCacheReq && pCall->pBind && pCall->pBind->pCache)
+		ring_webview_cache_put(pCall->pBind->pCache, pCall->nCacheHash, pCall->cCacheReq, cJson);
+	if (pRingWebView->bStats && pCall->pBind)
 	{
-		g_signal_connect(web_view, "load-changed", G_CALLBACK(ring_webview_on_load_changed), pRingWebView);
-		g_signal_connect(web_view, "notify::title", G_CALLBACK(ring_webview_on_title_changed), pRingWebView);
-		g_signal_connect(web_view, "notify::uri", G_CALLBACK(ring_webview_on_uri_changed), pRingWebView);
+		RingWebViewStats *pStats = ring_webview_stats_for(pRingWebView, pCall->pBind->cName);
+		if (pStats)
+		{
+			pStats->nBytesOut += strlen(cJson);
+			if (nStatus != 0)
+				pStats->nErrors++;
+			if (pCall->nStartMs > 0)
+				ring_webview_hist_record(&pStats->hLatency, (ring_webview_now_ms() - pCall->nStartMs) * 1000.0);
+		}
 	}
+	pRingWebView->nCallsCompleted++;
+	ring_webview_free_pending_call(pRingWebView, pCall);
+}
 
-	if (window)
+static void ring_webview_clear_pending_calls(RingWebView *pRingWebView)
+{
+	while (pRingWebView->pPendingCalls)
 	{
-		g_signal_connect(window, "close-request", G_CALLBACK(ring_webview_on_close_request), pRingWebView);
-		g_signal_connect(window, "notify::is-active", G_CALLBACK(ring_webview_on_focus_changed), pRingWebView);
+		ring_webview_free_pending_call(pRingWebView, pRingWebView->pPendingCalls);
+	}
+	while (pRingWebView->pCancelledCalls)
+	{
+		ring_webview_free_pending_call(pRingWebView, pRingWebView->pCancelledCalls);
 	}
 }
-#endif
 
-#ifdef WEBVIEW_PLATFORM_UNIX
-static gboolean ring_webview_suppress_context_menu(WebKitWebView *web_view, WebKitContextMenu *context_menu,
-												   GdkEvent *event, WebKitHitTestResult *hit_test_result,
-												   gpointer user_data)
+// Native memory held by a registered bind record, including its map entry.
+static double ring_webview_bind_bytes(RingWebViewBind *pBind)
 {
-	(void)web_view;
-	(void)context_menu;
-	(void)event;
-	(void)hit_test_result;
-	(void)user_data;
-	return TRUE;
+	size_t nNameSize = pBind->cName ? strlen(pBind->cName) + 1 : 0;
+	size_t nFuncSize = pBind->cFunc ? strlen(pBind->cFunc) + 1 : 0;
+	return (double)(sizeof(RingWebViewBind) + sizeof(RingWebViewMapEntry) + nNameSize * 2 + nFuncSize);
 }
-#endif
 
-#define RING_WEBVIEW_SET_EVENT_FUNC(funcname, member)                                                                  \
-	RING_FUNC(funcname)                                                                                                \
-	{                                                                                                                  \
-		if (RING_API_PARACOUNT != 2)                                                                                   \
-		{                                                                                                              \
-			RING_API_ERROR(RING_API_MISS2PARA);                                                                        \
-			return;                                                                                                    \
-		}                                                                                                              \
-		if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))                                                          \
-		{                                                                                                              \
-			RING_API_ERROR(RING_API_BADPARATYPE);                                                                      \
-			return;                                                                                                    \
-		}                                                                                                              \
-		RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");                               \
-		if (!pRingWebView || !pRingWebView->webview)                                                                   \
-		{                                                                                                              \
-			RING_API_ERROR("Invalid webview pointer");                                                                 \
-			return;                                                                                                    \
-		}                                                                                                              \
-		if (pRingWebView->member)                                                                                      \
-		{                                                                                                              \
-			ring_state_free(pRingWebView->pMainRingState, pRingWebView->member);                                       \
-		}                                                                                                              \
-		pRingWebView->member = ring_webview_string_strdup(pRingWebView->pMainRingState, RING_API_GETSTRING(2));        \
-		RING_API_RETNUMBER(1);                                                                                         \
-	}
+// Unlink a bind record from its webview before it is freed.
+static void ring_webview_detach_bind(RingWebViewBind *pBind)
+{
+	RingWebView *pRingWebView = pBind->pRingWebView;
+	if (!pRingWebView)
+		return;
 
-// Custom free function for the RingWebView object, called by the GC.
-void ring_webview_free(void *pState, void *pPointer)
+	if (pBind->pPrev)
+		pBind->pPrev->pNext = pBind->pNext;
+	else
+		pRingWebView->pBinds = pBind->pNext;
+	if (pBind->pNext)
+		pBind->pNext->pPrev = pBind->pPrev;
+	pBind->pPrev = NULL;
+	pBind->pNext = NULL;
+	if (pRingWebView->pBindMap && pBind->cName)
+		ring_webview_map_remove(pRingWebView->pBindMap, pBind->cName, pBind);
+	pRingWebView->nLiveBinds--;
+	pRingWebView->nLiveBindBytes -= ring_webview_bind_bytes(pBind);
+
+	// Calls the binding never answered go with it; a late webview_return() still reaches JavaScript.
+	RingWebViewPendingCall *pCall = pRingWebView->pPendingCalls;
+	while (pCall)
+	{
+		RingWebViewPendingCall *pNext = pCall->pNext;
+		if (pCall->pBind == pBind)
+			ring_webview_free_pending_call(pRingWebView, pCall);
+		pCall = pNext;
+	}
+	for (RingWebViewPendingCall *pCall = pRingWebView->pCancelledCalls; pCall; pCall = pCall->pNext)
+	{
+		if (pCall->pBind == pBind)
+			pCall->pBind = NULL;
+	}
+	pBind->pRingWebView = NULL;
+}
+
+static RingWebViewBind *ring_webview_find_bind(RingWebView *pRingWebView, const char *cName)
 {
-	RingWebView *pRingWebView = (RingWebView *)pPointer;
-	ring_webview_destroy_internal(pRingWebView);
-	ring_state_free(pState, pPointer);
+	if (!pRingWebView->pBindMap)
+		return NULL;
+	return (RingWebViewBind *)ring_webview_map_get(pRingWebView->pBindMap, cName);
 }
 
-/* ============================================================================
- * Core WebView Functions
- * ============================================================================ */
+// Native handler for the injected cancel binding; never enters the Ring VM.
+static void ring_webview_cancel_callback(const char *id, const char *req, void *arg)
+{
+	RingWebView *pRingWebView = (RingWebView *)arg;
+	int bCancelled = 0;
 
-RING_FUNC(ring_webview_dispatch)
+	if (!pRingWebView || !pRingWebView->webview || id == NULL || req == NULL)
+		return;
+
+	yyjson_doc *pDoc = yyjson_read(req, strlen(req), 0);
+	if (pDoc)
+	{
+		yyjson_val *pRoot = yyjson_doc_get_root(pDoc);
+		if (yyjson_is_arr(pRoot) && yyjson_arr_size(pRoot) > 0 && yyjson_is_str(yyjson_arr_get(pRoot, 0)))
+		{
+			// ringCancel() passes the token ringCall() gave the call.
+			RingWebViewPendingCall *pCall =
+				pRingWebView->pCallTokens
+					? (RingWebViewPendingCall *)ring_webview_map_get(pRingWebView->pCallTokens,
+																	 yyjson_get_str(yyjson_arr_get(pRoot, 0)))
+					: NULL;
+			if (pCall)
+				bCancelled = ring_webview_cancel_pending_call(pRingWebView, pCall, 0);
+		}
+		yyjson_doc_free(pDoc);
+	}
+
+	webview_return(pRingWebView->webview, id, 0, bCancelled ? "true" : "false");
+}
+
+static void ring_webview_handle_call(RingWebViewBind *pBind, const char *id, const char *req, const char *cToken)
 {
-	if (RING_API_PARACOUNT != 2)
+	ring_webview_record(RING_WEBVIEW_RECORD_CALL, pBind->cName, id, req, 0);
+
+	RingWebViewStats *pStats = NULL;
+	if (pBind->pRingWebView && pBind->pRingWebView->bStats)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
-		return;
+		pStats = ring_webview_stats_for(pBind->pRingWebView, pBind->cName);
+		if (pStats)
+		{
+			pStats->nCalls++;
+			pStats->nBytesIn += strlen(req);
+		}
 	}
 
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	// Memoized bindings answer repeated requests without entering the VM.
+	uint64_t nCacheHash = 0;
+	if (pBind->pCache && pBind->pRingWebView && pBind->pRingWebView->webview)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
-		return;
+		nCacheHash = ring_webview_cache_hash(req);
+		const char *cResult = ring_webview_cache_get(pBind->pCache, nCacheHash, req);
+		if (cResult)
+		{
+			if (pStats)
+			{
+				pStats->nBytesOut += strlen(cResult);
+				ring_webview_hist_record(&pStats->hLatency, 0);
+			}
+			webview_return(pBind->pRingWebView->webview, id, 0, cResult);
+			ring_webview_record(RING_WEBVIEW_RECORD_RETURN, id, NULL, cResult, 0);
+			return;
+		}
 	}
 
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+	ring_webview_track_call(pBind, id, req, nCacheHash, cToken);
+
+	// A window with its own Ring state runs the handler on that state's thread.
+	if (pBind->pRingWebView && pBind->pRingWebView->pIsolate)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		const char *cError = ring_webview_isolate_call(pBind->pRingWebView, pBind->cFunc, id, req);
+		if (cError)
+		{
+			char *cJson = ring_string_to_json_string(cError);
+			webview_return(pBind->pRingWebView->webview, id, 1, cJson ? cJson : "null");
+			ring_webview_finish_call(pBind->pRingWebView, id, 1, cJson ? cJson : "null");
+			free(cJson);
+		}
 		return;
 	}
-	const char *cCodeToRun = RING_API_GETSTRING(2);
 
-	RingWebViewDispatch *pDispatch =
-		(RingWebViewDispatch *)ring_state_malloc(pRingWebView->pMainRingState, sizeof(RingWebViewDispatch));
-	if (pDispatch == NULL)
+	// Background calls, and calls behind more urgent queued work, wait for the scheduler.
+	if (ring_webview_scheduler_should_queue(pBind->nPriority) && ring_webview_scheduler_push_call(pBind, id, req))
+		return;
+
+	// A handler is suspended in webview_yield(); queue the call instead of nesting it.
+	if (bRingWebViewYielding)
 	{
-		RING_API_ERROR(RING_OOM);
+		ring_webview_defer_call(pBind, id, req);
 		return;
 	}
-	// Use the main RingState stored when webview was created
-	pDispatch->pRingState = pRingWebView->pMainRingState;
-	pDispatch->cCode = ring_webview_string_strdup(pRingWebView->pMainRingState, cCodeToRun);
-	if (pDispatch->cCode == NULL)
+
+	int nPriority = pBind->nPriority;
+	double nArrivalMs = ring_webview_now_ms();
+	ring_webview_invoke_bind(pBind, id, req);
+	ring_webview_scheduler_record(nPriority, nArrivalMs, nArrivalMs);
+	ring_webview_flush_deferred_calls();
+	ring_webview_deliver_stall_report();
+}
+
+// The C callback that webview will call from JavaScript
+void ring_webview_bind_callback(const char *id, const char *req, void *arg)
+{
+	RingWebViewBind *pBind = (RingWebViewBind *)arg;
+	if (!pBind || !pBind->pMainRingState || !pBind->cFunc)
 	{
-		ring_state_free(pRingWebView->pMainRingState, pDispatch);
-		RING_API_ERROR(RING_OOM);
 		return;
 	}
 
-	webview_error_t result = webview_dispatch(pRingWebView->webview, ring_webview_dispatch_callback, pDispatch);
-
-	// Free memory if dispatch fails to avoid leaks.
-	if (result != WEBVIEW_ERROR_OK)
+	// Validate parameters before calling Ring function
+	if (id == NULL || req == NULL)
 	{
-		ring_state_free(pRingWebView->pMainRingState, pDispatch->cCode);
-		ring_state_free(pRingWebView->pMainRingState, pDispatch);
+		return;
 	}
 
-	RING_API_RETNUMBER(result);
+	RingState *pRingState = pBind->pMainRingState;
+	char cToken[RING_WEBVIEW_CALL_TOKEN_SIZE];
+	char *cReq = ring_webview_strip_call_token(pRingState, req, cToken, sizeof(cToken));
+	ring_webview_handle_call(pBind, id, cReq ? cReq : req, cToken);
+	if (cReq)
+		ring_state_free(pRingState, cReq);
 }
 
-RING_FUNC(ring_webview_bind)
+// Custom free function for the bind object to be used by the GC
+void ring_webview_bind_free(void *pState, void *pPointer)
 {
-	if (RING_API_PARACOUNT != 3)
+	RingWebViewBind *pBind = (RingWebViewBind *)pPointer;
+	if (pBind)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
-		return;
+		ring_webview_discard_deferred(pBind, NULL);
+		ring_webview_detach_bind(pBind);
+		if (pBind->cFunc)
+		{
+			ring_state_free(pState, pBind->cFunc);
+			pBind->cFunc = NULL;
+		}
+		if (pBind->cName)
+		{
+			ring_state_free(pState, pBind->cName);
+			pBind->cName = NULL;
+		}
+		if (pBind->pCache)
+		{
+			ring_webview_cache_free(pBind->pCache);
+			pBind->pCache = NULL;
+		}
+		ring_state_free(pState, pPointer);
 	}
+}
 
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3))
+/* Injected when routing is enabled: window.ring.<name>(...args) forwards to
+ * the single dispatcher binding, which looks the name up natively. */
+static const char *cRingWebViewRouteScript =
+	"(function () {"
+	"  if (window.ring) return;"
+	"  var stubs = Object.create(null);"
+	"  window.ring = new Proxy({}, {"
+	"    get: function (target, name) {"
+	"      if (typeof name !== 'string' || name === 'then') return undefined;"
+	"      return stubs[name] || (stubs[name] = function () {"
+	"        var args = Array.prototype.slice.call(arguments);"
+	"        return window." RING_WEBVIEW_ROUTE_BINDING ".apply(window, [name].concat(args));"
+	"      });"
+	"    }"
+	"  });"
+	"})();";
+
+/* Native handler for the dispatcher binding. The request is ["name", ...args];
+ * the name is split off without a full JSON parse and the remaining arguments
+ * are handed to the bind record found in the name map. */
+static void ring_webview_route_callback(const char *id, const char *req, void *arg)
+{
+	RingWebView *pRingWebView = (RingWebView *)arg;
+	char cName[RING_WEBVIEW_MAX_ROUTE_NAME];
+	RingWebViewBind *pBind = NULL;
+	const char *p = req;
+	size_t nLen = 0;
+
+	if (!pRingWebView || !pRingWebView->webview || id == NULL || req == NULL)
+		return;
+
+	while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+		p++;
+	if (*p == '[')
+		p++;
+	while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+		p++;
+	if (*p == '"')
+	{
+		const char *cStart = ++p;
+		// Names with escape sequences are never bound, so they simply don't match.
+		while (*p && *p != '"' && *p != '\\')
+			p++;
+		nLen = (size_t)(p - cStart);
+		if (*p == '"' && nLen > 0 && nLen < sizeof(cName))
+		{
+			memcpy(cName, cStart, nLen);
+			cName[nLen] = '\0';
+			p++;
+			pBind = ring_webview_find_bind(pRingWebView, cName);
+		}
+	}
+
+	if (!pBind)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		webview_return(pRingWebView->webview, id, 1, "\"unknown binding\"");
 		return;
 	}
 
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+	while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+		p++;
+	const char *cRest = (*p == ',') ? p + 1 : "]";
+	size_t nRest = strlen(cRest);
+	char *cArgs = (char *)ring_state_malloc(pRingWebView->pMainRingState, nRest + 2);
+	if (cArgs == NULL)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		webview_return(pRingWebView->webview, id, 1, "\"out of memory\"");
 		return;
 	}
-	const char *js_name = RING_API_GETSTRING(2);
-	const char *ring_func_name = RING_API_GETSTRING(3);
+	cArgs[0] = '[';
+	memcpy(cArgs + 1, cRest, nRest + 1);
 
-	RingWebViewBind *pBind = (RingWebViewBind *)RING_API_MALLOC(sizeof(RingWebViewBind));
+	ring_webview_bind_callback(id, cArgs, pBind);
+	ring_state_free(pRingWebView->pMainRingState, cArgs);
+}
+
+// Allocate a bind record; pObject is set for method bindings.
+static RingWebViewBind *ring_webview_new_bind(void *pState, RingWebView *pRingWebView, const char *cName,
+											  const char *cFunc, List *pObject)
+{
+	RingWebViewBind *pBind = (RingWebViewBind *)ring_state_malloc(pState, sizeof(RingWebViewBind));
 	if (pBind == NULL)
 	{
-		RING_API_ERROR(RING_OOM);
-		return;
+		return NULL;
 	}
 
 	// Use the main RingState stored when webview was created
 	pBind->pMainRingState = pRingWebView->pMainRingState;
-	pBind->cFunc = ring_webview_string_strdup(RING_API_STATE, ring_func_name);
-	if (pBind->cFunc == NULL)
-	{
-		RING_API_FREE(pBind);
-		RING_API_ERROR(RING_OOM);
-		return;
+	pBind->pRingWebView = NULL;
+	pBind->pObject = pObject;
+	pBind->nTimeoutMs = 0;
+	pBind->nPriority = RING_WEBVIEW_PRIORITY_NORMAL;
+	pBind->bRouted = 0;
+	pBind->pCache = NULL;
+	pBind->nActiveCalls = 0;
+	pBind->bReleased = 0;
+	pBind->pPrev = NULL;
+	pBind->pNext = NULL;
+	pBind->cFunc = ring_webview_string_strdup(pState, cFunc);
+	pBind->cName = ring_webview_string_strdup(pState, cName);
+	if (pBind->cFunc == NULL || pBind->cName == NULL)
+	{
+		ring_webview_bind_free(pState, pBind);
+		return NULL;
 	}
-	// Ring function names are stored in lowercase internally
+	// Ring function and method names are stored in lowercase internally
 	ring_general_lower(pBind->cFunc);
+	return pBind;
+}
+
+static webview_error_t ring_webview_register_bind(RingWebView *pRingWebView, RingWebViewBind *pBind)
+{
+	webview_error_t result = WEBVIEW_ERROR_OK;
 
-	webview_error_t result = webview_bind(pRingWebView->webview, js_name, ring_webview_bind_callback, pBind);
+	// Routed bindings are only added to the name map; the page script is untouched.
+	pBind->bRouted = pRingWebView->bRouted;
+	if (!pBind->bRouted)
+		result = webview_bind(pRingWebView->webview, pBind->cName, ring_webview_bind_callback, pBind);
 
 	if (result == WEBVIEW_ERROR_OK)
 	{
-		// Return a managed C pointer.
-		RING_API_RETMANAGEDCPOINTER(pBind, "webview_bind_t", ring_webview_bind_free);
+		if (!ring_webview_map_set(pRingWebView->pBindMap, pBind->cName, pBind))
+		{
+			if (!pBind->bRouted)
+				webview_unbind(pRingWebView->webview, pBind->cName);
+			return WEBVIEW_ERROR_UNSPECIFIED;
+		}
+		pBind->pRingWebView = pRingWebView;
+		pBind->pNext = pRingWebView->pBinds;
+		if (pRingWebView->pBinds)
+			pRingWebView->pBinds->pPrev = pBind;
+		pRingWebView->pBinds = pBind;
+		pRingWebView->nLiveBinds++;
+		pRingWebView->nLiveBindBytes += ring_webview_bind_bytes(pBind);
+	}
+	return result;
+}
+
+/* Bind cName to a Ring function (or a method of pObject). The registry owns
+ * one record per name: binding a name again reuses its record, and options
+ * such as timeouts and caching start over for the new target. */
+static webview_error_t ring_webview_bind_name(void *pState, RingWebView *pRingWebView, const char *cName,
+											  const char *cFunc, List *pObject, RingWebViewBind **ppBind)
+{
+	RingWebViewBind *pBind = ring_webview_find_bind(pRingWebView, cName);
+	*ppBind = NULL;
+
+	if (pBind)
+	{
+		char *cNewFunc = ring_webview_string_strdup(pBind->pMainRingState, cFunc);
+		if (cNewFunc == NULL)
+		{
+			return WEBVIEW_ERROR_UNSPECIFIED;
+		}
+		ring_general_lower(cNewFunc);
+		pRingWebView->nLiveBindBytes -= ring_webview_bind_bytes(pBind);
+		ring_state_free(pBind->pMainRingState, pBind->cFunc);
+		pBind->cFunc = cNewFunc;
+		pBind->pObject = pObject;
+		pBind->nTimeoutMs = 0;
+		if (pBind->pCache)
+		{
+			ring_webview_cache_free(pBind->pCache);
+			pBind->pCache = NULL;
+		}
+		pRingWebView->nLiveBindBytes += ring_webview_bind_bytes(pBind);
+		*ppBind = pBind;
+		return WEBVIEW_ERROR_OK;
+	}
+
+	pBind = ring_webview_new_bind(pState, pRingWebView, cName, cFunc, pObject);
+	if (pBind == NULL)
+	{
+		return WEBVIEW_ERROR_UNSPECIFIED;
 	}
-	else
+	webview_error_t result = ring_webview_register_bind(pRingWebView, pBind);
+	if (result != WEBVIEW_ERROR_OK)
 	{
-		// Failure: free the allocated memory and return the error code.
-		ring_webview_bind_free(RING_API_STATE, pBind);
-		RING_API_RETNUMBER(result);
+		ring_webview_bind_free(pState, pBind);
+		return result;
 	}
+	*ppBind = pBind;
+	return WEBVIEW_ERROR_OK;
 }
 
-RING_FUNC(ring_webview_unbind)
+// Drop a bind record from the registry; freed now, or once its running call returns.
+static void ring_webview_release_bind(RingWebViewBind *pBind)
 {
-	if (RING_API_PARACOUNT != 2)
+	ring_webview_discard_deferred(pBind, NULL);
+	ring_webview_detach_bind(pBind);
+	if (pBind->nActiveCalls > 0)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		pBind->bReleased = 1;
+		return;
+	}
+	ring_webview_bind_free(pBind->pMainRingState, pBind);
+}
+
+static void ring_webview_release_binds(RingWebView *pRingWebView)
+{
+	while (pRingWebView->pBinds)
+	{
+		ring_webview_release_bind(pRingWebView->pBinds);
+	}
+}
+
+// The C callback that webview will call on the main thread for dispatch
+void ring_webview_dispatch_callback(webview_t w, void *arg)
+{
+	if (arg == NULL)
+	{
+		return;
+	}
+
+	RingWebViewDispatch *pDispatch = (RingWebViewDispatch *)arg;
+	RingState *pRingState = pDispatch->pRingState;
+
+	// Use the main VM from RingState
+	if (pRingState == NULL || pRingState->pVM == NULL)
+	{
+		return;
+	}
+
+	// A handler is suspended in webview_yield(); run the code after it returns.
+	if (bRingWebViewYielding && ring_webview_defer_dispatch(pDispatch))
 		return;
+
+	// Execute the Ring code using the main VM
+	double nTrace = ring_webview_trace_begin();
+	nRingWebViewCallDepth++;
+	ring_webview_watchdog_enter("dispatch", NULL);
+	ring_vm_runcodefromthread(pRingState->pVM, pDispatch->cCode);
+	ring_webview_watchdog_leave();
+	nRingWebViewCallDepth--;
+	ring_webview_trace_end("dispatch", "dispatch", nTrace);
+
+	// Free the allocated memory
+	ring_state_free(pRingState, pDispatch->cCode);
+	ring_state_free(pRingState, pDispatch);
+
+	ring_webview_flush_deferred_calls();
+	ring_webview_deliver_stall_report();
+}
+
+/* ============================================================================
+ * Scheduler
+ * ============================================================================ */
+
+/* Dispatches and bound calls compete for the one Ring VM. Dispatches, and
+ * bound calls that can't run at once, wait in one queue per priority class
+ * and are run one per pass of the event loop, from a low priority idle
+ * callback, so input reaching the loop meanwhile is handled first. The most
+ * urgent class goes first; a class whose oldest task has waited longer than
+ * the starvation limit gets every other turn until it catches up. Interactive
+ * and normal calls run at once when nothing as urgent is queued and no
+ * class behind them is starved. */
+
+typedef struct RingWebViewTask
+{
+	RingState *pRingState;
+	// A dispatch, or a bound call when pBind is set.
+	RingWebViewDispatch *pDispatch;
+	RingWebViewBind *pBind;
+	char *cId;
+	char *cReq;
+	// Used to queue the next drain where webview_dispatch() is needed; NULL once destroyed.
+	webview_t pWebView;
+	int nPriority;
+	double nArrivalMs;
+	struct RingWebViewTask *pNext;
+} RingWebViewTask;
+
+typedef struct RingWebViewScheduler
+{
+	int bMutexReady;
+	// Guards the queues, which other threads add dispatches to.
+	RingWebViewMutex oMutex;
+	RingWebViewTask *aHead[RING_WEBVIEW_PRIORITY_COUNT];
+	RingWebViewTask *aTail[RING_WEBVIEW_PRIORITY_COUNT];
+	unsigned int aQueued[RING_WEBVIEW_PRIORITY_COUNT];
+	// A drain is waiting on the event loop; pDrainWebView is the webview it went through.
+	int bDrainQueued;
+	webview_t pDrainWebView;
+	int bLastPromoted;
+	double nStarvationMs;
+	// Updated on the UI thread only.
+	double aRan[RING_WEBVIEW_PRIORITY_COUNT];
+	double aPromoted[RING_WEBVIEW_PRIORITY_COUNT];
+	RingWebViewHistogram aWait[RING_WEBVIEW_PRIORITY_COUNT];
+	RingWebViewHistogram aLatency[RING_WEBVIEW_PRIORITY_COUNT];
+} RingWebViewScheduler;
+
+static RingWebViewScheduler oRingWebViewScheduler;
+
+static const char *ring_webview_priority_name(int nPriority)
+{
+	switch (nPriority)
+	{
+	case RING_WEBVIEW_PRIORITY_INTERACTIVE:
+		return "interactive";
+	case RING_WEBVIEW_PRIORITY_BACKGROUND:
+		return "background";
+	default:
+		return "normal";
+	}
+}
+
+// Called on the UI thread before the first webview exists, so before any dispatch.
+static void ring_webview_scheduler_init(void)
+{
+	if (oRingWebViewScheduler.bMutexReady)
+		return;
+	ring_webview_mutex_init(&oRingWebViewScheduler.oMutex);
+	oRingWebViewScheduler.nStarvationMs = RING_WEBVIEW_STARVATION_MS;
+	oRingWebViewScheduler.bMutexReady = 1;
+}
+
+static void ring_webview_scheduler_record(int nPriority, double nArrivalMs, double nStartMs)
+{
+	double nNow = ring_webview_now_ms();
+	oRingWebViewScheduler.aRan[nPriority]++;
+	ring_webview_hist_record(&oRingWebViewScheduler.aWait[nPriority], (nStartMs - nArrivalMs) * 1000.0);
+	ring_webview_hist_record(&oRingWebViewScheduler.aLatency[nPriority], (nNow - nArrivalMs) * 1000.0);
+}
+
+static void ring_webview_task_free(RingWebViewTask *pTask)
+{
+	if (pTask->pDispatch)
+	{
+		ring_state_free(pTask->pRingState, pTask->pDispatch->cCode);
+		ring_state_free(pTask->pRingState, pTask->pDispatch);
+	}
+	if (pTask->cId)
+		ring_state_free(pTask->pRingState, pTask->cId);
+	if (pTask->cReq)
+		ring_state_free(pTask->pRingState, pTask->cReq);
+	ring_state_free(pTask->pRingState, pTask);
+}
+
+static void ring_webview_on_drain(webview_t w, void *arg);
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+static gboolean ring_webview_on_drain_idle(gpointer user_data)
+{
+	ring_webview_on_drain(NULL, user_data);
+	return G_SOURCE_REMOVE;
+}
+#endif
+
+// Queues a drain on the event loop; the caller holds the scheduler mutex and has set bDrainQueued.
+static int ring_webview_scheduler_kick(webview_t pWebView)
+{
+#ifdef WEBVIEW_PLATFORM_UNIX
+	// Below input and redraws, which the default priorities of GTK put first.
+	(void)pWebView;
+	g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, ring_webview_on_drain_idle, NULL, NULL);
+	return 1;
+#else
+	// A task whose webview is gone drains through another queued task's, or any open window.
+	for (int i = 0; i < RING_WEBVIEW_PRIORITY_COUNT && !pWebView; i++)
+	{
+		for (RingWebViewTask *pTask = oRingWebViewScheduler.aHead[i]; pTask && !pWebView; pTask = pTask->pNext)
+			pWebView = pTask->pWebView;
+	}
+	if (!pWebView)
+		pWebView = ring_webview_any_window();
+	oRingWebViewScheduler.pDrainWebView = pWebView;
+	return pWebView && webview_dispatch(pWebView, ring_webview_on_drain, NULL) == WEBVIEW_ERROR_OK;
+#endif
+}
+
+// The next task to run, or -1; the caller holds the scheduler mutex.
+static int ring_webview_scheduler_pick(double nNow)
+{
+	int nClass = -1;
+	for (int i = 0; i < RING_WEBVIEW_PRIORITY_COUNT && nClass < 0; i++)
+	{
+		if (oRingWebViewScheduler.aHead[i])
+			nClass = i;
+	}
+	if (nClass < 0)
+		return -1;
+
+	// Starvation protection: a class that has waited too long takes every other turn.
+	int nStarved = -1;
+	if (!oRingWebViewScheduler.bLastPromoted)
+	{
+		double nOldest = oRingWebViewScheduler.aHead[nClass]->nArrivalMs;
+		for (int i = nClass + 1; i < RING_WEBVIEW_PRIORITY_COUNT; i++)
+		{
+			RingWebViewTask *pHead = oRingWebViewScheduler.aHead[i];
+			if (pHead && nNow - pHead->nArrivalMs > oRingWebViewScheduler.nStarvationMs &&
+				pHead->nArrivalMs < nOldest)
+			{
+				nStarved = i;
+				nOldest = pHead->nArrivalMs;
+			}
+		}
+	}
+	oRingWebViewScheduler.bLastPromoted = nStarved >= 0;
+	if (nStarved >= 0)
+	{
+		oRingWebViewScheduler.aPromoted[nStarved]++;
+		return nStarved;
+	}
+	return nClass;
+}
+
+// Adds a task from any thread, queueing a drain if none is waiting.
+static void ring_webview_scheduler_push(RingWebViewTask *pTask)
+{
+	int nPriority = pTask->nPriority;
+	pTask->pNext = NULL;
+	pTask->nArrivalMs = ring_webview_now_ms();
+	ring_webview_mutex_lock(&oRingWebViewScheduler.oMutex);
+	if (oRingWebViewScheduler.aTail[nPriority])
+		oRingWebViewScheduler.aTail[nPriority]->pNext = pTask;
+	else
+		oRingWebViewScheduler.aHead[nPriority] = pTask;
+	oRingWebViewScheduler.aTail[nPriority] = pTask;
+	oRingWebViewScheduler.aQueued[nPriority]++;
+	if (!oRingWebViewScheduler.bDrainQueued)
+		oRingWebViewScheduler.bDrainQueued = ring_webview_scheduler_kick(pTask->pWebView);
+	ring_webview_mutex_unlock(&oRingWebViewScheduler.oMutex);
+}
+
+static void ring_webview_run_task(RingWebViewTask *pTask, double nStartMs)
+{
+	if (pTask->pDispatch)
+	{
+		RingWebViewDispatch *pDispatch = pTask->pDispatch;
+		pTask->pDispatch = NULL;
+		// Frees the dispatch.
+		ring_webview_dispatch_callback(NULL, pDispatch);
+		ring_webview_scheduler_record(pTask->nPriority, pTask->nArrivalMs, nStartMs);
+	}
+	else if (bRingWebViewYielding)
+	{
+		// Picked up by a pump inside a yielding handler; wait for it to return.
+		ring_webview_defer_call(pTask->pBind, pTask->cId, pTask->cReq);
+	}
+	else
+	{
+		if (!ring_webview_is_call_cancelled(pTask->pBind->pRingWebView, pTask->cId))
+			ring_webview_invoke_bind(pTask->pBind, pTask->cId, pTask->cReq);
+		ring_webview_scheduler_record(pTask->nPriority, pTask->nArrivalMs, nStartMs);
+		ring_webview_flush_deferred_calls();
+		ring_webview_deliver_stall_report();
+	}
+	ring_webview_task_free(pTask);
+}
+
+// Runs one queued task per pass, so input arriving in between goes first.
+static void ring_webview_on_drain(webview_t w, void *arg)
+{
+	(void)w;
+	(void)arg;
+	double nNow = ring_webview_now_ms();
+	ring_webview_mutex_lock(&oRingWebViewScheduler.oMutex);
+	int nClass = ring_webview_scheduler_pick(nNow);
+	RingWebViewTask *pTask = NULL;
+	if (nClass >= 0)
+	{
+		pTask = oRingWebViewScheduler.aHead[nClass];
+		oRingWebViewScheduler.aHead[nClass] = pTask->pNext;
+		if (!oRingWebViewScheduler.aHead[nClass])
+			oRingWebViewScheduler.aTail[nClass] = NULL;
+		oRingWebViewScheduler.aQueued[nClass]--;
+	}
+	// Queue the next pass before running, since the task may pump the loop itself.
+	RingWebViewTask *pNext = NULL;
+	for (int i = 0; i < RING_WEBVIEW_PRIORITY_COUNT && !pNext; i++)
+		pNext = oRingWebViewScheduler.aHead[i];
+	oRingWebViewScheduler.bDrainQueued = pNext ? ring_webview_scheduler_kick(pNext->pWebView) : 0;
+	ring_webview_mutex_unlock(&oRingWebViewScheduler.oMutex);
+
+	if (pTask)
+		ring_webview_run_task(pTask, nNow);
+}
+
+// Whether a bound call of this class has to wait behind queued work.
+static int ring_webview_scheduler_should_queue(int nPriority)
+{
+	if (nPriority == RING_WEBVIEW_PRIORITY_BACKGROUND)
+		return 1;
+	int bQueue = 0;
+	ring_webview_mutex_lock(&oRingWebViewScheduler.oMutex);
+	for (int i = 0; i <= nPriority && !bQueue; i++)
+		bQueue = oRingWebViewScheduler.aHead[i] != NULL;
+	// A starved class behind it gets its turn first, so the call goes through the queue too.
+	double nNow = ring_webview_now_ms();
+	for (int i = nPriority + 1; i < RING_WEBVIEW_PRIORITY_COUNT && !bQueue; i++)
+	{
+		RingWebViewTask *pHead = oRingWebViewScheduler.aHead[i];
+		bQueue = pHead && nNow - pHead->nArrivalMs > oRingWebViewScheduler.nStarvationMs;
+	}
+	ring_webview_mutex_unlock(&oRingWebViewScheduler.oMutex);
+	return bQueue;
+}
+
+// Queues a bound call; returns 0 (and the call runs at once) if memory runs out.
+static int ring_webview_scheduler_push_call(RingWebViewBind *pBind, const char *id, const char *req)
+{
+	RingState *pRingState = pBind->pMainRingState;
+	RingWebViewTask *pTask = (RingWebViewTask *)ring_state_calloc(pRingState, 1, sizeof(RingWebViewTask));
+	if (!pTask)
+		return 0;
+	pTask->pRingState = pRingState;
+	pTask->pBind = pBind;
+	pTask->cId = ring_webview_string_strdup(pRingState, id);
+	pTask->cReq = ring_webview_string_strdup(pRingState, req);
+	pTask->pWebView = pBind->pRingWebView ? pBind->pRingWebView->webview : NULL;
+	pTask->nPriority = pBind->nPriority;
+	if (!pTask->cId || !pTask->cReq)
+	{
+		ring_webview_task_free(pTask);
+		return 0;
+	}
+	ring_webview_scheduler_push(pTask);
+	return 1;
+}
+
+// Queues a dispatch from any thread; frees it and returns an error if it can't be run.
+static webview_error_t ring_webview_scheduler_push_dispatch(RingWebView *pRingWebView, RingWebViewDispatch *pDispatch)
+{
+	RingWebViewTask *pTask =
+		(RingWebViewTask *)ring_state_calloc(pDispatch->pRingState, 1, sizeof(RingWebViewTask));
+	if (!pTask)
+	{
+		ring_state_free(pDispatch->pRingState, pDispatch->cCode);
+		ring_state_free(pDispatch->pRingState, pDispatch);
+		return WEBVIEW_ERROR_UNSPECIFIED;
+	}
+	pTask->pRingState = pDispatch->pRingState;
+	pTask->pDispatch = pDispatch;
+	pTask->pWebView = pRingWebView->webview;
+	pTask->nPriority = pDispatch->nPriority;
+	ring_webview_scheduler_push(pTask);
+	return WEBVIEW_ERROR_OK;
+}
+
+// Drops the queued calls of a bind record about to be freed.
+static void ring_webview_scheduler_discard_calls(RingWebViewBind *pBind)
+{
+	if (!oRingWebViewScheduler.bMutexReady)
+		return;
+	ring_webview_mutex_lock(&oRingWebViewScheduler.oMutex);
+	for (int i = 0; i < RING_WEBVIEW_PRIORITY_COUNT; i++)
+	{
+		RingWebViewTask **ppLink = &oRingWebViewScheduler.aHead[i];
+		RingWebViewTask *pLast = NULL;
+		while (*ppLink)
+		{
+			RingWebViewTask *pTask = *ppLink;
+			if (pTask->pBind == pBind)
+			{
+				*ppLink = pTask->pNext;
+				oRingWebViewScheduler.aQueued[i]--;
+				ring_webview_task_free(pTask);
+			}
+			else
+			{
+				pLast = pTask;
+				ppLink = &pTask->pNext;
+			}
+		}
+		oRingWebViewScheduler.aTail[i] = pLast;
+	}
+	ring_webview_mutex_unlock(&oRingWebViewScheduler.oMutex);
+}
+
+/* Forgets a webview about to be destroyed. Its dispatches still run on the
+ * main VM; where drains go through webview_dispatch(), a drain queued on
+ * this webview is lost with it and is queued again on another one. */
+static void ring_webview_scheduler_detach(RingWebView *pRingWebView)
+{
+	if (!oRingWebViewScheduler.bMutexReady)
+		return;
+	ring_webview_mutex_lock(&oRingWebViewScheduler.oMutex);
+	for (int i = 0; i < RING_WEBVIEW_PRIORITY_COUNT; i++)
+	{
+		for (RingWebViewTask *pTask = oRingWebViewScheduler.aHead[i]; pTask; pTask = pTask->pNext)
+		{
+			if (pTask->pWebView == pRingWebView->webview)
+				pTask->pWebView = NULL;
+		}
+	}
+#ifndef WEBVIEW_PLATFORM_UNIX
+	// The webview is already off the window list, so the kick picks another one.
+	if (oRingWebViewScheduler.bDrainQueued && oRingWebViewScheduler.pDrainWebView == pRingWebView->webview)
+		oRingWebViewScheduler.bDrainQueued = ring_webview_scheduler_kick(NULL);
+#endif
+	ring_webview_mutex_unlock(&oRingWebViewScheduler.oMutex);
+}
+
+// Helper to destroy webview and free resources to avoid duplication.
+void ring_webview_destroy_internal(RingWebView *pRingWebView)
+{
+	if (pRingWebView && pRingWebView->webview)
+	{
+		ring_webview_clear_pending_calls(pRingWebView);
+		ring_webview_release_binds(pRingWebView);
+		ring_webview_clear_timers(pRingWebView);
+		ring_webview_discard_deferred(NULL, pRingWebView);
+		ring_webview_detach_jobs(pRingWebView);
+		ring_webview_stop_isolate(pRingWebView);
+		ring_webview_scheduler_detach(pRingWebView);
+#ifdef WEBVIEW_PLATFORM_UNIX
+		ring_webview_cancel_snapshots(pRingWebView);
+		ring_webview_cancel_pdf_jobs(pRingWebView);
+		ring_webview_detach_memory_release(pRingWebView);
+		ring_webview_stop_background(pRingWebView);
+#endif
+#ifdef WEBVIEW_PLATFORM_MACOS
+		ring_webview_macos_unwatch_close(pRingWebView->pCloseObserver);
+		pRingWebView->pCloseObserver = NULL;
+#endif
+		webview_destroy(pRingWebView->webview);
+		pRingWebView->webview = NULL;
+#ifdef WEBVIEW_PLATFORM_UNIX
+		// webview doesn't destroy windows it was handed.
+		if (pRingWebView->pOwnedWindow)
+		{
+			gtk_window_destroy(GTK_WINDOW(pRingWebView->pOwnedWindow));
+			pRingWebView->pOwnedWindow = NULL;
+		}
+#endif
+	}
+}
+
+// Adds the arguments of an event callback to pOut.
+typedef void (*RingWebViewPushArgs)(RingWebViewEventArgs *pOut, void *pArgs);
+
+static void ring_webview_event_arg(RingWebViewEventArgs *pOut, int nType, double nValue, const char *cValue,
+								   size_t nSize)
+{
+	if (pOut->nCount >= RING_WEBVIEW_EVENT_MAX_ARGS)
+		return;
+	RingWebViewEventArg *pArg = &pOut->aArgs[pOut->nCount++];
+	pArg->nType = nType;
+	pArg->nValue = nValue;
+	pArg->cValue = cValue;
+	pArg->nSize = nSize;
+}
+
+static void ring_webview_event_number(RingWebViewEventArgs *pOut, double nValue)
+{
+	ring_webview_event_arg(pOut, RING_WEBVIEW_EVENT_ARG_NUMBER, nValue, NULL, 0);
+}
+
+static void ring_webview_event_string(RingWebViewEventArgs *pOut, const char *cValue, size_t nSize)
+{
+	ring_webview_event_arg(pOut, RING_WEBVIEW_EVENT_ARG_STRING, 0, cValue, nSize);
+}
+
+static void ring_webview_event_json(RingWebViewEventArgs *pOut, const char *cJson)
+{
+	ring_webview_event_arg(pOut, RING_WEBVIEW_EVENT_ARG_JSON, 0, cJson, cJson ? strlen(cJson) : 0);
+}
+
+static void ring_webview_push_event_args(VM *pVM, const RingWebViewEventArgs *pArgs)
+{
+	for (int i = 0; i < pArgs->nCount; i++)
+	{
+		const RingWebViewEventArg *pArg = &pArgs->aArgs[i];
+		if (pArg->nType == RING_WEBVIEW_EVENT_ARG_NUMBER)
+		{
+			RING_VM_STACK_PUSHNVALUE(pArg->nValue);
+		}
+		else if (pArg->nType == RING_WEBVIEW_EVENT_ARG_STRING)
+		{
+			RING_VM_STACK_PUSHCVALUE2(pArg->cValue, pArg->nSize);
+		}
+		else
+		{
+			List *pList = pArg->cValue ? json_decode_to_ring_list(pVM, pArg->cValue) : NULL;
+			if (!pList)
+				pList = ring_vm_api_newlist(pVM);
+			ring_vm_api_retlist2(pVM, pList, RING_OUTPUT_RETLISTBYREF);
+		}
+	}
+}
+
+/* Runs an event callback on the main VM. fPush supplies its arguments (NULL
+ * for none); cRecordArg and nBytesIn describe them for the recorder and stats.
+ * While a handler is yielding the callback is queued with copies of its
+ * arguments and runs after that handler returns. */
+static void ring_webview_call_event_with(RingWebView *pRingWebView, const char *cCallback, const char *cRecordArg,
+										 size_t nBytesIn, RingWebViewPushArgs fPush, void *pArgs)
+{
+	if (!pRingWebView || !pRingWebView->pMainRingState || !cCallback)
+		return;
+
+	if (!pRingWebView->bRunning)
+		return;
+
+	RingWebViewEventArgs oArgs;
+	oArgs.nCount = 0;
+	if (fPush)
+		fPush(&oArgs, pArgs);
+
+	if (bRingWebViewYielding)
+	{
+		ring_webview_defer_event(pRingWebView, cCallback, cRecordArg, nBytesIn, &oArgs);
+		return;
+	}
+	ring_webview_run_event(pRingWebView, cCallback, cRecordArg, nBytesIn, &oArgs);
+}
+
+static void ring_webview_run_event(RingWebView *pRingWebView, const char *cCallback, const char *cRecordArg,
+								   size_t nBytesIn, const RingWebViewEventArgs *pArgs)
+{
+	if (!pRingWebView->bRunning)
+		return;
+
+	RingState *pRingState = pRingWebView->pMainRingState;
+	VM *pVM = pRingState->pVM;
+	if (!pVM)
+		return;
+
+	ring_webview_record(RING_WEBVIEW_RECORD_EVENT, cCallback, cRecordArg, NULL, 0);
+
+	// Events are reported as "event:<callback>" next to the bound functions.
+	RingWebViewStats *pStats = NULL;
+	double nStart = 0, nMutexWaitMs = 0;
+	// The handler may replace its own callback, so the span keeps a copy of the name.
+	double nTrace = ring_webview_trace_begin();
+	char cTraceName[RING_WEBVIEW_TRACE_NAME_SIZE];
+	if (nTrace)
+		snprintf(cTraceName, sizeof(cTraceName), "%s", cCallback);
+	if (pRingWebView->bStats)
+	{
+		char cKey[RING_WEBVIEW_MAX_ROUTE_NAME];
+		snprintf(cKey, sizeof(cKey), "event:%s", cCallback);
+		pStats = ring_webview_stats_for(pRingWebView, cKey);
+		nStart = ring_webview_now_ms();
+	}
+
+	ring_vm_mutexlock(pVM);
+	if (pStats)
+	{
+		nMutexWaitMs = ring_webview_now_ms() - nStart;
+		pStats->nCalls++;
+		pStats->nBytesIn += nBytesIn;
+		ring_webview_hist_record(&pStats->hMutexWait, nMutexWaitMs * 1000.0);
+	}
+	nRingWebViewCallDepth++;
+	ring_webview_watchdog_enter("event", cCallback);
+
+	int nSP_before = pVM->nSP;
+	int nFuncSP_before = pVM->nFuncSP;
+	int nCallListSize_before = RING_VM_FUNCCALLSCOUNT;
+
+	if (!ring_vm_loadfunc2(pVM, (char *)cCallback, RING_FALSE))
+	{
+		pVM->nSP = nSP_before;
+		pVM->nFuncSP = nFuncSP_before;
+		if (pStats)
+			pStats->nErrors++;
+		ring_webview_trace_end("event", cTraceName, nTrace);
+		ring_webview_watchdog_leave();
+		nRingWebViewCallDepth--;
+		ring_vm_mutexunlock(pVM);
+		return;
+	}
+
+	ring_webview_push_event_args(pVM, pArgs);
+
+	double nVMStart = pStats ? ring_webview_now_ms() : 0;
+	ring_vm_call2(pVM);
+
+	while (RING_VM_FUNCCALLSCOUNT > nCallListSize_before)
+	{
+		ring_vm_fetch(pVM);
+	}
+
+	if (pStats)
+	{
+		double nEnd = ring_webview_now_ms();
+		ring_webview_hist_record(&pStats->hVM, (nEnd - nVMStart) * 1000.0);
+		ring_webview_hist_record(&pStats->hLatency, (nEnd - nStart) * 1000.0);
+	}
+
+	pVM->nSP = nSP_before;
+	pVM->nFuncSP = nFuncSP_before;
+	ring_webview_trace_end("event", cTraceName, nTrace);
+
+	ring_webview_watchdog_leave();
+	nRingWebViewCallDepth--;
+	ring_vm_mutexunlock(pVM);
+
+	ring_webview_flush_deferred_calls();
+	ring_webview_deliver_stall_report();
+}
+
+static void ring_webview_push_string_arg(RingWebViewEventArgs *pOut, void *pArgs)
+{
+	const char *cArg = (const char *)pArgs;
+	ring_webview_event_string(pOut, cArg, strlen(cArg));
+}
+
+static void ring_webview_call_event(RingWebView *pRingWebView, const char *cCallback, const char *cArg)
+{
+	ring_webview_call_event_with(pRingWebView, cCallback, cArg, cArg ? strlen(cArg) : 0,
+								 cArg ? ring_webview_push_string_arg : NULL, (void *)cArg);
+}
+
+// Hands a finished stall report to the owner's onStall callback, once no handler is running.
+static void ring_webview_deliver_stall_report(void)
+{
+	if (nRingWebViewCallDepth > 0 || bRingWebViewYielding)
+		return;
+
+	char cReport[RING_WEBVIEW_WATCHDOG_REPORT_SIZE];
+	RingWebView *pOwner = (RingWebView *)ring_webview_watchdog_take_report(cReport, sizeof(cReport));
+	if (pOwner && pOwner->cOnStall)
+	{
+		ring_webview_call_event(pOwner, pOwner->cOnStall, cReport);
+	}
+}
+
+/* ============================================================================
+ * Platform-specific Helpers (Windows)
+ * ============================================================================ */
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+static HWND ring_webview_get_hwnd(RingWebView *pRingWebView)
+{
+	if (!pRingWebView || !pRingWebView->webview)
+		return NULL;
+	return (HWND)webview_get_window(pRingWebView->webview);
+}
+
+static BOOL CALLBACK ring_webview_monitor_enum_proc(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor,
+													LPARAM dwData)
+{
+	(void)hdcMonitor;
+	(void)lprcMonitor;
+	List *pList = (List *)dwData;
+	MONITORINFOEXW mi;
+	mi.cbSize = sizeof(mi);
+	if (GetMonitorInfoW(hMonitor, (LPMONITORINFO)&mi))
+	{
+		char name[64];
+		WideCharToMultiByte(CP_UTF8, 0, mi.szDevice, -1, name, sizeof(name), NULL, NULL);
+
+		List *pScreenList = ring_list_newlist_gc(NULL, pList);
+		ring_list_addstring_gc(NULL, pScreenList, name);
+		ring_list_adddouble_gc(NULL, pScreenList, (double)mi.rcMonitor.left);
+		ring_list_adddouble_gc(NULL, pScreenList, (double)mi.rcMonitor.top);
+		ring_list_adddouble_gc(NULL, pScreenList, (double)(mi.rcMonitor.right - mi.rcMonitor.left));
+		ring_list_adddouble_gc(NULL, pScreenList, (double)(mi.rcMonitor.bottom - mi.rcMonitor.top));
+	}
+	return TRUE;
+}
+
+static int ring_webview_pump_events(int nMaxEvents)
+{
+	MSG msg;
+	int nEvents = 0;
+	while (nEvents < nMaxEvents && PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+	{
+		if (msg.message == WM_QUIT)
+		{
+			// Leave WM_QUIT for the loop in webview_run().
+			PostQuitMessage((int)msg.wParam);
+			break;
+		}
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+		nEvents++;
+	}
+	return nEvents;
+}
+
+// Waits up to nTimeoutMs (-1 forever) for a message, then handles what is queued.
+static int ring_webview_step_events(int nTimeoutMs, int *pQuit)
+{
+	MSG msg;
+	int nEvents = 0;
+	if (nTimeoutMs != 0 && !PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE))
+		MsgWaitForMultipleObjectsEx(0, NULL, nTimeoutMs < 0 ? INFINITE : (DWORD)nTimeoutMs, QS_ALLINPUT,
+									MWMO_INPUTAVAILABLE);
+	while (nEvents < RING_WEBVIEW_YIELD_MAX_EVENTS && PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+	{
+		// webview_terminate() and closing the window both post WM_QUIT.
+		if (msg.message == WM_QUIT)
+		{
+			*pQuit = 1;
+			break;
+		}
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+		nEvents++;
+	}
+	return nEvents;
+}
+#endif
+
+/* ============================================================================
+ * Platform-specific Helpers (Linux/FreeBSD)
+ * ============================================================================ */
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+static GtkWindow *ring_webview_get_gtk_window(RingWebView *pRingWebView)
+{
+	if (!pRingWebView || !pRingWebView->webview)
+		return NULL;
+	return GTK_WINDOW(webview_get_window(pRingWebView->webview));
+}
+
+/* A headless webview lives in a toplevel that is realized but never mapped,
+ * so GTK never lays it out on its own. Allocating it by hand gives the page a
+ * real viewport; without it WebKit renders into a 0x0 view. */
+static void ring_webview_allocate_offscreen(GtkWidget *pWindow, int nWidth, int nHeight)
+{
+	if (!pWindow || nWidth <= 0 || nHeight <= 0)
+		return;
+	GtkAllocation oAllocation = {0, 0, nWidth, nHeight};
+	gtk_window_set_default_size(GTK_WINDOW(pWindow), nWidth, nHeight);
+	gtk_widget_realize(pWindow);
+	gtk_widget_size_allocate(pWindow, &oAllocation, -1);
+}
+
+static void ring_webview_headless_allocate(RingWebView *pRingWebView, int nWidth, int nHeight)
+{
+	ring_webview_allocate_offscreen(pRingWebView->pOwnedWindow, nWidth, nHeight);
+	// A window that is never shown gets no surface layout to learn its size from.
+	if (nWidth > 0 && nHeight > 0)
+		ring_webview_note_size(pRingWebView, nWidth, nHeight);
+}
+
+static int ring_webview_pump_events(int nMaxEvents)
+{
+	int nEvents = 0;
+	while (nEvents < nMaxEvents && g_main_context_pending(NULL))
+	{
+		g_main_context_iteration(NULL, FALSE);
+		nEvents++;
+	}
+	return nEvents;
+}
+
+static gboolean ring_webview_on_step_timeout(gpointer user_data)
+{
+	*(int *)user_data = 1;
+	return G_SOURCE_REMOVE;
+}
+
+/* Blocks in one main context iteration for up to nTimeoutMs (-1 forever),
+ * then handles whatever else is ready. A timeout source bounds the wait,
+ * so the GTK loop itself does the polling. */
+static int ring_webview_step_events(int nTimeoutMs)
+{
+	int nEvents = 0;
+	if (nTimeoutMs != 0 && !g_main_context_pending(NULL))
+	{
+		int bTimedOut = 0;
+		guint nTimer = 0;
+		if (nTimeoutMs > 0)
+			nTimer = g_timeout_add((guint)nTimeoutMs, ring_webview_on_step_timeout, &bTimedOut);
+		g_main_context_iteration(NULL, TRUE);
+		if (!bTimedOut)
+		{
+			if (nTimer)
+				g_source_remove(nTimer);
+			nEvents++;
+		}
+	}
+	return nEvents + ring_webview_pump_events(RING_WEBVIEW_YIELD_MAX_EVENTS);
+}
+
+/* Prepares the default main context and reports the descriptors it would
+ * poll and how long it would sleep. Checking the sources afterwards leaves
+ * the context ready for the next iteration; nothing is dispatched. */
+static int ring_webview_query_poll_fds(GPollFD *aFds, int nMax, int *pTimeoutMs)
+{
+	GMainContext *pContext = g_main_context_default();
+	*pTimeoutMs = -1;
+	if (!g_main_context_acquire(pContext))
+		return 0;
+	gint nPriority = 0, nTimeout = -1;
+	if (g_main_context_prepare(pContext, &nPriority))
+		nTimeout = 0;
+	gint nFds = g_main_context_query(pContext, nPriority, &nTimeout, aFds, nMax);
+	if (nFds > nMax)
+		nFds = nMax;
+	for (int i = 0; i < nFds; i++)
+		aFds[i].revents = 0;
+	g_main_context_check(pContext, nPriority, aFds, nFds);
+	g_main_context_release(pContext);
+	*pTimeoutMs = nTimeout;
+	return nFds;
+}
+
+static void ring_webview_on_click(GtkGestureClick *gesture, gint n_press, gdouble x, gdouble y, gpointer user_data)
+{
+	(void)n_press;
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	if (!pRingWebView)
+		return;
+
+	GtkEventController *controller = GTK_EVENT_CONTROLLER(gesture);
+	GdkEvent *event = gtk_event_controller_get_current_event(controller);
+	if (!event)
+		return;
+
+	GtkWidget *widget = gtk_event_controller_get_widget(controller);
+	GtkNative *native = gtk_widget_get_native(widget);
+	GdkSurface *surface = gtk_native_get_surface(native);
+
+	pRingWebView->pLastDevice = gdk_event_get_device(event);
+	pRingWebView->pLastSurface = surface;
+	pRingWebView->nLastButton = (int)gdk_button_event_get_button(event);
+	pRingWebView->nLastTime = gdk_event_get_time(event);
+	pRingWebView->dLastX = x;
+	pRingWebView->dLastY = y;
+	pRingWebView->bHasClickData = TRUE;
+}
+
+static void ring_webview_setup_drag_handler(RingWebView *pRingWebView)
+{
+	if (!pRingWebView || !pRingWebView->webview)
+		return;
+
+	GtkWidget *webview_widget =
+		(GtkWidget *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WIDGET);
+	if (!webview_widget)
+		return;
+
+	GtkGesture *gesture = gtk_gesture_click_new();
+	gtk_gesture_single_set_button(GTK_GESTURE_SINGLE(gesture), 0);
+	g_signal_connect(gesture, "pressed", G_CALLBACK(ring_webview_on_click), pRingWebView);
+	gtk_widget_add_controller(webview_widget, GTK_EVENT_CONTROLLER(gesture));
+
+	pRingWebView->bHasClickData = FALSE;
+}
+
+/* Snapshots. webkit_web_view_get_snapshot() captures the page into a
+ * GdkTexture asynchronously; the pixels are handed to Ring as a PNG or raw RGBA
+ * string together with their size, without going through a file. */
+
+typedef struct RingWebViewSnapshot
+{
+	RingWebView *pRingWebView; // NULL once the webview is destroyed
+	RingState *pRingState;
+	char *cCallback;
+	double nId;
+	int nFormat;
+	int bBatch;
+	GCancellable *pCancellable;
+	struct RingWebViewSnapshot *pNext;
+} RingWebViewSnapshot;
+
+/* A batch loads its items one after another into the webview. As soon as an
+ * item's pixels are captured the next item starts loading, so encoding and the
+ * Ring callback overlap with the next page load. */
+typedef struct RingWebViewSnapshotBatch
+{
+	char **aItems;
+	unsigned int nItems;
+	unsigned int nNext;
+	unsigned int nLoading; // 1-based item waiting for its load to finish, 0 if none
+	unsigned int nDone;
+	int nRegion;
+	int nFormat;
+	char *cCallback;
+} RingWebViewSnapshotBatch;
+
+typedef struct RingWebViewSnapshotResult
+{
+	double nId;
+	const char *cData;
+	size_t nSize;
+	double nWidth;
+	double nHeight;
+} RingWebViewSnapshotResult;
+
+static void ring_webview_push_snapshot_args(RingWebViewEventArgs *pOut, void *pArgs)
+{
+	RingWebViewSnapshotResult *pResult = (RingWebViewSnapshotResult *)pArgs;
+	ring_webview_event_number(pOut, pResult->nId);
+	ring_webview_event_string(pOut, pResult->cData, pResult->nSize);
+	ring_webview_event_number(pOut, pResult->nWidth);
+	ring_webview_event_number(pOut, pResult->nHeight);
+}
+
+static void ring_webview_free_snapshot_batch(RingState *pRingState, RingWebViewSnapshotBatch *pBatch)
+{
+	for (unsigned int i = 0; i < pBatch->nItems; i++)
+		ring_state_free(pRingState, pBatch->aItems[i]);
+	ring_state_free(pRingState, pBatch->aItems);
+	ring_state_free(pRingState, pBatch->cCallback);
+	ring_state_free(pRingState, pBatch);
+}
+
+// Pending snapshots finish after the webview is gone; detach them so their callbacks only clean up.
+static void ring_webview_cancel_snapshots(RingWebView *pRingWebView)
+{
+	RingWebViewSnapshot *pSnapshot = pRingWebView->pSnapshots;
+	while (pSnapshot)
+	{
+		pSnapshot->pRingWebView = NULL;
+		g_cancellable_cancel(pSnapshot->pCancellable);
+		pSnapshot = pSnapshot->pNext;
+	}
+	pRingWebView->pSnapshots = NULL;
+	if (pRingWebView->pSnapshotBatch)
+	{
+		ring_webview_free_snapshot_batch(pRingWebView->pMainRingState, pRingWebView->pSnapshotBatch);
+		pRingWebView->pSnapshotBatch = NULL;
+	}
+}
+
+static int ring_webview_source_is_url(const char *cItem)
+{
+	static const char *aSchemes[] = {"http://", "https://", "file://", "data:", "about:"};
+	for (size_t i = 0; i < sizeof(aSchemes) / sizeof(aSchemes[0]); i++)
+	{
+		if (strncmp(cItem, aSchemes[i], strlen(aSchemes[i])) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+static void ring_webview_snapshot_batch_next(RingWebView *pRingWebView)
+{
+	RingWebViewSnapshotBatch *pBatch = pRingWebView->pSnapshotBatch;
+	if (!pBatch || pBatch->nNext >= pBatch->nItems)
+		return;
+	const char *cItem = pBatch->aItems[pBatch->nNext++];
+	pBatch->nLoading = pBatch->nNext;
+	if (ring_webview_source_is_url(cItem))
+		webview_navigate(pRingWebView->webview, cItem);
+	else
+		webview_set_html(pRingWebView->webview, cItem);
+}
+
+/* Converts a texture to the requested format. On success *pData is owned by
+ * the caller: a GBytes for PNG (*pBytes) or a ring_state_malloc() buffer for
+ * RGBA. */
+static int ring_webview_snapshot_encode(RingState *pRingState, GdkTexture *texture, int nFormat, GBytes **pBytes,
+										unsigned char **pData, size_t *pSize)
+{
+	*pBytes = NULL;
+	*pData = NULL;
+	*pSize = 0;
+	if (nFormat == RING_WEBVIEW_SNAPSHOT_PNG)
+	{
+		gsize nSize = 0;
+		*pBytes = gdk_texture_save_to_png_bytes(texture);
+		if (!*pBytes)
+			return 0;
+		*pData = (unsigned char *)g_bytes_get_data(*pBytes, &nSize);
+		*pSize = nSize;
+		return 1;
+	}
+
+	// gdk_texture_download() yields premultiplied ARGB32 in native byte order.
+	size_t nWidth = (size_t)gdk_texture_get_width(texture);
+	size_t nHeight = (size_t)gdk_texture_get_height(texture);
+	size_t nSize = nWidth * nHeight * 4;
+	unsigned char *pPixels = (unsigned char *)ring_state_malloc(pRingState, nSize ? nSize : 1);
+	if (!pPixels)
+		return 0;
+	gdk_texture_download(texture, pPixels, nWidth * 4);
+	for (size_t i = 0; i < nSize; i += 4)
+	{
+		uint32_t nPixel;
+		memcpy(&nPixel, pPixels + i, 4);
+		unsigned int a = nPixel >> 24;
+		unsigned int r = (nPixel >> 16) & 0xFF, g = (nPixel >> 8) & 0xFF, b = nPixel & 0xFF;
+		if (a && a != 255)
+		{
+			r = (r * 255 + a / 2) / a;
+			g = (g * 255 + a / 2) / a;
+			b = (b * 255 + a / 2) / a;
+		}
+		pPixels[i] = (unsigned char)r;
+		pPixels[i + 1] = (unsigned char)g;
+		pPixels[i + 2] = (unsigned char)b;
+		pPixels[i + 3] = (unsigned char)a;
+	}
+	*pData = pPixels;
+	*pSize = nSize;
+	return 1;
+}
+
+static void ring_webview_on_snapshot_ready(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	RingWebViewSnapshot *pSnapshot = (RingWebViewSnapshot *)user_data;
+	RingWebView *pRingWebView = pSnapshot->pRingWebView;
+	RingState *pRingState = pSnapshot->pRingState;
+	GError *error = NULL;
+	GdkTexture *texture = webkit_web_view_get_snapshot_finish(WEBKIT_WEB_VIEW(source), result, &error);
+
+	if (pRingWebView)
+	{
+		RingWebViewSnapshot **ppLink = &pRingWebView->pSnapshots;
+		while (*ppLink && *ppLink != pSnapshot)
+			ppLink = &(*ppLink)->pNext;
+		if (*ppLink)
+			*ppLink = pSnapshot->pNext;
+
+		// The pixels are captured; start the next batch item before encoding this one.
+		if (pSnapshot->bBatch && pRingWebView->pSnapshotBatch)
+		{
+			RingWebViewSnapshotBatch *pBatch = pRingWebView->pSnapshotBatch;
+			ring_webview_snapshot_batch_next(pRingWebView);
+			// Free the finished batch first so the last callback can start another one.
+			if (++pBatch->nDone == pBatch->nItems)
+			{
+				ring_webview_free_snapshot_batch(pRingState, pBatch);
+				pRingWebView->pSnapshotBatch = NULL;
+			}
+		}
+
+		RingWebViewSnapshotResult oResult = {pSnapshot->nId, "", 0, 0, 0};
+		GBytes *pBytes = NULL;
+		unsigned char *pData = NULL;
+		if (texture && ring_webview_snapshot_encode(pRingState, texture, pSnapshot->nFormat, &pBytes, &pData,
+													&oResult.nSize))
+		{
+			oResult.cData = (const char *)pData;
+			oResult.nWidth = gdk_texture_get_width(texture);
+			oResult.nHeight = gdk_texture_get_height(texture);
+		}
+		else
+		{
+			// Failures are reported with a 0x0 size and the error message as data.
+			oResult.cData = error ? error->message : "Snapshot failed";
+			oResult.nSize = strlen(oResult.cData);
+		}
+		double nTrace = ring_webview_trace_begin();
+		ring_webview_call_event_with(pRingWebView, pSnapshot->cCallback, NULL, oResult.nSize,
+									 ring_webview_push_snapshot_args, &oResult);
+		ring_webview_trace_end("gtk", "snapshot", nTrace);
+
+		if (pBytes)
+			g_bytes_unref(pBytes);
+		else if (pData)
+			ring_state_free(pRingState, pData);
+	}
+
+	if (texture)
+		g_object_unref(texture);
+	if (error)
+		g_error_free(error);
+	g_object_unref(pSnapshot->pCancellable);
+	ring_state_free(pRingState, pSnapshot->cCallback);
+	ring_state_free(pRingState, pSnapshot);
+}
+
+static RingWebViewSnapshot *ring_webview_snapshot_begin(RingWebView *pRingWebView, int nRegion, int nFormat,
+														const char *cCallback, double nId, int bBatch)
+{
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (!web_view)
+		return NULL;
+
+	RingState *pRingState = pRingWebView->pMainRingState;
+	RingWebViewSnapshot *pSnapshot = (RingWebViewSnapshot *)ring_state_malloc(pRingState, sizeof(RingWebViewSnapshot));
+	if (!pSnapshot)
+		return NULL;
+	pSnapshot->cCallback = ring_webview_string_strdup(pRingState, cCallback);
+	if (!pSnapshot->cCallback)
+	{
+		ring_state_free(pRingState, pSnapshot);
+		return NULL;
+	}
+	pSnapshot->pRingWebView = pRingWebView;
+	pSnapshot->pRingState = pRingState;
+	pSnapshot->nId = nId;
+	pSnapshot->nFormat = nFormat;
+	pSnapshot->bBatch = bBatch;
+	pSnapshot->pCancellable = g_cancellable_new();
+	pSnapshot->pNext = pRingWebView->pSnapshots;
+	pRingWebView->pSnapshots = pSnapshot;
+
+	webkit_web_view_get_snapshot(
+		web_view,
+		nRegion == RING_WEBVIEW_SNAPSHOT_FULL_DOCUMENT ? WEBKIT_SNAPSHOT_REGION_FULL_DOCUMENT
+													   : WEBKIT_SNAPSHOT_REGION_VISIBLE,
+		WEBKIT_SNAPSHOT_OPTIONS_NONE, pSnapshot->pCancellable, ring_webview_on_snapshot_ready, pSnapshot);
+	return pSnapshot;
+}
+
+// Reports a batch item whose capture could not start and moves the batch on, as a finished capture does.
+static void ring_webview_snapshot_batch_failed(RingWebView *pRingWebView, double nIndex)
+{
+	RingWebViewSnapshotBatch *pBatch = pRingWebView->pSnapshotBatch;
+	char cCallback[RING_WEBVIEW_MAX_ROUTE_NAME];
+	snprintf(cCallback, sizeof(cCallback), "%s", pBatch->cCallback);
+	ring_webview_snapshot_batch_next(pRingWebView);
+	if (++pBatch->nDone == pBatch->nItems)
+	{
+		ring_webview_free_snapshot_batch(pRingWebView->pMainRingState, pBatch);
+		pRingWebView->pSnapshotBatch = NULL;
+	}
+
+	const char *cError = "Could not start the snapshot";
+	RingWebViewSnapshotResult oResult = {nIndex, cError, strlen(cError), 0, 0};
+	ring_webview_call_event_with(pRingWebView, cCallback, NULL, oResult.nSize, ring_webview_push_snapshot_args,
+								 &oResult);
+}
+
+/* PDF export. A WebKitPrintOperation prints without a dialog when its
+ * settings select GTK's file printer. The operation emits "failed" (with the
+ * error) before "finished", so the error is kept until then. */
+
+typedef struct RingWebViewPdfOptions
+{
+	char cPaper[RING_WEBVIEW_PDF_PAPER_SIZE]; // GTK paper name, empty for the locale default
+	int bLandscape;
+	double nMargin; // millimetres on every side, negative for the paper's default
+} RingWebViewPdfOptions;
+
+/* A batch prints its documents with a pool of hidden webviews. Each worker
+ * loads a document, prints it once the load has finished, then takes the next
+ * one, so up to nWorkers documents are rendered at the same time. */
+typedef struct RingWebViewPdfWorker
+{
+	struct RingWebViewPdfBatch *pBatch;
+	GtkWidget *pWindow;
+	WebKitWebView *pWebView;
+	gulong nLoadHandler;
+	unsigned int nJob; // 1-based document waiting for its load to finish, 0 if none
+} RingWebViewPdfWorker;
+
+typedef struct RingWebViewPdfBatch
+{
+	RingWebView *pRingWebView;
+	char **aSources;
+	char **aPaths;
+	unsigned int nJobs;
+	unsigned int nNext;
+	unsigned int nDone;
+	unsigned int nFailed;
+	RingWebViewPdfOptions oOptions;
+	char *cCallback;
+	RingWebViewPdfWorker aWorkers[RING_WEBVIEW_PDF_MAX_WORKERS];
+	unsigned int nWorkers;
+	double nStart;
+	double nElapsed;
+} RingWebViewPdfBatch;
+
+typedef struct RingWebViewPdfJob
+{
+	RingWebView *pRingWebView; // NULL once the webview is destroyed
+	RingState *pRingState;
+	char *cCallback;
+	char *cPath;
+	char *cError;
+	double nId;
+	RingWebViewPdfWorker *pWorker; // batch worker that printed it, NULL for printToPDF()
+	struct RingWebViewPdfJob *pNext;
+	// Kept while the job waits for the file printer lookup.
+	WebKitWebView *pWebView;
+	char *cUri;
+	RingWebViewPdfOptions oOptions;
+	struct RingWebViewPdfJob *pWaitNext;
+} RingWebViewPdfJob;
+
+typedef struct RingWebViewPdfResult
+{
+	double nId;
+	const char *cPath;
+	const char *cError;
+} RingWebViewPdfResult;
+
+static void ring_webview_push_pdf_args(RingWebViewEventArgs *pOut, void *pArgs)
+{
+	RingWebViewPdfResult *pResult = (RingWebViewPdfResult *)pArgs;
+	ring_webview_event_number(pOut, pResult->nId);
+	ring_webview_event_string(pOut, pResult->cPath, strlen(pResult->cPath));
+	ring_webview_event_string(pOut, pResult->cError, strlen(pResult->cError));
+}
+
+// Reads [key, value] pairs: "paper" (a3, a4, a5, letter, legal or a GTK paper name), "orientation", "margin" (mm).
+static int ring_webview_pdf_parse_options(List *pList, RingWebViewPdfOptions *pOptions)
+{
+	static const char *aPapers[][2] = {
+		{"a3", "iso_a3"}, {"a4", "iso_a4"}, {"a5", "iso_a5"}, {"letter", "na_letter"}, {"legal", "na_legal"}};
+
+	pOptions->cPaper[0] = '\0';
+	pOptions->bLandscape = 0;
+	pOptions->nMargin = -1;
+	for (unsigned int i = 1; i <= ring_list_getsize(pList); i++)
+	{
+		if (!ring_list_islist(pList, i))
+			return 0;
+		List *pPair = ring_list_getlist(pList, i);
+		if (ring_list_getsize(pPair) != 2 || !ring_list_isstring(pPair, 1))
+			return 0;
+		const char *cKey = ring_list_getstring(pPair, 1);
+		if (strcmp(cKey, "paper") == 0 && ring_list_isstring(pPair, 2))
+		{
+			const char *cPaper = ring_list_getstring(pPair, 2);
+			for (size_t p = 0; p < sizeof(aPapers) / sizeof(aPapers[0]); p++)
+			{
+				if (strcmp(cPaper, aPapers[p][0]) == 0)
+				{
+					cPaper = aPapers[p][1];
+					break;
+				}
+			}
+			snprintf(pOptions->cPaper, sizeof(pOptions->cPaper), "%s", cPaper);
+		}
+		else if (strcmp(cKey, "orientation") == 0 && ring_list_isstring(pPair, 2))
+		{
+			pOptions->bLandscape = strcmp(ring_list_getstring(pPair, 2), "landscape") == 0;
+		}
+		else if (strcmp(cKey, "margin") == 0 && ring_list_isnumber(pPair, 2))
+		{
+			pOptions->nMargin = ring_list_getdouble(pPair, 2);
+		}
+		else
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void ring_webview_on_pdf_failed(WebKitPrintOperation *operation, GError *error, gpointer user_data)
+{
+	RingWebViewPdfJob *pJob = (RingWebViewPdfJob *)user_data;
+	(void)operation;
+	if (!pJob->cError)
+		pJob->cError = ring_webview_string_strdup(pJob->pRingState, error && error->message ? error->message
+																						  : "Printing failed");
+}
+
+static gboolean ring_webview_pdf_destroy_window_idle(gpointer user_data)
+{
+	gtk_window_destroy(GTK_WINDOW(user_data));
+	return G_SOURCE_REMOVE;
+}
+
+// Destroys the hidden webviews. Inside one of their signals the windows are destroyed from an idle callback.
+static void ring_webview_pdf_release_workers(RingWebViewPdfBatch *pBatch, int bDeferred)
+{
+	for (unsigned int i = 0; i < pBatch->nWorkers; i++)
+	{
+		RingWebViewPdfWorker *pWorker = &pBatch->aWorkers[i];
+		if (pWorker->nLoadHandler)
+		{
+			g_signal_handler_disconnect(pWorker->pWebView, pWorker->nLoadHandler);
+			pWorker->nLoadHandler = 0;
+		}
+		if (pWorker->pWindow)
+		{
+			if (bDeferred)
+				g_idle_add(ring_webview_pdf_destroy_window_idle, pWorker->pWindow);
+			else
+				gtk_window_destroy(GTK_WINDOW(pWorker->pWindow));
+			pWorker->pWindow = NULL;
+			pWorker->pWebView = NULL;
+		}
+	}
+}
+
+static void ring_webview_free_pdf_batch(RingState *pRingState, RingWebViewPdfBatch *pBatch)
+{
+	ring_webview_pdf_release_workers(pBatch, 0);
+	for (unsigned int i = 0; i < pBatch->nJobs; i++)
+	{
+		if (pBatch->aSources)
+			ring_state_free(pRingState, pBatch->aSources[i]);
+		if (pBatch->aPaths)
+			ring_state_free(pRingState, pBatch->aPaths[i]);
+	}
+	ring_state_free(pRingState, pBatch->aSources);
+	ring_state_free(pRingState, pBatch->aPaths);
+	ring_state_free(pRingState, pBatch->cCallback);
+	ring_state_free(pRingState, pBatch);
+}
+
+// Print operations can't be cancelled; detach them so they only clean up when they finish.
+static void ring_webview_cancel_pdf_jobs(RingWebView *pRingWebView)
+{
+	for (RingWebViewPdfJob *pJob = pRingWebView->pPdfJobs; pJob; pJob = pJob->pNext)
+	{
+		pJob->pRingWebView = NULL;
+		pJob->pWorker = NULL;
+	}
+	pRingWebView->pPdfJobs = NULL;
+	if (pRingWebView->pPdfBatch)
+	{
+		ring_webview_free_pdf_batch(pRingWebView->pMainRingState, pRingWebView->pPdfBatch);
+		pRingWebView->pPdfBatch = NULL;
+	}
+}
+
+static void ring_webview_on_pdf_finished(WebKitPrintOperation *operation, gpointer user_data);
+static void ring_webview_pdf_job_done(RingWebViewPdfJob *pJob);
+
+static void ring_webview_pdf_print(RingWebViewPdfJob *pJob, WebKitWebView *web_view, const char *cPrinter,
+								   const char *cUri, const RingWebViewPdfOptions *pOptions)
+{
+	GtkPrintSettings *settings = gtk_print_settings_new();
+	gtk_print_settings_set_printer(settings, cPrinter);
+	gtk_print_settings_set(settings, GTK_PRINT_SETTINGS_OUTPUT_FILE_FORMAT, "pdf");
+	gtk_print_settings_set(settings, GTK_PRINT_SETTINGS_OUTPUT_URI, cUri);
+
+	GtkPageSetup *setup = gtk_page_setup_new();
+	GtkPaperSize *paper = gtk_paper_size_new(pOptions->cPaper[0] ? pOptions->cPaper : NULL);
+	gtk_page_setup_set_paper_size(setup, paper);
+	gtk_paper_size_free(paper);
+	gtk_page_setup_set_orientation(setup, pOptions->bLandscape ? GTK_PAGE_ORIENTATION_LANDSCAPE
+															   : GTK_PAGE_ORIENTATION_PORTRAIT);
+	if (pOptions->nMargin >= 0)
+	{
+		gtk_page_setup_set_top_margin(setup, pOptions->nMargin, GTK_UNIT_MM);
+		gtk_page_setup_set_bottom_margin(setup, pOptions->nMargin, GTK_UNIT_MM);
+		gtk_page_setup_set_left_margin(setup, pOptions->nMargin, GTK_UNIT_MM);
+		gtk_page_setup_set_right_margin(setup, pOptions->nMargin, GTK_UNIT_MM);
+	}
+
+	WebKitPrintOperation *operation = webkit_print_operation_new(web_view);
+	webkit_print_operation_set_print_settings(operation, settings);
+	webkit_print_operation_set_page_setup(operation, setup);
+	g_object_unref(settings);
+	g_object_unref(setup);
+	g_signal_connect(operation, "failed", G_CALLBACK(ring_webview_on_pdf_failed), pJob);
+	g_signal_connect(operation, "finished", G_CALLBACK(ring_webview_on_pdf_finished), pJob);
+	webkit_print_operation_print(operation);
+}
+
+/* GTK's file printer. Its name is translated, so with gtk4-unix-print it is
+ * found by what it does. The lookup runs in the background, since printer
+ * backends can take a while to answer; jobs started before it ends wait in
+ * a list and are printed (or failed) once it does. Without gtk4-unix-print
+ * the English name is used. */
+
+enum
+{
+	RING_WEBVIEW_PRINTER_UNKNOWN,
+	RING_WEBVIEW_PRINTER_LOOKING,
+	RING_WEBVIEW_PRINTER_KNOWN
+};
+
+#ifdef RING_WEBVIEW_UNIX_PRINT
+static const char *cRingWebViewFilePrinter = NULL;
+static int nRingWebViewPrinterLookup = RING_WEBVIEW_PRINTER_UNKNOWN;
+#else
+static const char *cRingWebViewFilePrinter = "Print to File";
+static int nRingWebViewPrinterLookup = RING_WEBVIEW_PRINTER_KNOWN;
+#endif
+static RingWebViewPdfJob *pRingWebViewWaitingPdf = NULL;
+
+#ifdef RING_WEBVIEW_UNIX_PRINT
+static gboolean ring_webview_match_file_printer(GtkPrinter *printer, gpointer data)
+{
+	(void)data;
+	if (!gtk_printer_is_virtual(printer) || !gtk_printer_accepts_pdf(printer))
+		return FALSE;
+	cRingWebViewFilePrinter = g_strdup(gtk_printer_get_name(printer));
+	return TRUE;
+}
+
+static gboolean ring_webview_file_printer_found_idle(gpointer user_data)
+{
+	(void)user_data;
+	nRingWebViewPrinterLookup = RING_WEBVIEW_PRINTER_KNOWN;
+	RingWebViewPdfJob *pJob = pRingWebViewWaitingPdf;
+	pRingWebViewWaitingPdf = NULL;
+	while (pJob)
+	{
+		RingWebViewPdfJob *pWaitNext = pJob->pWaitNext;
+		pJob->pWaitNext = NULL;
+		if (pJob->pRingWebView && cRingWebViewFilePrinter)
+		{
+			ring_webview_pdf_print(pJob, pJob->pWebView, cRingWebViewFilePrinter, pJob->cUri, &pJob->oOptions);
+			g_object_unref(pJob->pWebView);
+			g_free(pJob->cUri);
+			pJob->pWebView = NULL;
+			pJob->cUri = NULL;
+		}
+		else
+		{
+			if (pJob->pRingWebView && !pJob->cError)
+				pJob->cError = ring_webview_string_strdup(pJob->pRingState, "No PDF printer is available");
+			ring_webview_pdf_job_done(pJob);
+		}
+		pJob = pWaitNext;
+	}
+	return G_SOURCE_REMOVE;
+}
+
+// Called when the enumeration ends, which may be before gtk_enumerate_printers() returns.
+static void ring_webview_file_printer_found(gpointer data)
+{
+	(void)data;
+	g_idle_add(ring_webview_file_printer_found_idle, NULL);
+}
+#endif
+
+static RingWebViewPdfJob *ring_webview_pdf_begin(RingWebView *pRingWebView, WebKitWebView *web_view,
+												  const char *cPath, const RingWebViewPdfOptions *pOptions,
+												  const char *cCallback, double nId, RingWebViewPdfWorker *pWorker)
+{
+	RingState *pRingState = pRingWebView->pMainRingState;
+	if (nRingWebViewPrinterLookup == RING_WEBVIEW_PRINTER_KNOWN && !cRingWebViewFilePrinter)
+		return NULL;
+	char *cAbsolute = g_canonicalize_filename(cPath, NULL);
+	char *cUri = cAbsolute ? g_filename_to_uri(cAbsolute, NULL, NULL) : NULL;
+	g_free(cAbsolute);
+	if (!cUri)
+		return NULL;
+
+	RingWebViewPdfJob *pJob = (RingWebViewPdfJob *)ring_state_calloc(pRingState, 1, sizeof(RingWebViewPdfJob));
+	if (!pJob)
+	{
+		g_free(cUri);
+		return NULL;
+	}
+	pJob->cCallback = ring_webview_string_strdup(pRingState, cCallback);
+	pJob->cPath = ring_webview_string_strdup(pRingState, cPath);
+	if (!pJob->cCallback || !pJob->cPath)
+	{
+		ring_state_free(pRingState, pJob->cCallback);
+		ring_state_free(pRingState, pJob->cPath);
+		ring_state_free(pRingState, pJob);
+		g_free(cUri);
+		return NULL;
+	}
+	pJob->pRingWebView = pRingWebView;
+	pJob->pRingState = pRingState;
+	pJob->nId = nId;
+	pJob->pWorker = pWorker;
+	pJob->pNext = pRingWebView->pPdfJobs;
+	pRingWebView->pPdfJobs = pJob;
+
+	if (nRingWebViewPrinterLookup == RING_WEBVIEW_PRINTER_KNOWN)
+	{
+		ring_webview_pdf_print(pJob, web_view, cRingWebViewFilePrinter, cUri, pOptions);
+		g_free(cUri);
+		return pJob;
+	}
+
+	pJob->pWebView = g_object_ref(web_view);
+	pJob->cUri = cUri;
+	pJob->oOptions = *pOptions;
+	pJob->pWaitNext = pRingWebViewWaitingPdf;
+	pRingWebViewWaitingPdf = pJob;
+#ifdef RING_WEBVIEW_UNIX_PRINT
+	if (nRingWebViewPrinterLookup == RING_WEBVIEW_PRINTER_UNKNOWN)
+	{
+		nRingWebViewPrinterLookup = RING_WEBVIEW_PRINTER_LOOKING;
+		gtk_enumerate_printers(ring_webview_match_file_printer, NULL, ring_webview_file_printer_found, FALSE);
+	}
+#endif
+	return pJob;
+}
+
+static void ring_webview_pdf_worker_next(RingWebViewPdfWorker *pWorker)
+{
+	RingWebViewPdfBatch *pBatch = pWorker->pBatch;
+	pWorker->nJob = 0;
+	if (pBatch->nNext >= pBatch->nJobs)
+		return;
+	const char *cSource = pBatch->aSources[pBatch->nNext++];
+	pWorker->nJob = pBatch->nNext;
+	if (ring_webview_source_is_url(cSource))
+		webkit_web_view_load_uri(pWorker->pWebView, cSource);
+	else
+		webkit_web_view_load_html(pWorker->pWebView, cSource, NULL);
+}
+
+// Books a finished document and hands the worker its next one.
+static void ring_webview_pdf_batch_advance(RingWebViewPdfWorker *pWorker, int bFailed)
+{
+	RingWebViewPdfBatch *pBatch = pWorker->pBatch;
+	pBatch->nDone++;
+	if (bFailed)
+		pBatch->nFailed++;
+	ring_webview_pdf_worker_next(pWorker);
+	if (pBatch->nDone == pBatch->nJobs)
+	{
+		pBatch->nElapsed = ring_webview_now_ms() - pBatch->nStart;
+		ring_webview_pdf_release_workers(pBatch, 1);
+	}
+}
+
+static void ring_webview_pdf_deliver(RingWebView *pRingWebView, const char *cCallback, double nId,
+									 const char *cPath, const char *cError)
+{
+	RingWebViewPdfResult oResult = {nId, cPath, cError};
+	double nTrace = ring_webview_trace_begin();
+	ring_webview_call_event_with(pRingWebView, cCallback, cPath, strlen(cPath), ring_webview_push_pdf_args,
+								 &oResult);
+	ring_webview_trace_end("gtk", "pdf", nTrace);
+}
+
+// Books a job that ended, successfully or not, and frees it.
+static void ring_webview_pdf_job_done(RingWebViewPdfJob *pJob)
+{
+	RingWebView *pRingWebView = pJob->pRingWebView;
+	RingState *pRingState = pJob->pRingState;
+
+	if (pRingWebView)
+	{
+		RingWebViewPdfJob **ppLink = &pRingWebView->pPdfJobs;
+		while (*ppLink && *ppLink != pJob)
+			ppLink = &(*ppLink)->pNext;
+		if (*ppLink)
+			*ppLink = pJob->pNext;
+
+		if (pJob->pWorker)
+			ring_webview_pdf_batch_advance(pJob->pWorker, pJob->cError != NULL);
+		ring_webview_pdf_deliver(pRingWebView, pJob->cCallback, pJob->nId, pJob->cPath,
+								 pJob->cError ? pJob->cError : "");
+	}
+
+	if (pJob->pWebView)
+		g_object_unref(pJob->pWebView);
+	g_free(pJob->cUri);
+	ring_state_free(pRingState, pJob->cCallback);
+	ring_state_free(pRingState, pJob->cPath);
+	ring_state_free(pRingState, pJob->cError);
+	ring_state_free(pRingState, pJob);
+}
+
+static void ring_webview_on_pdf_finished(WebKitPrintOperation *operation, gpointer user_data)
+{
+	ring_webview_pdf_job_done((RingWebViewPdfJob *)user_data);
+	g_object_unref(operation);
+}
+
+static void ring_webview_on_pdf_worker_load(WebKitWebView *web_view, WebKitLoadEvent load_event, gpointer user_data)
+{
+	RingWebViewPdfWorker *pWorker = (RingWebViewPdfWorker *)user_data;
+	if (load_event != WEBKIT_LOAD_FINISHED || !pWorker->nJob)
+		return;
+
+	RingWebViewPdfBatch *pBatch = pWorker->pBatch;
+	unsigned int nJob = pWorker->nJob;
+	pWorker->nJob = 0;
+	if (!ring_webview_pdf_begin(pBatch->pRingWebView, web_view, pBatch->aPaths[nJob - 1], &pBatch->oOptions,
+								pBatch->cCallback, nJob, pWorker))
+	{
+		RingWebView *pRingWebView = pBatch->pRingWebView;
+		// The batch may be freed by the callback once this was its last document.
+		char *cPath = g_strdup(pBatch->aPaths[nJob - 1]);
+		char cCallback[RING_WEBVIEW_MAX_ROUTE_NAME];
+		snprintf(cCallback, sizeof(cCallback), "%s", pBatch->cCallback);
+		ring_webview_pdf_batch_advance(pWorker, 1);
+		ring_webview_pdf_deliver(pRingWebView, cCallback, nJob, cPath, "Could not start printing");
+		g_free(cPath);
+	}
+}
+
+static int ring_webview_pdf_add_worker(RingWebViewPdfBatch *pBatch)
+{
+	RingWebViewPdfWorker *pWorker = &pBatch->aWorkers[pBatch->nWorkers];
+	pWorker->pBatch = pBatch;
+	pWorker->pWindow = gtk_window_new();
+	if (!pWorker->pWindow)
+		return 0;
+	GtkWidget *pView = webkit_web_view_new();
+	gtk_window_set_child(GTK_WINDOW(pWorker->pWindow), pView);
+	ring_webview_allocate_offscreen(pWorker->pWindow, RING_WEBVIEW_HEADLESS_WIDTH, RING_WEBVIEW_HEADLESS_HEIGHT);
+	pWorker->pWebView = WEBKIT_WEB_VIEW(pView);
+	pWorker->nLoadHandler =
+		g_signal_connect(pView, "load-changed", G_CALLBACK(ring_webview_on_pdf_worker_load), pWorker);
+	pWorker->nJob = 0;
+	pBatch->nWorkers++;
+	return 1;
+}
+
+/* Memory release. Clears the engine's in-memory cache, then reports the web
+ * processes' resident memory from before and after to onMemory(). Used by the
+ * low memory mode when the window is hidden or minimized. */
+
+typedef struct RingWebViewMemoryRelease
+{
+	RingWebView *pRingWebView; // NULL once the webview is destroyed
+	RingState *pRingState;
+	double nRssBefore;
+} RingWebViewMemoryRelease;
+
+static void ring_webview_push_memory_args(RingWebViewEventArgs *pOut, void *pArgs)
+{
+	double *aRss = (double *)pArgs;
+	ring_webview_event_number(pOut, aRss[0]);
+	ring_webview_event_number(pOut, aRss[1]);
+}
+
+static void ring_webview_detach_memory_release(RingWebView *pRingWebView)
+{
+	if (pRingWebView->pMemoryRelease)
+	{
+		pRingWebView->pMemoryRelease->pRingWebView = NULL;
+		pRingWebView->pMemoryRelease = NULL;
+	}
+}
+
+static void ring_webview_on_memory_released(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	RingWebViewMemoryRelease *pRelease = (RingWebViewMemoryRelease *)user_data;
+	webkit_website_data_manager_clear_finish(WEBKIT_WEBSITE_DATA_MANAGER(source), result, NULL);
+
+	RingWebView *pRingWebView = pRelease->pRingWebView;
+	double aRss[2] = {pRelease->nRssBefore, ring_webview_process_web_rss_kb()};
+	ring_state_free(pRelease->pRingState, pRelease);
+	if (!pRingWebView)
+		return;
+	pRingWebView->pMemoryRelease = NULL;
+	if (pRingWebView->cOnMemory)
+		ring_webview_call_event_with(pRingWebView, pRingWebView->cOnMemory, NULL, 0, ring_webview_push_memory_args,
+									 aRss);
+}
+
+// Returns 1 if a release is running, which may be one started earlier.
+static int ring_webview_free_engine_memory(RingWebView *pRingWebView)
+{
+	if (pRingWebView->pMemoryRelease)
+		return 1;
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (!web_view)
+		return 0;
+	RingWebViewMemoryRelease *pRelease =
+		(RingWebViewMemoryRelease *)ring_state_malloc(pRingWebView->pMainRingState, sizeof(RingWebViewMemoryRelease));
+	if (!pRelease)
+		return 0;
+	pRelease->pRingWebView = pRingWebView;
+	pRelease->pRingState = pRingWebView->pMainRingState;
+	pRelease->nRssBefore = ring_webview_process_web_rss_kb();
+	pRingWebView->pMemoryRelease = pRelease;
+
+	WebKitWebsiteDataManager *pManager =
+		webkit_network_session_get_website_data_manager(webkit_web_view_get_network_session(web_view));
+	webkit_website_data_manager_clear(pManager, WEBKIT_WEBSITE_DATA_MEMORY_CACHE, 0, NULL,
+									  ring_webview_on_memory_released, pRelease);
+	return 1;
+}
+
+/* Background policy. A window counts as in the background while it is hidden
+ * or minimized. Under WEBVIEW_BACKGROUND_THROTTLE the page's timers and
+ * animation frames are slowed to about once a second, CSS animations are
+ * paused, and dispatch() calls are held, merged when the same code is queued
+ * twice, and run once a second. WEBVIEW_BACKGROUND_PAUSE holds all of them
+ * until the window is back. Either way onVisibility() is told, so Ring-side
+ * producers can back off too. The page part is a script wrapping setTimeout,
+ * setInterval and requestAnimationFrame. */
+
+static const char *cRingWebViewBackgroundScript =
+	"(function () {"
+	"  if (window.__ringBackground) return;"
+	"  var nativeSetTimeout = window.setTimeout, nativeSetInterval = window.setInterval;"
+	"  var nativeClearTimeout = window.clearTimeout;"
+	"  var nativeRaf = window.requestAnimationFrame, nativeCancelRaf = window.cancelAnimationFrame;"
+	"  var state = { background: false, policy: 0, held: [], frames: {}, nextFrame: -1, style: null };"
+	"  window.__ringBackground = state;"
+	"  function runner(fn, args) {"
+	"    return function () {"
+	"      if (typeof fn === 'function') fn.apply(window, args); else (0, eval)(String(fn));"
+	"    };"
+	"  }"
+	"  window.setTimeout = function (fn, delay) {"
+	"    var run = runner(fn, Array.prototype.slice.call(arguments, 2));"
+	"    if (state.background && state.policy === 1 && !(delay >= 1000)) delay = 1000;"
+	"    return nativeSetTimeout.call(window, function () {"
+	"      if (state.background && state.policy === 2) state.held.push(run); else run();"
+	"    }, delay);"
+	"  };"
+	"  window.setInterval = function (fn, delay) {"
+	"    var run = runner(fn, Array.prototype.slice.call(arguments, 2)), last = 0, pending = false;"
+	"    return nativeSetInterval.call(window, function () {"
+	"      if (!state.background) { run(); return; }"
+	"      if (state.policy === 2) {"
+	"        if (!pending) { pending = true; state.held.push(function () { pending = false; run(); }); }"
+	"        return;"
+	"      }"
+	"      var now = Date.now();"
+	"      if (now - last >= 1000) { last = now; run(); }"
+	"    }, delay);"
+	"  };"
+	"  window.requestAnimationFrame = function (callback) {"
+	"    if (!state.background) return nativeRaf.call(window, callback);"
+	"    var id = state.nextFrame--;"
+	"    var run = function () { if (state.frames[id]) { delete state.frames[id]; callback(performance.now()); } };"
+	"    state.frames[id] = state.policy === 2 ? true : nativeSetTimeout.call(window, run, 1000);"
+	"    if (state.policy === 2) state.held.push(run);"
+	"    return id;"
+	"  };"
+	"  window.cancelAnimationFrame = function (id) {"
+	"    if (id >= 0) return nativeCancelRaf.call(window, id);"
+	"    if (state.frames[id] !== true) nativeClearTimeout.call(window, state.frames[id]);"
+	"    delete state.frames[id];"
+	"  };"
+	"  window.__ringSetBackground = function (visibility, policy) {"
+	"    var background = visibility !== 'visible' && policy > 0;"
+	"    state.policy = policy;"
+	"    if (background && !state.style && document.documentElement) {"
+	"      state.style = document.createElement('style');"
+	"      state.style.textContent = '*, *::before, *::after { animation-play-state: paused !important; }';"
+	"      document.documentElement.appendChild(state.style);"
+	"    } else if (!background && state.style) {"
+	"      state.style.remove();"
+	"      state.style = null;"
+	"    }"
+	"    var wasBackground = state.background;"
+	"    state.background = background;"
+	"    if (wasBackground && !background) {"
+	"      var held = state.held;"
+	"      state.held = [];"
+	"      held.forEach(function (run) { run(); });"
+	"    }"
+	"    window.dispatchEvent(new CustomEvent('ringvisibilitychange', { detail: { state: visibility } }));"
+	"  };"
+	"})();";
+
+static const char *ring_webview_visibility_name(int nVisibility)
+{
+	switch (nVisibility)
+	{
+	case RING_WEBVIEW_VISIBILITY_HIDDEN:
+		return "hidden";
+	case RING_WEBVIEW_VISIBILITY_MINIMIZED:
+		return "minimized";
+	default:
+		return "visible";
+	}
+}
+
+static int ring_webview_is_holding(RingWebView *pRingWebView)
+{
+	return pRingWebView->nBackgroundPolicy != RING_WEBVIEW_BACKGROUND_NONE &&
+		   pRingWebView->nVisibility != RING_WEBVIEW_VISIBILITY_VISIBLE;
+}
+
+// Tells the page the current state; needed again after every navigation.
+static void ring_webview_background_apply_page(RingWebView *pRingWebView)
+{
+	if (!pRingWebView->bBackgroundScript)
+		return;
+	char cScript[128];
+	snprintf(cScript, sizeof(cScript), "window.__ringSetBackground && window.__ringSetBackground('%s', %d);",
+			 ring_webview_visibility_name(pRingWebView->nVisibility), pRingWebView->nBackgroundPolicy);
+	webview_eval(pRingWebView->webview, cScript);
+}
+
+// Queues the held dispatches on the event loop, in the order they were made.
+static void ring_webview_flush_held_dispatches(RingWebView *pRingWebView)
+{
+	ring_webview_mutex_lock(&pRingWebView->oHeldMutex);
+	RingWebViewDispatch *pDispatch = pRingWebView->pHeld;
+	pRingWebView->pHeld = NULL;
+	ring_webview_mutex_unlock(&pRingWebView->oHeldMutex);
+
+	while (pDispatch)
+	{
+		RingWebViewDispatch *pNext = pDispatch->pNext;
+		pDispatch->pNext = NULL;
+		ring_webview_scheduler_push_dispatch(pRingWebView, pDispatch);
+		pDispatch = pNext;
+	}
+}
+
+/* Holds a dispatch made while the window is in the background, merging it
+ * with a held one running the same code. Returns 0 if it should go ahead. */
+static int ring_webview_hold_dispatch(RingWebView *pRingWebView, RingWebViewDispatch *pDispatch)
+{
+	ring_webview_mutex_lock(&pRingWebView->oHeldMutex);
+	if (!ring_webview_is_holding(pRingWebView))
+	{
+		ring_webview_mutex_unlock(&pRingWebView->oHeldMutex);
+		return 0;
+	}
+	RingWebViewDispatch **ppLast = &pRingWebView->pHeld;
+	for (; *ppLast; ppLast = &(*ppLast)->pNext)
+	{
+		if (strcmp((*ppLast)->cCode, pDispatch->cCode) == 0)
+		{
+			pRingWebView->nCoalescedDispatches++;
+			ring_webview_mutex_unlock(&pRingWebView->oHeldMutex);
+			ring_state_free(pDispatch->pRingState, pDispatch->cCode);
+			ring_state_free(pDispatch->pRingState, pDispatch);
+			return 1;
+		}
+	}
+	pDispatch->pNext = NULL;
+	*ppLast = pDispatch;
+	pRingWebView->nHeldDispatches++;
+	ring_webview_mutex_unlock(&pRingWebView->oHeldMutex);
+	return 1;
+}
+
+static gboolean ring_webview_on_throttle_tick(gpointer user_data)
+{
+	ring_webview_flush_held_dispatches((RingWebView *)user_data);
+	return G_SOURCE_CONTINUE;
+}
+
+static gboolean ring_webview_report_visibility(gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	pRingWebView->nVisibilitySource = 0;
+	if (pRingWebView->nReportedVisibility == pRingWebView->nVisibility)
+		return G_SOURCE_REMOVE;
+	pRingWebView->nReportedVisibility = pRingWebView->nVisibility;
+	if (pRingWebView->cOnVisibility)
+		ring_webview_call_event(pRingWebView, pRingWebView->cOnVisibility,
+								ring_webview_visibility_name(pRingWebView->nVisibility));
+	return G_SOURCE_REMOVE;
+}
+
+// Applies the policy for the current state: throttle timer, held dispatches and page.
+static void ring_webview_apply_background(RingWebView *pRingWebView)
+{
+	int bThrottle = ring_webview_is_holding(pRingWebView) &&
+					pRingWebView->nBackgroundPolicy == RING_WEBVIEW_BACKGROUND_THROTTLE;
+	if (bThrottle && !pRingWebView->nThrottleSource)
+		pRingWebView->nThrottleSource =
+			g_timeout_add(RING_WEBVIEW_THROTTLE_INTERVAL_MS, ring_webview_on_throttle_tick, pRingWebView);
+	else if (!bThrottle && pRingWebView->nThrottleSource)
+	{
+		g_source_remove(pRingWebView->nThrottleSource);
+		pRingWebView->nThrottleSource = 0;
+	}
+	if (!ring_webview_is_holding(pRingWebView))
+		ring_webview_flush_held_dispatches(pRingWebView);
+	ring_webview_background_apply_page(pRingWebView);
+}
+
+/* Works out whether the window is visible, hidden or minimized. Called from
+ * the window's notify::visible and notify::is-active handlers and its
+ * surface's notify::state; hide() and minimize() end up here through them.
+ * onVisibility() is called from an idle callback, since the change may
+ * happen inside a Ring call. */
+static void ring_webview_update_visibility(RingWebView *pRingWebView)
+{
+	if (!pRingWebView || !pRingWebView->webview || pRingWebView->bHeadless)
+		return;
+	GtkWindow *window =
+		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (!window)
+		return;
+
+	int nVisibility = RING_WEBVIEW_VISIBILITY_VISIBLE;
+	if (!gtk_widget_get_visible(GTK_WIDGET(window)))
+		nVisibility = RING_WEBVIEW_VISIBILITY_HIDDEN;
+	else if (pRingWebView->pStateSurface &&
+			 (gdk_toplevel_get_state(GDK_TOPLEVEL(pRingWebView->pStateSurface)) & GDK_TOPLEVEL_STATE_MINIMIZED))
+		nVisibility = RING_WEBVIEW_VISIBILITY_MINIMIZED;
+	if (nVisibility == pRingWebView->nVisibility)
+		return;
+
+	ring_webview_mutex_lock(&pRingWebView->oHeldMutex);
+	pRingWebView->nVisibility = nVisibility;
+	ring_webview_mutex_unlock(&pRingWebView->oHeldMutex);
+	ring_webview_apply_background(pRingWebView);
+	if (!pRingWebView->nVisibilitySource)
+		pRingWebView->nVisibilitySource = g_idle_add(ring_webview_report_visibility, pRingWebView);
+}
+
+static void ring_webview_on_toplevel_state(GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	(void)object;
+	(void)pspec;
+	ring_webview_update_visibility((RingWebView *)user_data);
+}
+
+static void ring_webview_on_window_visible(GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	(void)object;
+	(void)pspec;
+	ring_webview_update_visibility((RingWebView *)user_data);
+}
+
+/* Window geometry. The surface's layout signal reports every size change,
+ * from the user, the window manager or setSize(); the size is cached for
+ * getSize() and passed to onResize at most once per resize interval. A
+ * change held back by the interval is sent when it ends, so the last size
+ * always arrives. GTK4 doesn't tell toplevels their position. */
+
+static gboolean ring_webview_on_resize_due(gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	pRingWebView->nResizeSource = 0;
+	RingWebViewGeometry *pGeometry = &pRingWebView->oGeometry;
+	if (!pRingWebView->cOnResize || (pGeometry->nWidth == pRingWebView->nReportedWidth &&
+									 pGeometry->nHeight == pRingWebView->nReportedHeight))
+		return G_SOURCE_REMOVE;
+	pRingWebView->nReportedWidth = pGeometry->nWidth;
+	pRingWebView->nReportedHeight = pGeometry->nHeight;
+	pRingWebView->nResizeReportedMs = ring_webview_now_ms();
+
+	char cSize[64];
+	snprintf(cSize, sizeof(cSize), "{\"width\":%d,\"height\":%d}", pGeometry->nWidth, pGeometry->nHeight);
+	double nTrace = ring_webview_trace_begin();
+	ring_webview_call_event(pRingWebView, pRingWebView->cOnResize, cSize);
+	ring_webview_trace_end("gtk", "resize", nTrace);
+	return G_SOURCE_REMOVE;
+}
+
+static void ring_webview_note_size(RingWebView *pRingWebView, int nWidth, int nHeight)
+{
+	RingWebViewGeometry *pGeometry = &pRingWebView->oGeometry;
+	if (pGeometry->bKnown && pGeometry->nWidth == nWidth && pGeometry->nHeight == nHeight)
+		return;
+	pGeometry->bKnown = 1;
+	pGeometry->nWidth = nWidth;
+	pGeometry->nHeight = nHeight;
+	if (!pRingWebView->cOnResize || pRingWebView->nResizeSource)
+		return;
+
+	// Never from inside the layout signal, where Ring could resize the window again.
+	double nWaitMs = pRingWebView->nResizeReportedMs + pRingWebView->nResizeIntervalMs - ring_webview_now_ms();
+	if (nWaitMs < 1)
+		pRingWebView->nResizeSource = g_idle_add(ring_webview_on_resize_due, pRingWebView);
+	else
+		pRingWebView->nResizeSource = g_timeout_add((guint)nWaitMs, ring_webview_on_resize_due, pRingWebView);
+}
+
+static void ring_webview_on_layout(GdkSurface *surface, int width, int height, gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	if (!pRingWebView->webview)
+		return;
+	// GTK has allocated the window by now; its size leaves out the client-side shadow.
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	int nWidth = window ? gtk_widget_get_width(GTK_WIDGET(window)) : 0;
+	int nHeight = window ? gtk_widget_get_height(GTK_WIDGET(window)) : 0;
+	if (nWidth <= 0 || nHeight <= 0)
+	{
+		nWidth = width;
+		nHeight = height;
+	}
+	ring_webview_note_size(pRingWebView, nWidth, nHeight);
+}
+
+static void ring_webview_stop_geometry(RingWebView *pRingWebView)
+{
+	if (pRingWebView->nResizeSource)
+	{
+		g_source_remove(pRingWebView->nResizeSource);
+		pRingWebView->nResizeSource = 0;
+	}
+	if (pRingWebView->pStateSurface && pRingWebView->nLayoutHandler)
+		g_signal_handler_disconnect(pRingWebView->pStateSurface, pRingWebView->nLayoutHandler);
+	pRingWebView->nLayoutHandler = 0;
+}
+
+// The surface only exists once the window is realized, and is replaced if it is realized again.
+static void ring_webview_on_window_realize(GtkWidget *widget, gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	GtkNative *native = gtk_widget_get_native(widget);
+	GdkSurface *surface = native ? gtk_native_get_surface(native) : NULL;
+	if (!surface || surface == pRingWebView->pStateSurface)
+		return;
+	if (pRingWebView->pStateSurface && pRingWebView->nStateHandler)
+		g_signal_handler_disconnect(pRingWebView->pStateSurface, pRingWebView->nStateHandler);
+	if (pRingWebView->pStateSurface && pRingWebView->nLayoutHandler)
+		g_signal_handler_disconnect(pRingWebView->pStateSurface, pRingWebView->nLayoutHandler);
+	pRingWebView->pStateSurface = surface;
+	pRingWebView->nStateHandler =
+		g_signal_connect(surface, "notify::state", G_CALLBACK(ring_webview_on_toplevel_state), pRingWebView);
+	// Connected after GTK's own handler, which allocates the window.
+	pRingWebView->nLayoutHandler =
+		g_signal_connect(surface, "layout", G_CALLBACK(ring_webview_on_layout), pRingWebView);
+}
+
+static void ring_webview_stop_background(RingWebView *pRingWebView)
+{
+	/* Destroying the window hides it, which would start another update; the
+	 * webview may already be gone by then. */
+	GtkWindow *window =
+		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (window)
+		g_signal_handlers_disconnect_by_data(window, pRingWebView);
+	if (pRingWebView->nVisibilitySource)
+	{
+		g_source_remove(pRingWebView->nVisibilitySource);
+		pRingWebView->nVisibilitySource = 0;
+	}
+	if (pRingWebView->nThrottleSource)
+	{
+		g_source_remove(pRingWebView->nThrottleSource);
+		pRingWebView->nThrottleSource = 0;
+	}
+	ring_webview_stop_geometry(pRingWebView);
+	if (pRingWebView->pStateSurface && pRingWebView->nStateHandler)
+	{
+		g_signal_handler_disconnect(pRingWebView->pStateSurface, pRingWebView->nStateHandler);
+		pRingWebView->pStateSurface = NULL;
+		pRingWebView->nStateHandler = 0;
+	}
+
+	ring_webview_mutex_lock(&pRingWebView->oHeldMutex);
+	RingWebViewDispatch *pDispatch = pRingWebView->pHeld;
+	pRingWebView->pHeld = NULL;
+	pRingWebView->nBackgroundPolicy = RING_WEBVIEW_BACKGROUND_NONE;
+	ring_webview_mutex_unlock(&pRingWebView->oHeldMutex);
+	while (pDispatch)
+	{
+		RingWebViewDispatch *pNext = pDispatch->pNext;
+		ring_state_free(pDispatch->pRingState, pDispatch->cCode);
+		ring_state_free(pDispatch->pRingState, pDispatch);
+		pDispatch = pNext;
+	}
+}
+
+static void ring_webview_on_load_changed(WebKitWebView *web_view, WebKitLoadEvent load_event, gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	if (!pRingWebView)
+		return;
+
+	double nTrace = ring_webview_trace_begin();
+	RingWebViewSnapshotBatch *pBatch = pRingWebView->pSnapshotBatch;
+	if (load_event == WEBKIT_LOAD_FINISHED && pBatch && pBatch->nLoading)
+	{
+		double nIndex = pBatch->nLoading;
+		pBatch->nLoading = 0;
+		if (!ring_webview_snapshot_begin(pRingWebView, pBatch->nRegion, pBatch->nFormat, pBatch->cCallback,
+										 nIndex, 1))
+			ring_webview_snapshot_batch_failed(pRingWebView, nIndex);
+	}
+
+	// A new page starts in the foreground; tell it otherwise.
+	if (load_event == WEBKIT_LOAD_COMMITTED && ring_webview_is_holding(pRingWebView))
+		ring_webview_background_apply_page(pRingWebView);
+
+	if (load_event == WEBKIT_LOAD_FINISHED && pRingWebView->cOnLoad)
+	{
+		ring_webview_call_event(pRingWebView, pRingWebView->cOnLoad, "finished");
+	}
+	else if (load_event == WEBKIT_LOAD_STARTED && pRingWebView->cOnLoad)
+	{
+		ring_webview_call_event(pRingWebView, pRingWebView->cOnLoad, "started");
+	}
+
+	if (load_event == WEBKIT_LOAD_FINISHED && pRingWebView->cOnDomReady)
+	{
+		ring_webview_call_event(pRingWebView, pRingWebView->cOnDomReady, NULL);
+	}
+	ring_webview_trace_end("gtk", "load-changed", nTrace);
+}
+
+static void ring_webview_on_title_changed(GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	if (!pRingWebView || !pRingWebView->cOnTitle)
+		return;
+
+	WebKitWebView *web_view = WEBKIT_WEB_VIEW(object);
+	const char *title = webkit_web_view_get_title(web_view);
+	if (title)
+	{
+		double nTrace = ring_webview_trace_begin();
+		ring_webview_call_event(pRingWebView, pRingWebView->cOnTitle, title);
+		ring_webview_trace_end("gtk", "notify::title", nTrace);
+	}
+}
+
+static void ring_webview_on_uri_changed(GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	if (!pRingWebView || !pRingWebView->cOnNavigate)
+		return;
+
+	WebKitWebView *web_view = WEBKIT_WEB_VIEW(object);
+	const char *uri = webkit_web_view_get_uri(web_view);
+	if (uri)
+	{
+		double nTrace = ring_webview_trace_begin();
+		ring_webview_call_event(pRingWebView, pRingWebView->cOnNavigate, uri);
+		ring_webview_trace_end("gtk", "notify::uri", nTrace);
+	}
+}
+
+static gboolean ring_webview_on_close_request(GtkWindow *window, gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	if (pRingWebView && pRingWebView->cOnClose)
+	{
+		double nTrace = ring_webview_trace_begin();
+		ring_webview_call_event(pRingWebView, pRingWebView->cOnClose, NULL);
+		ring_webview_trace_end("gtk", "close-request", nTrace);
+	}
+	if (pRingWebView)
+		pRingWebView->bStopped = 1;
+	/* webview only ends the loop for windows it created. A pooled window
+	 * does the same itself and is hidden instead of destroyed, since the
+	 * webview still sits in it until destroy(). */
+	if (pRingWebView && pRingWebView->webview && pRingWebView->pOwnedWindow && !pRingWebView->bHeadless)
+	{
+		gtk_widget_set_visible(GTK_WIDGET(window), FALSE);
+		webview_terminate(pRingWebView->webview);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static void ring_webview_on_focus_changed(GtkWindow *window, GParamSpec *pspec, gpointer user_data)
+{
+	RingWebView *pRingWebView = (RingWebView *)user_data;
+	// Minimizing also takes the focus away, so check for it here too.
+	ring_webview_update_visibility(pRingWebView);
+	if (!pRingWebView || !pRingWebView->cOnFocus)
+		return;
+
+	gboolean focused = gtk_window_is_active(window);
+	double nTrace = ring_webview_trace_begin();
+	ring_webview_call_event(pRingWebView, pRingWebView->cOnFocus, focused ? "true" : "false");
+	ring_webview_trace_end("gtk", "notify::is-active", nTrace);
+}
+
+static void ring_webview_setup_event_handlers(RingWebView *pRingWebView)
+{
+	if (!pRingWebView || !pRingWebView->webview)
+		return;
+
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	GtkWindow *window =
+		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+
+	if (web_view)
+	{
+		g_signal_connect(web_view, "load-changed", G_CALLBACK(ring_webview_on_load_changed), pRingWebView);
+		g_signal_connect(web_view, "notify::title", G_CALLBACK(ring_webview_on_title_changed), pRingWebView);
+		g_signal_connect(web_view, "notify::uri", G_CALLBACK(ring_webview_on_uri_changed), pRingWebView);
+	}
+
+	if (window)
+	{
+		g_signal_connect(window, "close-request", G_CALLBACK(ring_webview_on_close_request), pRingWebView);
+		g_signal_connect(window, "notify::is-active", G_CALLBACK(ring_webview_on_focus_changed), pRingWebView);
+		g_signal_connect(window, "notify::visible", G_CALLBACK(ring_webview_on_window_visible), pRingWebView);
+		g_signal_connect(window, "realize", G_CALLBACK(ring_webview_on_window_realize), pRingWebView);
+		if (gtk_widget_get_realized(GTK_WIDGET(window)))
+			ring_webview_on_window_realize(GTK_WIDGET(window), pRingWebView);
+	}
+}
+#endif
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+static gboolean ring_webview_suppress_context_menu(WebKitWebView *web_view, WebKitContextMenu *context_menu,
+												   GdkEvent *event, WebKitHitTestResult *hit_test_result,
+												   gpointer user_data)
+{
+	(void)web_view;
+	(void)context_menu;
+	(void)event;
+	(void)hit_test_result;
+	(void)user_data;
+	return TRUE;
+}
+#endif
+
+/* ============================================================================
+ * Timers
+ * ============================================================================ */
+
+/* Timers run on the UI loop and call their Ring function directly. Each tick
+ * is armed as a one-shot for the next slot of the ideal schedule (start +
+ * n * interval), so lateness doesn't add up; ticks that are missed entirely
+ * are skipped and counted instead of fired back to back. */
+
+typedef struct RingWebViewTimer
+{
+	RingWebView *pRingWebView;
+	RingState *pRingState;
+	double nId;
+	char *cFunc;
+	double nIntervalMs;
+	int bRepeat;
+	// Armed on the UI loop; the GLib source id on Linux/FreeBSD.
+	unsigned int nSource;
+#ifdef WEBVIEW_PLATFORM_MACOS
+	// The CFRunLoopTimer behind nSource.
+	void *pMacTimer;
+#endif
+	// Cleared while its function runs; freed once that returns.
+	int bFiring;
+	int bCancelled;
+	double nDueMs;
+	double nFires;
+	double nSkipped;
+	double nLateTotalMs;
+	double nLateMaxMs;
+	struct RingWebViewTimer *pNext;
+} RingWebViewTimer;
+
+static void ring_webview_push_timer_args(RingWebViewEventArgs *pOut, void *pArgs)
+{
+	ring_webview_event_number(pOut, *(double *)pArgs);
+}
+
+static void ring_webview_timer_fire(RingWebViewTimer *pTimer);
+
+#if defined(WEBVIEW_PLATFORM_UNIX)
+static gboolean ring_webview_on_timer(gpointer user_data)
+{
+	RingWebViewTimer *pTimer = (RingWebViewTimer *)user_data;
+	pTimer->nSource = 0;
+	ring_webview_timer_fire(pTimer);
+	return G_SOURCE_REMOVE;
+}
+#elif defined(WEBVIEW_PLATFORM_WINDOWS)
+// The timer pointer is the timer id, so no lookup is needed.
+static VOID CALLBACK ring_webview_on_timer(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime)
+{
+	(void)uMsg;
+	(void)dwTime;
+	RingWebViewTimer *pTimer = (RingWebViewTimer *)idEvent;
+	// Windows timers repeat; each tick is armed on its own.
+	KillTimer(hwnd, idEvent);
+	pTimer->nSource = 0;
+	ring_webview_timer_fire(pTimer);
+}
+#elif defined(WEBVIEW_PLATFORM_MACOS)
+static void ring_webview_on_timer(void *pData)
+{
+	RingWebViewTimer *pTimer = (RingWebViewTimer *)pData;
+	// One-shot; released before the next tick is armed.
+	ring_webview_macos_timer_stop(pTimer->pMacTimer);
+	pTimer->pMacTimer = NULL;
+	pTimer->nSource = 0;
+	ring_webview_timer_fire(pTimer);
+}
+#endif
+
+// Returns 0 when the timer could not be armed, or on platforms without timers.
+static int ring_webview_timer_arm(RingWebViewTimer *pTimer, double nDelayMs)
+{
+	// Rounded up, so a tick never fires before its slot.
+	unsigned int nDelay = nDelayMs > 0 ? (unsigned int)nDelayMs : 0;
+	if (nDelay < nDelayMs)
+		nDelay++;
+#if defined(WEBVIEW_PLATFORM_UNIX)
+	pTimer->nSource = g_timeout_add_full(G_PRIORITY_DEFAULT, nDelay, ring_webview_on_timer, pTimer, NULL);
+#elif defined(WEBVIEW_PLATFORM_WINDOWS)
+	HWND hwnd = ring_webview_get_hwnd(pTimer->pRingWebView);
+	if (!hwnd)
+		return 0;
+	pTimer->nSource = SetTimer(hwnd, (UINT_PTR)pTimer, nDelay, ring_webview_on_timer) ? 1 : 0;
+#elif defined(WEBVIEW_PLATFORM_MACOS)
+	pTimer->pMacTimer = ring_webview_macos_timer_start(nDelay, ring_webview_on_timer, pTimer);
+	pTimer->nSource = pTimer->pMacTimer ? 1 : 0;
+#else
+	(void)nDelay;
+	pTimer->nSource = 0;
+#endif
+	return pTimer->nSource != 0;
+}
+
+static void ring_webview_timer_disarm(RingWebViewTimer *pTimer)
+{
+	if (!pTimer->nSource)
+		return;
+#if defined(WEBVIEW_PLATFORM_UNIX)
+	g_source_remove(pTimer->nSource);
+#elif defined(WEBVIEW_PLATFORM_WINDOWS)
+	HWND hwnd = ring_webview_get_hwnd(pTimer->pRingWebView);
+	if (hwnd)
+		KillTimer(hwnd, (UINT_PTR)pTimer);
+#elif defined(WEBVIEW_PLATFORM_MACOS)
+	ring_webview_macos_timer_stop(pTimer->pMacTimer);
+	pTimer->pMacTimer = NULL;
+#endif
+	pTimer->nSource = 0;
+}
+
+static void ring_webview_timer_free(RingWebViewTimer *pTimer)
+{
+	ring_state_free(pTimer->pRingState, pTimer->cFunc);
+	ring_state_free(pTimer->pRingState, pTimer);
+}
+
+static void ring_webview_timer_unlink(RingWebViewTimer *pTimer)
+{
+	RingWebViewTimer **ppLink = &pTimer->pRingWebView->pTimers;
+	while (*ppLink && *ppLink != pTimer)
+		ppLink = &(*ppLink)->pNext;
+	if (*ppLink)
+		*ppLink = pTimer->pNext;
+	pTimer->pNext = NULL;
+}
+
+// Stops a timer; one whose function is running is freed when it returns.
+static void ring_webview_timer_cancel(RingWebViewTimer *pTimer)
+{
+	ring_webview_timer_disarm(pTimer);
+	ring_webview_timer_unlink(pTimer);
+	if (pTimer->bFiring)
+		pTimer->bCancelled = 1;
+	else
+		ring_webview_timer_free(pTimer);
+}
+
+static void ring_webview_timer_fire(RingWebViewTimer *pTimer)
+{
+	// A handler is suspended in webview_yield(); fire after it returns, so a cleared timer never runs.
+	if (bRingWebViewYielding)
+	{
+		if (!ring_webview_timer_arm(pTimer, RING_WEBVIEW_TIMER_RETRY_MS))
+		{
+			ring_webview_timer_unlink(pTimer);
+			ring_webview_timer_free(pTimer);
+		}
+		return;
+	}
+
+	double nNow = ring_webview_now_ms();
+	double nLate = nNow > pTimer->nDueMs ? nNow - pTimer->nDueMs : 0;
+	pTimer->nFires++;
+	pTimer->nLateTotalMs += nLate;
+	if (nLate > pTimer->nLateMaxMs)
+		pTimer->nLateMaxMs = nLate;
+
+	double nId = pTimer->nId;
+	pTimer->bFiring = 1;
+	ring_webview_call_event_with(pTimer->pRingWebView, pTimer->cFunc, NULL, 0, ring_webview_push_timer_args, &nId);
+	pTimer->bFiring = 0;
+
+	// Cancelled by its own function, or its webview was destroyed meanwhile.
+	if (pTimer->bCancelled)
+	{
+		ring_webview_timer_free(pTimer);
+		return;
+	}
+	if (!pTimer->bRepeat)
+	{
+		ring_webview_timer_unlink(pTimer);
+		ring_webview_timer_free(pTimer);
+		return;
+	}
+
+	nNow = ring_webview_now_ms();
+	pTimer->nDueMs += pTimer->nIntervalMs;
+	while (pTimer->nDueMs <= nNow)
+	{
+		pTimer->nDueMs += pTimer->nIntervalMs;
+		pTimer->nSkipped++;
+	}
+	if (!ring_webview_timer_arm(pTimer, pTimer->nDueMs - nNow))
+	{
+		ring_webview_timer_unlink(pTimer);
+		ring_webview_timer_free(pTimer);
+	}
+}
+
+// Returns the new timer's id, or 0 if it could not be started.
+static double ring_webview_timer_start(RingWebView *pRingWebView, double nMs, const char *cFunc, int bRepeat)
+{
+	RingWebViewTimer *pTimer =
+		(RingWebViewTimer *)ring_state_malloc(pRingWebView->pMainRingState, sizeof(RingWebViewTimer));
+	if (!pTimer)
+		return 0;
+	memset(pTimer, 0, sizeof(RingWebViewTimer));
+	pTimer->pRingWebView = pRingWebView;
+	pTimer->pRingState = pRingWebView->pMainRingState;
+	pTimer->cFunc = ring_webview_string_strdup(pRingWebView->pMainRingState, cFunc);
+	pTimer->nIntervalMs = nMs;
+	pTimer->bRepeat = bRepeat;
+	pTimer->nDueMs = ring_webview_now_ms() + nMs;
+	if (!pTimer->cFunc || !ring_webview_timer_arm(pTimer, nMs))
+	{
+		if (pTimer->cFunc)
+			ring_state_free(pTimer->pRingState, pTimer->cFunc);
+		ring_state_free(pTimer->pRingState, pTimer);
+		return 0;
+	}
+	pTimer->nId = ++pRingWebView->nTimerId;
+	pTimer->pNext = pRingWebView->pTimers;
+	pRingWebView->pTimers = pTimer;
+	return pTimer->nId;
+}
+
+static void ring_webview_clear_timers(RingWebView *pRingWebView)
+{
+	while (pRingWebView->pTimers)
+		ring_webview_timer_cancel(pRingWebView->pTimers);
+	pRingWebView->pTimers = NULL;
+}
+
+/* ============================================================================
+ * Worker Pool
+ * ============================================================================ */
+
+/* A fixed set of native threads, each with its own Ring state loaded from a
+ * worker file, runs jobs queued by webview_spawn(). Arguments and results
+ * cross between states as JSON, and the result is handed to the done
+ * function on the UI loop with webview_dispatch(). Jobs live in malloc'd
+ * memory because worker threads create and free them too. Window VMs (see
+ * below) run their calls and messages as jobs as well. */
+
+#define RING_WEBVIEW_WORKERS_MAX 32
+#define RING_WEBVIEW_WORKER_ARGS "__ring_webview_worker_args"
+#define RING_WEBVIEW_WORKER_RESULT "__ring_webview_worker_result"
+#define RING_WEBVIEW_WORKER_ERROR "__ring_webview_worker_error"
+
+// What a finished job does on the UI loop.
+#define RING_WEBVIEW_JOB_SPAWN 0
+#define RING_WEBVIEW_JOB_CALL 1
+#define RING_WEBVIEW_JOB_MESSAGE 2
+#define RING_WEBVIEW_JOB_EVAL 3
+// A message that raised an error in a window's own Ring state, for its onPostError callback.
+#define RING_WEBVIEW_JOB_POST_ERROR 4
+
+typedef struct RingWebViewJob
+{
+	int nKind;
+	double nId;
+	RingWebView *pRingWebView; // NULL once the webview is destroyed
+	// Id of the JavaScript call a RING_WEBVIEW_JOB_CALL answers.
+	char *cCallId;
+	char *cFunc;
+	char *cArgs;
+	char *cDone;
+	char *cResult;
+	char *cError;
+	struct RingWebViewJob *pNext;
+} RingWebViewJob;
+
+typedef struct RingWebViewWorker
+{
+	RingWebViewThread oThread;
+	RingState *pRingState;
+	RingWebViewJob *pJob;
+	double nJobStartMs;
+} RingWebViewWorker;
+
+typedef struct RingWebViewWorkerPool
+{
+	// Created once and kept, since done callbacks may still be queued after a stop.
+	int bMutexReady;
+	RingWebViewMutex oMutex;
+	RingWebViewCond oWake;
+	int nThreads;
+	int bStopping;
+	char *cFile;
+	RingWebViewWorker aWorkers[RING_WEBVIEW_WORKERS_MAX];
+	RingWebViewJob *pQueueHead;
+	RingWebViewJob *pQueueTail;
+	// Finished jobs whose done function hasn't run yet.
+	RingWebViewJob *pDelivered;
+	unsigned int nQueued;
+	unsigned int nMaxQueued;
+	unsigned int nRunning;
+	double nNextId;
+	double nCompleted;
+	double nFailed;
+	double nStartMs;
+	double nBusyMs;
+	// All webviews, for webview_post(); guarded by oMutex like the jobs.
+	RingWebView *pWindows;
+	double nNextWindowId;
+} RingWebViewWorkerPool;
+
+static RingWebViewWorkerPool oRingWebViewWorkers;
+
+typedef struct RingWebViewIsolate
+{
+	RingWebViewThread oThread;
+	RingState *pRingState;
+	double nWindowId;
+	char *cFile;
+	// Guards the queue; oRingWebViewWorkers.oMutex is taken first when both are needed.
+	RingWebViewMutex oMutex;
+	RingWebViewCond oWake;
+	int bStopping;
+	// Set under oRingWebViewWorkers.oMutex once the window is being destroyed.
+	int bDetached;
+	RingWebViewJob *pQueueHead;
+	RingWebViewJob *pQueueTail;
+	RingWebViewJob *pJob;
+	unsigned int nQueued;
+	double nCalls;
+	double nMessages;
+	double nFailed;
+	// Failed messages, which have no caller to report to; also counted in nFailed.
+	double nMessagesFailed;
+	double nBusyMs;
+} RingWebViewIsolate;
+
+static void ring_webview_workers_init_sync(void)
+{
+	if (oRingWebViewWorkers.bMutexReady)
+		return;
+	ring_webview_mutex_init(&oRingWebViewWorkers.oMutex);
+	ring_webview_cond_init(&oRingWebViewWorkers.oWake);
+	oRingWebViewWorkers.bMutexReady = 1;
+}
+
+static char *ring_webview_worker_strdup(const char *cText)
+{
+	size_t nLen = strlen(cText);
+	char *cCopy = (char *)malloc(nLen + 1);
+	if (cCopy)
+		memcpy(cCopy, cText, nLen + 1);
+	return cCopy;
+}
+
+static void ring_webview_job_free(RingWebViewJob *pJob)
+{
+	free(pJob->cCallId);
+	free(pJob->cFunc);
+	free(pJob->cArgs);
+	free(pJob->cDone);
+	free(pJob->cResult);
+	free(pJob->cError);
+	free(pJob);
+}
+
+// Only names go into the code a worker compiles, so nothing else can be injected.
+static int ring_webview_is_func_name(const char *cName)
+{
+	if (!cName[0] || (cName[0] >= '0' && cName[0] <= '9'))
+		return 0;
+	for (const char *p = cName; *p; p++)
+	{
+		if (!((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') || *p == '_'))
+			return 0;
+	}
+	return strlen(cName) < RING_WEBVIEW_MAX_ROUTE_NAME;
+}
+
+// The worker running this Ring state; the caller holds oRingWebViewWorkers.oMutex.
+static RingWebViewWorker *ring_webview_worker_for_state(RingState *pRingState)
+{
+	for (int i = 0; i < oRingWebViewWorkers.nThreads; i++)
+	{
+		if (oRingWebViewWorkers.aWorkers[i].pRingState == pRingState)
+			return &oRingWebViewWorkers.aWorkers[i];
+	}
+	return NULL;
+}
+
+// The window whose own Ring state this is; the caller holds oRingWebViewWorkers.oMutex.
+static RingWebView *ring_webview_window_for_state(RingState *pRingState)
+{
+	for (RingWebView *pWindow = oRingWebViewWorkers.pWindows; pWindow; pWindow = pWindow->pNextWindow)
+	{
+		if (pWindow->pIsolate && pWindow->pIsolate->pRingState == pRingState)
+			return pWindow;
+	}
+	return NULL;
+}
+
+// The job running in a worker's or a window's own Ring state, asked from that state's thread.
+static RingWebViewJob *ring_webview_job_for_state(RingState *pRingState)
+{
+	RingWebViewJob *pJob = NULL;
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	RingWebViewWorker *pWorker = ring_webview_worker_for_state(pRingState);
+	if (pWorker)
+	{
+		pJob = pWorker->pJob;
+	}
+	else
+	{
+		RingWebView *pWindow = ring_webview_window_for_state(pRingState);
+		pJob = pWindow ? pWindow->pIsolate->pJob : NULL;
+	}
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	return pJob;
+}
+
+// Registered in worker states only: returns the running job's arguments.
+RING_FUNC(ring_webview_worker_args)
+{
+	RingWebViewJob *pJob = ring_webview_job_for_state(RING_API_STATE);
+	List *pList = NULL;
+	if (pJob)
+		pList = json_decode_to_ring_list((VM *)pPointer, pJob->cArgs);
+	if (!pList)
+		pList = RING_API_NEWLIST;
+	RING_API_RETLIST(pList);
+}
+
+// Registered in worker states only: keeps the worker function's return value.
+RING_FUNC(ring_webview_worker_result)
+{
+	RingWebViewJob *pJob = ring_webview_job_for_state(RING_API_STATE);
+	if (!pJob || RING_API_PARACOUNT != 1)
+		return;
+	List *pList;
+	if (RING_API_ISLIST(1))
+	{
+		pList = RING_API_GETLIST(1);
+	}
+	else if (pJob->nKind == RING_WEBVIEW_JOB_CALL)
+	{
+		// JavaScript gets a single value as it is.
+		if (RING_API_ISNUMBER(1))
+			pJob->cResult = ring_number_to_json_string(RING_API_GETNUMBER(1));
+		else if (RING_API_ISSTRING(1))
+			pJob->cResult = ring_string_to_json_string(RING_API_GETSTRING(1));
+		else
+			pJob->cResult = ring_webview_worker_strdup("null");
+		if (!pJob->cResult)
+			pJob->cError = ring_webview_worker_strdup("Could not encode the result as JSON");
+		return;
+	}
+	else
+	{
+		// A single value comes back as a one item list.
+		pList = RING_API_NEWLIST;
+		if (RING_API_ISSTRING(1))
+			ring_list_addstring_gc(RING_API_STATE, pList, RING_API_GETSTRING(1));
+		else if (RING_API_ISNUMBER(1))
+			ring_list_adddouble_gc(RING_API_STATE, pList, RING_API_GETNUMBER(1));
+	}
+	pJob->cResult = ring_list_to_json_string(RING_API_STATE, pList);
+	if (!pJob->cResult)
+		pJob->cError = ring_webview_worker_strdup("Could not encode the result as JSON");
+}
+
+// Registered in worker states only: keeps the error the worker function raised.
+RING_FUNC(ring_webview_worker_error)
+{
+	RingWebViewJob *pJob = ring_webview_job_for_state(RING_API_STATE);
+	if (!pJob || RING_API_PARACOUNT != 1 || !RING_API_ISSTRING(1))
+		return;
+	free(pJob->cError);
+	pJob->cError = ring_webview_worker_strdup(RING_API_GETSTRING(1));
+}
+
+RING_FUNC(ring_webview_post);
+
+static void ring_webview_worker_register(RingState *pRingState)
+{
+	RING_API_REGISTER(RING_WEBVIEW_WORKER_ARGS, ring_webview_worker_args);
+	RING_API_REGISTER(RING_WEBVIEW_WORKER_RESULT, ring_webview_worker_result);
+	RING_API_REGISTER(RING_WEBVIEW_WORKER_ERROR, ring_webview_worker_error);
+	RING_API_REGISTER("webview_post", ring_webview_post);
+}
+
+static void ring_webview_push_job_args(RingWebViewEventArgs *pOut, void *pArgs)
+{
+	RingWebViewJob *pJob = (RingWebViewJob *)pArgs;
+	ring_webview_event_number(pOut, pJob->nId);
+	ring_webview_event_json(pOut, pJob->cResult);
+	const char *cError = pJob->cError ? pJob->cError : "";
+	ring_webview_event_string(pOut, cError, strlen(cError));
+}
+
+static void ring_webview_push_message_args(RingWebViewEventArgs *pOut, void *pArgs)
+{
+	RingWebViewJob *pJob = (RingWebViewJob *)pArgs;
+	ring_webview_event_json(pOut, pJob->cArgs);
+}
+
+static void ring_webview_push_post_error_args(RingWebViewEventArgs *pOut, void *pArgs)
+{
+	RingWebViewJob *pJob = (RingWebViewJob *)pArgs;
+	ring_webview_event_string(pOut, pJob->cFunc, strlen(pJob->cFunc));
+	ring_webview_event_string(pOut, pJob->cError, strlen(pJob->cError));
+}
+
+// Answers the JavaScript call a window's own Ring state has handled.
+static void ring_webview_return_job(RingWebView *pRingWebView, RingWebViewJob *pJob)
+{
+	if (ring_webview_drop_late_return(pRingWebView, pJob->cCallId))
+		return;
+	int nStatus = pJob->cError ? 1 : 0;
+	char *cErrorJson = pJob->cError ? ring_string_to_json_string(pJob->cError) : NULL;
+	const char *cJson = pJob->cError ? (cErrorJson ? cErrorJson : "null") : pJob->cResult;
+	webview_return(pRingWebView->webview, pJob->cCallId, nStatus, cJson);
+	ring_webview_record(RING_WEBVIEW_RECORD_RETURN, pJob->cCallId, NULL, cJson, nStatus);
+	ring_webview_finish_call(pRingWebView, pJob->cCallId, nStatus, cJson);
+	free(cErrorJson);
+}
+
+// Runs on the UI loop once a worker or a window's own Ring state has finished a job.
+static void ring_webview_on_job_done(webview_t w, void *arg)
+{
+	(void)w;
+	RingWebViewJob *pJob = (RingWebViewJob *)arg;
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	RingWebViewJob **ppLink = &oRingWebViewWorkers.pDelivered;
+	while (*ppLink && *ppLink != pJob)
+		ppLink = &(*ppLink)->pNext;
+	if (*ppLink)
+		*ppLink = pJob->pNext;
+	RingWebView *pRingWebView = pJob->pRingWebView;
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+
+	if (pRingWebView && pRingWebView->webview)
+	{
+		switch (pJob->nKind)
+		{
+		case RING_WEBVIEW_JOB_SPAWN:
+			ring_webview_call_event_with(pRingWebView, pJob->cDone, pJob->cResult,
+										 pJob->cResult ? strlen(pJob->cResult) : 0, ring_webview_push_job_args, pJob);
+			break;
+		case RING_WEBVIEW_JOB_CALL:
+			ring_webview_return_job(pRingWebView, pJob);
+			break;
+		case RING_WEBVIEW_JOB_MESSAGE:
+			ring_webview_call_event_with(pRingWebView, pJob->cFunc, pJob->cArgs, strlen(pJob->cArgs),
+										 ring_webview_push_message_args, pJob);
+			break;
+		case RING_WEBVIEW_JOB_EVAL:
+			webview_eval(pRingWebView->webview, pJob->cArgs);
+			break;
+		case RING_WEBVIEW_JOB_POST_ERROR:
+			ring_webview_call_event_with(pRingWebView, pRingWebView->cOnPostError, pJob->cError,
+										 strlen(pJob->cError), ring_webview_push_post_error_args, pJob);
+			break;
+		}
+	}
+	ring_webview_job_free(pJob);
+}
+
+/* Hands a job to the UI loop for its webview; the caller holds
+ * oRingWebViewWorkers.oMutex, which keeps the webview from being destroyed
+ * meanwhile. Frees the job if that webview is gone. */
+static void ring_webview_deliver_job(RingWebViewJob *pJob)
+{
+	if (pJob->pRingWebView && pJob->pRingWebView->webview &&
+		webview_dispatch(pJob->pRingWebView->webview, ring_webview_on_job_done, pJob) == WEBVIEW_ERROR_OK)
+	{
+		pJob->pNext = oRingWebViewWorkers.pDelivered;
+		oRingWebViewWorkers.pDelivered = pJob;
+	}
+	else
+	{
+		ring_webview_job_free(pJob);
+	}
+}
+
+static void ring_webview_worker_run_job(RingState *pRingState, RingWebViewJob *pJob)
+{
+	if (!pRingState)
+	{
+		pJob->cError = ring_webview_worker_strdup("Could not create a Ring state for the worker");
+		return;
+	}
+	char cCode[RING_WEBVIEW_MAX_ROUTE_NAME + 256];
+	snprintf(cCode, sizeof(cCode), "try\n\t%s(%s(%s()))\ncatch\n\t%s(cCatchError)\ndone\n", RING_WEBVIEW_WORKER_RESULT,
+			 pJob->cFunc, RING_WEBVIEW_WORKER_ARGS, RING_WEBVIEW_WORKER_ERROR);
+	ring_state_runcode(pRingState, cCode);
+	if (!pJob->cResult && !pJob->cError)
+		pJob->cError = ring_webview_worker_strdup("The worker function did not return");
+}
+
+static void ring_webview_worker_main(void *pArg)
+{
+	RingWebViewWorker *pWorker = (RingWebViewWorker *)pArg;
+	RingState *pRingState = ring_state_init();
+	if (pRingState)
+	{
+		ring_webview_worker_register(pRingState);
+		ring_state_runfile(pRingState, oRingWebViewWorkers.cFile);
+	}
+
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	// Read under the mutex by ring_webview_job_for_state().
+	pWorker->pRingState = pRingState;
+	for (;;)
+	{
+		while (!oRingWebViewWorkers.bStopping && !oRingWebViewWorkers.pQueueHead)
+			ring_webview_cond_wait(&oRingWebViewWorkers.oWake, &oRingWebViewWorkers.oMutex);
+		if (oRingWebViewWorkers.bStopping)
+			break;
+
+		RingWebViewJob *pJob = oRingWebViewWorkers.pQueueHead;
+		oRingWebViewWorkers.pQueueHead = pJob->pNext;
+		if (!oRingWebViewWorkers.pQueueHead)
+			oRingWebViewWorkers.pQueueTail = NULL;
+		pJob->pNext = NULL;
+		oRingWebViewWorkers.nQueued--;
+		oRingWebViewWorkers.nRunning++;
+		pWorker->pJob = pJob;
+		pWorker->nJobStartMs = ring_webview_now_ms();
+		ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+
+		ring_webview_worker_run_job(pWorker->pRingState, pJob);
+
+		ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+		oRingWebViewWorkers.nBusyMs += ring_webview_now_ms() - pWorker->nJobStartMs;
+		oRingWebViewWorkers.nRunning--;
+		pWorker->pJob = NULL;
+		if (pJob->cError)
+			oRingWebViewWorkers.nFailed++;
+		else
+			oRingWebViewWorkers.nCompleted++;
+		ring_webview_deliver_job(pJob);
+	}
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+
+	if (pRingState)
+		ring_state_delete(pRingState);
+}
+
+static void ring_webview_workers_shutdown(void)
+{
+	if (!oRingWebViewWorkers.nThreads)
+		return;
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	oRingWebViewWorkers.bStopping = 1;
+	ring_webview_cond_broadcast(&oRingWebViewWorkers.oWake);
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	for (int i = 0; i < oRingWebViewWorkers.nThreads; i++)
+		ring_webview_thread_join(oRingWebViewWorkers.aWorkers[i].oThread);
+
+	// Jobs that never started are dropped without calling their done function.
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	while (oRingWebViewWorkers.pQueueHead)
+	{
+		RingWebViewJob *pJob = oRingWebViewWorkers.pQueueHead;
+		oRingWebViewWorkers.pQueueHead = pJob->pNext;
+		ring_webview_job_free(pJob);
+	}
+	oRingWebViewWorkers.pQueueTail = NULL;
+	oRingWebViewWorkers.nQueued = 0;
+	oRingWebViewWorkers.nThreads = 0;
+	oRingWebViewWorkers.bStopping = 0;
+	free(oRingWebViewWorkers.cFile);
+	oRingWebViewWorkers.cFile = NULL;
+	memset(oRingWebViewWorkers.aWorkers, 0, sizeof(oRingWebViewWorkers.aWorkers));
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+}
+
+// Takes the webview off the window list and cuts its jobs loose, before it is destroyed.
+static void ring_webview_detach_jobs(RingWebView *pRingWebView)
+{
+	if (!oRingWebViewWorkers.bMutexReady)
+		return;
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	RingWebView **ppWindow = &oRingWebViewWorkers.pWindows;
+	while (*ppWindow && *ppWindow != pRingWebView)
+		ppWindow = &(*ppWindow)->pNextWindow;
+	if (*ppWindow)
+		*ppWindow = pRingWebView->pNextWindow;
+	pRingWebView->pNextWindow = NULL;
+	if (pRingWebView->pIsolate)
+		pRingWebView->pIsolate->bDetached = 1;
+
+	RingWebViewJob **ppLink = &oRingWebViewWorkers.pQueueHead;
+	oRingWebViewWorkers.pQueueTail = NULL;
+	while (*ppLink)
+	{
+		RingWebViewJob *pJob = *ppLink;
+		if (pJob->pRingWebView == pRingWebView)
+		{
+			*ppLink = pJob->pNext;
+			oRingWebViewWorkers.nQueued--;
+			ring_webview_job_free(pJob);
+			continue;
+		}
+		oRingWebViewWorkers.pQueueTail = pJob;
+		ppLink = &pJob->pNext;
+	}
+	for (int i = 0; i < oRingWebViewWorkers.nThreads; i++)
+	{
+		RingWebViewJob *pJob = oRingWebViewWorkers.aWorkers[i].pJob;
+		if (pJob && pJob->pRingWebView == pRingWebView)
+			pJob->pRingWebView = NULL;
+	}
+	for (RingWebViewJob *pJob = oRingWebViewWorkers.pDelivered; pJob; pJob = pJob->pNext)
+	{
+		if (pJob->pRingWebView == pRingWebView)
+			pJob->pRingWebView = NULL;
+	}
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+}
+
+/* ============================================================================
+ * Window VMs
+ * ============================================================================ */
+
+/* webview_set_isolated() gives a window its own Ring state, loaded from a
+ * handler file, and a thread that runs its bound functions in order. Busy
+ * windows then no longer take turns on the main VM. Results, page updates
+ * and messages for windows on the main VM go back to the UI loop as jobs.
+ * webview_post() passes messages between windows by id. */
+
+static void ring_webview_register_window(RingWebView *pRingWebView)
+{
+	ring_webview_workers_init_sync();
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	pRingWebView->nWindowId = ++oRingWebViewWorkers.nNextWindowId;
+	pRingWebView->pNextWindow = oRingWebViewWorkers.pWindows;
+	oRingWebViewWorkers.pWindows = pRingWebView;
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+}
+
+#ifndef WEBVIEW_PLATFORM_UNIX
+/* Any open window, for scheduler drains whose own webview is gone. Called
+ * with the scheduler mutex held, which is always taken before this one. */
+static webview_t ring_webview_any_window(void)
+{
+	if (!oRingWebViewWorkers.bMutexReady)
+		return NULL;
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	webview_t pWebView = oRingWebViewWorkers.pWindows ? oRingWebViewWorkers.pWindows->webview : NULL;
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	return pWebView;
+}
+#endif
+
+static void ring_webview_isolate_enqueue(RingWebViewIsolate *pIsolate, RingWebViewJob *pJob)
+{
+	ring_webview_mutex_lock(&pIsolate->oMutex);
+	if (pIsolate->pQueueTail)
+		pIsolate->pQueueTail->pNext = pJob;
+	else
+		pIsolate->pQueueHead = pJob;
+	pIsolate->pQueueTail = pJob;
+	pIsolate->nQueued++;
+	if (pJob->nKind == RING_WEBVIEW_JOB_CALL)
+		pIsolate->nCalls++;
+	else
+		pIsolate->nMessages++;
+	ring_webview_cond_signal(&pIsolate->oWake);
+	ring_webview_mutex_unlock(&pIsolate->oMutex);
+}
+
+static RingWebViewJob *ring_webview_job_new(int nKind, RingWebView *pRingWebView, const char *cFunc,
+											 const char *cArgs)
+{
+	RingWebViewJob *pJob = (RingWebViewJob *)calloc(1, sizeof(RingWebViewJob));
+	if (!pJob)
+		return NULL;
+	pJob->nKind = nKind;
+	pJob->pRingWebView = pRingWebView;
+	pJob->cFunc = ring_webview_worker_strdup(cFunc);
+	pJob->cArgs = ring_webview_worker_strdup(cArgs);
+	if (!pJob->cFunc || !pJob->cArgs)
+	{
+		ring_webview_job_free(pJob);
+		return NULL;
+	}
+	return pJob;
+}
+
+// Queues a bound call for the window's own Ring state. Returns an error message, or NULL.
+static const char *ring_webview_isolate_call(RingWebView *pRingWebView, const char *cFunc, const char *cId,
+											 const char *cReq)
+{
+	if (!ring_webview_is_func_name(cFunc))
+		return "Windows with their own Ring state can only bind functions by name";
+	RingWebViewJob *pJob = ring_webview_job_new(RING_WEBVIEW_JOB_CALL, pRingWebView, cFunc, cReq);
+	if (pJob)
+		pJob->cCallId = ring_webview_worker_strdup(cId);
+	if (!pJob || !pJob->cCallId)
+	{
+		if (pJob)
+			ring_webview_job_free(pJob);
+		return RING_OOM;
+	}
+	ring_webview_isolate_enqueue(pRingWebView->pIsolate, pJob);
+	return NULL;
+}
+
+// Queues cFunc(aArgs) for a window: on its own state, or on the main VM through the UI loop.
+static int ring_webview_post_message(double nWindowId, const char *cFunc, const char *cArgs)
+{
+	if (!oRingWebViewWorkers.bMutexReady)
+		return 0;
+	int bPosted = 0;
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	RingWebView *pWindow = oRingWebViewWorkers.pWindows;
+	while (pWindow && pWindow->nWindowId != nWindowId)
+		pWindow = pWindow->pNextWindow;
+	if (pWindow && pWindow->webview)
+	{
+		RingWebViewJob *pJob = ring_webview_job_new(RING_WEBVIEW_JOB_MESSAGE, pWindow, cFunc, cArgs);
+		if (pJob)
+		{
+			if (pWindow->pIsolate)
+				ring_webview_isolate_enqueue(pWindow->pIsolate, pJob);
+			else
+				ring_webview_deliver_job(pJob);
+			bPosted = 1;
+		}
+	}
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	return bPosted;
+}
+
+// Available to the main program, workers and windows' own states alike.
+RING_FUNC(ring_webview_post)
+{
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISNUMBER(1) || !RING_API_ISSTRING(2) || !RING_API_ISLIST(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (!ring_webview_is_func_name(RING_API_GETSTRING(2)))
+	{
+		RING_API_ERROR("Invalid function name");
+		return;
+	}
+	char *cArgs = ring_list_to_json_string(RING_API_STATE, RING_API_GETLIST(3));
+	if (!cArgs)
+	{
+		RING_API_ERROR("Could not encode the arguments as JSON");
+		return;
+	}
+	int bPosted = ring_webview_post_message(RING_API_GETNUMBER(1), RING_API_GETSTRING(2), cArgs);
+	free(cArgs);
+	RING_API_RETNUMBER(bPosted);
+}
+
+// Registered in windows' own states only: the id of the window this state belongs to.
+RING_FUNC(ring_webview_self)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+	double nWindowId = 0;
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	RingWebView *pWindow = ring_webview_window_for_state(RING_API_STATE);
+	if (pWindow)
+		nWindowId = pWindow->nWindowId;
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	RING_API_RETNUMBER(nWindowId);
+}
+
+// Registered in windows' own states only: runs JavaScript in the window, on the UI loop.
+RING_FUNC(ring_webview_self_eval)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int bQueued = 0;
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	RingWebView *pWindow = ring_webview_window_for_state(RING_API_STATE);
+	if (pWindow && !pWindow->pIsolate->bDetached)
+	{
+		RingWebViewJob *pJob = ring_webview_job_new(RING_WEBVIEW_JOB_EVAL, pWindow, "", RING_API_GETSTRING(1));
+		if (pJob)
+		{
+			ring_webview_deliver_job(pJob);
+			bQueued = 1;
+		}
+	}
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	RING_API_RETNUMBER(bQueued);
+}
+
+static void ring_webview_isolate_main(void *pArg)
+{
+	RingWebViewIsolate *pIsolate = (RingWebViewIsolate *)pArg;
+	RingState *pRingState = ring_state_init();
+	if (pRingState)
+	{
+		ring_webview_worker_register(pRingState);
+		RING_API_REGISTER("webview_self", ring_webview_self);
+		RING_API_REGISTER("webview_self_eval", ring_webview_self_eval);
+	}
+	// Published before the file runs, so top-level code can already use webview_self().
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	pIsolate->pRingState = pRingState;
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	if (pRingState)
+		ring_state_runfile(pRingState, pIsolate->cFile);
+
+	ring_webview_mutex_lock(&pIsolate->oMutex);
+	for (;;)
+	{
+		while (!pIsolate->bStopping && !pIsolate->pQueueHead)
+			ring_webview_cond_wait(&pIsolate->oWake, &pIsolate->oMutex);
+		if (pIsolate->bStopping)
+			break;
+
+		RingWebViewJob *pJob = pIsolate->pQueueHead;
+		pIsolate->pQueueHead = pJob->pNext;
+		if (!pIsolate->pQueueHead)
+			pIsolate->pQueueTail = NULL;
+		pJob->pNext = NULL;
+		pIsolate->nQueued--;
+		pIsolate->pJob = pJob;
+		ring_webview_mutex_unlock(&pIsolate->oMutex);
+
+		double nStart = ring_webview_now_ms();
+		double nTrace = ring_webview_trace_begin();
+		ring_webview_worker_run_job(pRingState, pJob);
+		int bMessageFailed = pJob->cError && pJob->nKind == RING_WEBVIEW_JOB_MESSAGE;
+		if (bMessageFailed)
+		{
+			// Shows up in isolate_stats() and, while tracing, on the window thread's row.
+			ring_webview_trace_end("post-error", pJob->cFunc, nTrace);
+			pJob->nKind = RING_WEBVIEW_JOB_POST_ERROR;
+		}
+
+		ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+		ring_webview_mutex_lock(&pIsolate->oMutex);
+		pIsolate->pJob = NULL;
+		pIsolate->nBusyMs += ring_webview_now_ms() - nStart;
+		if (pJob->cError)
+			pIsolate->nFailed++;
+		if (bMessageFailed)
+			pIsolate->nMessagesFailed++;
+		ring_webview_mutex_unlock(&pIsolate->oMutex);
+		// Calls are answered and failed messages reported on the UI loop; other messages have nothing to report.
+		if (pJob->nKind != RING_WEBVIEW_JOB_MESSAGE && !pIsolate->bDetached)
+			ring_webview_deliver_job(pJob);
+		else
+			ring_webview_job_free(pJob);
+		ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+		ring_webview_mutex_lock(&pIsolate->oMutex);
+	}
+	ring_webview_mutex_unlock(&pIsolate->oMutex);
+
+	if (pRingState)
+		ring_state_delete(pRingState);
+}
+
+// Waits for the window's own thread to finish its current job, then frees its state.
+static void ring_webview_stop_isolate(RingWebView *pRingWebView)
+{
+	RingWebViewIsolate *pIsolate = pRingWebView->pIsolate;
+	if (!pIsolate)
+		return;
+	ring_webview_mutex_lock(&pIsolate->oMutex);
+	pIsolate->bStopping = 1;
+	ring_webview_cond_broadcast(&pIsolate->oWake);
+	ring_webview_mutex_unlock(&pIsolate->oMutex);
+	ring_webview_thread_join(pIsolate->oThread);
+
+	while (pIsolate->pQueueHead)
+	{
+		RingWebViewJob *pJob = pIsolate->pQueueHead;
+		pIsolate->pQueueHead = pJob->pNext;
+		ring_webview_job_free(pJob);
+	}
+	ring_webview_mutex_destroy(&pIsolate->oMutex);
+	ring_webview_cond_destroy(&pIsolate->oWake);
+	free(pIsolate->cFile);
+	free(pIsolate);
+	pRingWebView->pIsolate = NULL;
+}
+
+#define RING_WEBVIEW_SET_EVENT_FUNC(funcname, member)                                                                  \
+	RING_FUNC(funcname)                                                                                                \
+	{                                                                                                                  \
+		if (RING_API_PARACOUNT != 2)                                                                                   \
+		{                                                                                                              \
+			RING_API_ERROR(RING_API_MISS2PARA);                                                                        \
+			return;                                                                                                    \
+		}                                                                                                              \
+		if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))                                                          \
+		{                                                                                                              \
+			RING_API_ERROR(RING_API_BADPARATYPE);                                                                      \
+			return;                                                                                                    \
+		}                                                                                                              \
+		RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");                               \
+		if (!pRingWebView || !pRingWebView->webview)                                                                   \
+		{                                                                                                              \
+			RING_API_ERROR("Invalid webview pointer");                                                                 \
+			return;                                                                                                    \
+		}                                                                                                              \
+		if (pRingWebView->member)                                                                                      \
+		{                                                                                                              \
+			ring_state_free(pRingWebView->pMainRingState, pRingWebView->member);                                       \
+		}                                                                                                              \
+		pRingWebView->member = ring_webview_string_strdup(pRingWebView->pMainRingState, RING_API_GETSTRING(2));        \
+		RING_API_RETNUMBER(1);                                                                                         \
+	}
+
+// Custom free function for the RingWebView object, called by the GC.
+void ring_webview_free(void *pState, void *pPointer)
+{
+	RingWebView *pRingWebView = (RingWebView *)pPointer;
+	// The watchdog reports to this webview; it can't outlive it.
+	if (oRingWebViewWatchdog.pOwner == pRingWebView)
+		ring_webview_watchdog_end();
+	ring_webview_destroy_internal(pRingWebView);
+	ring_webview_release_binds(pRingWebView);
+	ring_webview_clear_pending_calls(pRingWebView);
+	if (pRingWebView->pBindMap)
+		ring_webview_map_free(pRingWebView->pBindMap);
+	if (pRingWebView->pPendingMap)
+		ring_webview_map_free(pRingWebView->pPendingMap);
+	if (pRingWebView->pCallTokens)
+		ring_webview_map_free(pRingWebView->pCallTokens);
+	ring_webview_free_stats(pRingWebView);
+#ifdef WEBVIEW_PLATFORM_UNIX
+	ring_webview_mutex_destroy(&pRingWebView->oHeldMutex);
+#endif
+	ring_state_free(pState, pPointer);
+}
+
+/* ============================================================================
+ * Core WebView Functions
+ * ============================================================================ */
+
+RING_FUNC(ring_webview_dispatch)
+{
+	if (RING_API_PARACOUNT != 2 && RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || (RING_API_PARACOUNT == 3 && !RING_API_ISNUMBER(3)))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int nPriority = RING_API_PARACOUNT == 3 ? (int)RING_API_GETNUMBER(3) : RING_WEBVIEW_PRIORITY_NORMAL;
+	if (nPriority < 0 || nPriority >= RING_WEBVIEW_PRIORITY_COUNT)
+	{
+		RING_API_ERROR("Priority must be one of the WEBVIEW_PRIORITY_* constants");
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	const char *cCodeToRun = RING_API_GETSTRING(2);
+
+	RingWebViewDispatch *pDispatch =
+		(RingWebViewDispatch *)ring_state_malloc(pRingWebView->pMainRingState, sizeof(RingWebViewDispatch));
+	if (pDispatch == NULL)
+	{
+		RING_API_ERROR(RING_OOM);
+		return;
+	}
+	// Use the main RingState stored when webview was created
+	pDispatch->pRingState = pRingWebView->pMainRingState;
+	pDispatch->cCode = ring_webview_string_strdup(pRingWebView->pMainRingState, cCodeToRun);
+	if (pDispatch->cCode == NULL)
+	{
+		ring_state_free(pRingWebView->pMainRingState, pDispatch);
+		RING_API_ERROR(RING_OOM);
+		return;
+	}
+
+	ring_webview_record(RING_WEBVIEW_RECORD_DISPATCH, cCodeToRun, NULL, NULL, 0);
+	pDispatch->nPriority = nPriority;
+	pDispatch->pNext = NULL;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	if (ring_webview_hold_dispatch(pRingWebView, pDispatch))
+	{
+		RING_API_RETNUMBER(WEBVIEW_ERROR_OK);
+		return;
+	}
+#endif
+	// Frees the dispatch if it can't be queued.
+	RING_API_RETNUMBER(ring_webview_scheduler_push_dispatch(pRingWebView, pDispatch));
+}
+
+RING_FUNC(ring_webview_yield)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	// Nested yields are ignored; the outer one is already pumping the loop.
+	if (bRingWebViewYielding)
+	{
+		RING_API_RETNUMBER(0);
+		return;
+	}
+
+	VM *pVM = pRingWebView->pMainRingState->pVM;
+	int nEvents = 0;
+
+	// Inside a handler we own the VM mutex; release it so dispatched code can take it.
+	int bHoldsLock = nRingWebViewCallDepth > 0;
+	bRingWebViewYielding = 1;
+	if (bHoldsLock)
+		ring_vm_mutexunlock(pVM);
+	ring_webview_watchdog_heartbeat();
+
+#if defined(WEBVIEW_PLATFORM_UNIX) || defined(WEBVIEW_PLATFORM_WINDOWS)
+	nEvents = ring_webview_pump_events(RING_WEBVIEW_YIELD_MAX_EVENTS);
+#elif defined(WEBVIEW_PLATFORM_MACOS)
+	nEvents = ring_webview_macos_pump_events(RING_WEBVIEW_YIELD_MAX_EVENTS);
+#endif
+
+	ring_webview_watchdog_heartbeat();
+	if (bHoldsLock)
+		ring_vm_mutexlock(pVM);
+	bRingWebViewYielding = 0;
+
+	ring_webview_flush_deferred_calls();
+	RING_API_RETNUMBER(nEvents);
+}
+
+RING_FUNC(ring_webview_step)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	// Handlers keep the window alive with yield(); stepping from one would nest them.
+	if (nRingWebViewCallDepth > 0 || bRingWebViewYielding)
+	{
+		RING_API_ERROR("webview_step() can't be called from a callback, use webview_yield()");
+		return;
+	}
+
+	if (pRingWebView->bStopped)
+	{
+		RING_API_RETNUMBER(-1);
+		return;
+	}
+
+	int nTimeoutMs = (int)RING_API_GETNUMBER(2);
+	int nEvents = 0;
+	pRingWebView->bRunning = 1;
+	ring_webview_watchdog_heartbeat();
+
+#if defined(WEBVIEW_PLATFORM_UNIX)
+	nEvents = ring_webview_step_events(nTimeoutMs);
+#elif defined(WEBVIEW_PLATFORM_WINDOWS)
+	int bQuit = 0;
+	nEvents = ring_webview_step_events(nTimeoutMs, &bQuit);
+	if (bQuit)
+		pRingWebView->bStopped = 1;
+#elif defined(WEBVIEW_PLATFORM_MACOS)
+	nEvents = ring_webview_macos_step_events(nTimeoutMs, RING_WEBVIEW_YIELD_MAX_EVENTS);
+	if (pRingWebView->bClosed)
+		pRingWebView->bStopped = 1;
+#endif
+
+	ring_webview_watchdog_heartbeat();
+	ring_webview_flush_deferred_calls();
+	ring_webview_deliver_stall_report();
+
+	// A handler may have called terminate() or destroy() while the loop ran.
+	if (pRingWebView->bStopped || !pRingWebView->webview)
+	{
+		RING_API_RETNUMBER(-1);
+		return;
+	}
+	RING_API_RETNUMBER(nEvents);
+}
+
+RING_FUNC(ring_webview_poll_fds)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	// [timeoutMs, [[fd, events], ...]]; events uses the poll() bits (POLLIN = 1, POLLOUT = 4).
+	List *pList = RING_API_NEWLIST;
+	int nTimeoutMs = -1;
+	List *pFds;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GPollFD aFds[RING_WEBVIEW_STEP_MAX_FDS];
+	int nFds = ring_webview_query_poll_fds(aFds, RING_WEBVIEW_STEP_MAX_FDS, &nTimeoutMs);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nTimeoutMs);
+	pFds = ring_list_newlist_gc(((VM *)pPointer)->pRingState, pList);
+	for (int i = 0; i < nFds; i++)
+	{
+		List *pFd = ring_list_newlist_gc(((VM *)pPointer)->pRingState, pFds);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pFd, aFds[i].fd);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pFd, aFds[i].events);
+	}
+#else
+	// The Windows and macOS loops wait on a message queue, not on descriptors.
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nTimeoutMs);
+	pFds = ring_list_newlist_gc(((VM *)pPointer)->pRingState, pList);
+	(void)pFds;
+#endif
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_set_interval)
+{
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	// An interval of 0 would keep the loop busy.
+	double nMs = RING_API_GETNUMBER(2);
+	if (nMs < 1)
+	{
+		RING_API_ERROR("The interval must be at least 1 ms");
+		return;
+	}
+	RING_API_RETNUMBER(ring_webview_timer_start(pRingWebView, nMs, RING_API_GETSTRING(3), 1));
+}
+
+RING_FUNC(ring_webview_set_timeout)
+{
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	double nMs = RING_API_GETNUMBER(2);
+	if (nMs < 0)
+		nMs = 0;
+	RING_API_RETNUMBER(ring_webview_timer_start(pRingWebView, nMs, RING_API_GETSTRING(3), 0));
+}
+
+RING_FUNC(ring_webview_clear_timer)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	double nId = RING_API_GETNUMBER(2);
+	for (RingWebViewTimer *pTimer = pRingWebView->pTimers; pTimer; pTimer = pTimer->pNext)
+	{
+		if (pTimer->nId == nId)
+		{
+			ring_webview_timer_cancel(pTimer);
+			RING_API_RETNUMBER(1);
+			return;
+		}
+	}
+	RING_API_RETNUMBER(0);
+}
+
+RING_FUNC(ring_webview_timer_stats)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	// One [id, func, intervalMs, repeat, fires, skipped, avgLateMs, maxLateMs] per running timer.
+	List *pList = RING_API_NEWLIST;
+	for (RingWebViewTimer *pTimer = pRingWebView->pTimers; pTimer; pTimer = pTimer->pNext)
+	{
+		List *pItem = ring_list_newlist_gc(((VM *)pPointer)->pRingState, pList);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, pTimer->nId);
+		ring_list_addstring_gc(((VM *)pPointer)->pRingState, pItem, pTimer->cFunc);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, pTimer->nIntervalMs);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, pTimer->bRepeat);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, pTimer->nFires);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, pTimer->nSkipped);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem,
+							   pTimer->nFires > 0 ? pTimer->nLateTotalMs / pTimer->nFires : 0);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, pTimer->nLateMaxMs);
+	}
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_spawn)
+{
+	if (RING_API_PARACOUNT != 4)
+	{
+		RING_API_ERROR(RING_API_MISS4PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISLIST(3) || !RING_API_ISSTRING(4))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+	if (!oRingWebViewWorkers.nThreads)
+	{
+		RING_API_ERROR("Start the worker pool with webview_workers_start() first");
+		return;
+	}
+	if (!ring_webview_is_func_name(RING_API_GETSTRING(2)))
+	{
+		RING_API_ERROR("Invalid worker function name");
+		return;
+	}
+
+	RingWebViewJob *pJob = (RingWebViewJob *)calloc(1, sizeof(RingWebViewJob));
+	if (!pJob)
+	{
+		RING_API_ERROR(RING_OOM);
+		return;
+	}
+	pJob->pRingWebView = pRingWebView;
+	pJob->cFunc = ring_webview_worker_strdup(RING_API_GETSTRING(2));
+	pJob->cArgs = ring_list_to_json_string(RING_API_STATE, RING_API_GETLIST(3));
+	pJob->cDone = ring_webview_worker_strdup(RING_API_GETSTRING(4));
+	if (!pJob->cFunc || !pJob->cArgs || !pJob->cDone)
+	{
+		ring_webview_job_free(pJob);
+		RING_API_ERROR("Could not encode the arguments as JSON");
+		return;
+	}
+
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	pJob->nId = ++oRingWebViewWorkers.nNextId;
+	if (oRingWebViewWorkers.pQueueTail)
+		oRingWebViewWorkers.pQueueTail->pNext = pJob;
+	else
+		oRingWebViewWorkers.pQueueHead = pJob;
+	oRingWebViewWorkers.pQueueTail = pJob;
+	oRingWebViewWorkers.nQueued++;
+	if (oRingWebViewWorkers.nQueued > oRingWebViewWorkers.nMaxQueued)
+		oRingWebViewWorkers.nMaxQueued = oRingWebViewWorkers.nQueued;
+	ring_webview_cond_signal(&oRingWebViewWorkers.oWake);
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+
+	RING_API_RETNUMBER(pJob->nId);
+}
+
+RING_FUNC(ring_webview_set_isolated)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+	if (pRingWebView->pIsolate)
+	{
+		RING_API_ERROR("The webview already has its own Ring state");
+		return;
+	}
+
+	RingWebViewIsolate *pIsolate = (RingWebViewIsolate *)calloc(1, sizeof(RingWebViewIsolate));
+	if (!pIsolate)
+	{
+		RING_API_ERROR(RING_OOM);
+		return;
+	}
+	pIsolate->cFile = ring_webview_worker_strdup(RING_API_GETSTRING(2));
+	if (!pIsolate->cFile)
+	{
+		free(pIsolate);
+		RING_API_ERROR(RING_OOM);
+		return;
+	}
+	pIsolate->nWindowId = pRingWebView->nWindowId;
+	ring_webview_mutex_init(&pIsolate->oMutex);
+	ring_webview_cond_init(&pIsolate->oWake);
+	/* Published under the workers mutex before the thread starts, so its file
+	 * can already find the window with webview_self(). Calls and messages
+	 * arriving before the thread is up wait in the queue. */
+	ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+	pRingWebView->pIsolate = pIsolate;
+	ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	if (!ring_webview_thread_create(&pIsolate->oThread, ring_webview_isolate_main, pIsolate))
+	{
+		// Once unpublished no other thread can reach the queue; drop what webview_post() put there.
+		ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+		pRingWebView->pIsolate = NULL;
+		ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+		while (pIsolate->pQueueHead)
+		{
+			RingWebViewJob *pJob = pIsolate->pQueueHead;
+			pIsolate->pQueueHead = pJob->pNext;
+			ring_webview_job_free(pJob);
+		}
+		ring_webview_mutex_destroy(&pIsolate->oMutex);
+		ring_webview_cond_destroy(&pIsolate->oWake);
+		free(pIsolate->cFile);
+		free(pIsolate);
+		RING_API_ERROR("Could not start the webview's thread");
+		return;
+	}
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_window_id)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+	RING_API_RETNUMBER(pRingWebView->nWindowId);
+}
+
+RING_FUNC(ring_webview_isolate_stats)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	// [queued, calls, messages, failed, busyMs, messagesFailed]; zeros for a webview on the main VM.
+	double aStats[6] = {0, 0, 0, 0, 0, 0};
+	RingWebViewIsolate *pIsolate = pRingWebView->pIsolate;
+	if (pIsolate)
+	{
+		ring_webview_mutex_lock(&pIsolate->oMutex);
+		aStats[0] = pIsolate->nQueued;
+		aStats[1] = pIsolate->nCalls;
+		aStats[2] = pIsolate->nMessages;
+		aStats[3] = pIsolate->nFailed;
+		aStats[4] = pIsolate->nBusyMs;
+		aStats[5] = pIsolate->nMessagesFailed;
+		ring_webview_mutex_unlock(&pIsolate->oMutex);
+	}
+	List *pList = RING_API_NEWLIST;
+	for (int i = 0; i < 6; i++)
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, aStats[i]);
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_call_cancelled)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	RING_API_RETNUMBER(ring_webview_is_call_cancelled(pRingWebView, RING_API_GETSTRING(2)));
+}
+
+RING_FUNC(ring_webview_cancel_call)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	RingWebViewPendingCall *pCall = ring_webview_find_pending_call(pRingWebView, RING_API_GETSTRING(2));
+	RING_API_RETNUMBER(pCall ? ring_webview_cancel_pending_call(pRingWebView, pCall, 0) : 0);
+}
+
+RING_FUNC(ring_webview_set_bind_timeout)
+{
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	int nTimeoutMs = (int)RING_API_GETNUMBER(3);
+	if (nTimeoutMs < 0)
+	{
+		RING_API_ERROR("Timeout must be zero (disabled) or a positive number of milliseconds");
+		return;
+	}
+
+	RingWebViewBind *pBind = ring_webview_find_bind(pRingWebView, RING_API_GETSTRING(2));
+	if (!pBind)
+	{
+		RING_API_RETNUMBER(0);
+		return;
+	}
+#ifndef WEBVIEW_PLATFORM_UNIX
+	// Call timers are only armed on GTK; don't claim a timeout that never fires.
+	if (nTimeoutMs > 0)
+	{
+		RING_API_RETNUMBER(0);
+		return;
+	}
+#endif
+	// Applies to calls made from now on; calls already in flight keep their timer.
+	pBind->nTimeoutMs = nTimeoutMs;
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_set_bind_priority)
+{
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	int nPriority = (int)RING_API_GETNUMBER(3);
+	if (nPriority < 0 || nPriority >= RING_WEBVIEW_PRIORITY_COUNT)
+	{
+		RING_API_ERROR("Priority must be one of the WEBVIEW_PRIORITY_* constants");
+		return;
+	}
+
+	RingWebViewBind *pBind = ring_webview_find_bind(pRingWebView, RING_API_GETSTRING(2));
+	if (!pBind)
+	{
+		RING_API_RETNUMBER(0);
+		return;
+	}
+	// Calls already queued keep their class.
+	pBind->nPriority = nPriority;
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_set_starvation_limit)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISNUMBER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (RING_API_GETNUMBER(1) < 0)
+	{
+		RING_API_ERROR("The starvation limit must be zero or a positive number of milliseconds");
+		return;
+	}
+	ring_webview_scheduler_init();
+	ring_webview_mutex_lock(&oRingWebViewScheduler.oMutex);
+	oRingWebViewScheduler.nStarvationMs = RING_API_GETNUMBER(1);
+	ring_webview_mutex_unlock(&oRingWebViewScheduler.oMutex);
+}
+
+RING_FUNC(ring_webview_scheduler_stats)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+	ring_webview_scheduler_init();
+	unsigned int aQueued[RING_WEBVIEW_PRIORITY_COUNT];
+	ring_webview_mutex_lock(&oRingWebViewScheduler.oMutex);
+	for (int i = 0; i < RING_WEBVIEW_PRIORITY_COUNT; i++)
+		aQueued[i] = oRingWebViewScheduler.aQueued[i];
+	ring_webview_mutex_unlock(&oRingWebViewScheduler.oMutex);
+
+	void *pState = ((VM *)pPointer)->pRingState;
+	List *pList = RING_API_NEWLIST;
+	for (int i = 0; i < RING_WEBVIEW_PRIORITY_COUNT; i++)
+	{
+		List *pPair = ring_list_newlist_gc(pState, pList);
+		ring_list_addstring_gc(pState, pPair, ring_webview_priority_name(i));
+		List *pValues = ring_list_newlist_gc(pState, pPair);
+		const char *aNames[] = {"queued", "ran", "promoted"};
+		double aValues[] = {aQueued[i], oRingWebViewScheduler.aRan[i], oRingWebViewScheduler.aPromoted[i]};
+		for (int j = 0; j < 3; j++)
+		{
+			List *pItem = ring_list_newlist_gc(pState, pValues);
+			ring_list_addstring_gc(pState, pItem, aNames[j]);
+			ring_list_adddouble_gc(pState, pItem, aValues[j]);
+		}
+		ring_webview_hist_to_list(pState, pValues, "wait_us", &oRingWebViewScheduler.aWait[i]);
+		ring_webview_hist_to_list(pState, pValues, "latency_us", &oRingWebViewScheduler.aLatency[i]);
+	}
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_scheduler_stats_reset)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+	for (int i = 0; i < RING_WEBVIEW_PRIORITY_COUNT; i++)
+	{
+		oRingWebViewScheduler.aRan[i] = 0;
+		oRingWebViewScheduler.aPromoted[i] = 0;
+		memset(&oRingWebViewScheduler.aWait[i], 0, sizeof(RingWebViewHistogram));
+		memset(&oRingWebViewScheduler.aLatency[i], 0, sizeof(RingWebViewHistogram));
+	}
+}
+
+RING_FUNC(ring_webview_bind_cache)
+{
+	if (RING_API_PARACOUNT != 4)
+	{
+		RING_API_ERROR(RING_API_MISS4PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISNUMBER(3) || !RING_API_ISNUMBER(4))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	int nMaxSize = (int)RING_API_GETNUMBER(3);
+	double nTtlMs = RING_API_GETNUMBER(4);
+	if (nMaxSize < 0 || nTtlMs < 0)
+	{
+		RING_API_ERROR("Cache size and TTL must not be negative");
+		return;
+	}
+
+	RingWebViewBind *pBind = ring_webview_find_bind(pRingWebView, RING_API_GETSTRING(2));
+	if (!pBind)
+	{
+		RING_API_RETNUMBER(0);
+		return;
+	}
+
+	// Reconfiguring starts from an empty cache; a size of 0 turns caching off.
+	if (pBind->pCache)
+	{
+		ring_webview_cache_free(pBind->pCache);
+		pBind->pCache = NULL;
+	}
+	if (nMaxSize > 0)
+	{
+		pBind->pCache = ring_webview_cache_new(pBind->pMainRingState, (unsigned int)nMaxSize, nTtlMs);
+		if (!pBind->pCache)
+		{
+			RING_API_ERROR(RING_OOM);
+			return;
+		}
+	}
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_bind_cache_clear)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	RingWebViewBind *pBind = ring_webview_find_bind(pRingWebView, RING_API_GETSTRING(2));
+	if (!pBind || !pBind->pCache)
+	{
+		RING_API_RETNUMBER(0);
+		return;
+	}
+	ring_webview_cache_clear(pBind->pCache);
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_bind_cache_stats)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	RingState *pRingState = ((VM *)pPointer)->pRingState;
+	List *pList = RING_API_NEWLIST;
+	RingWebViewBind *pBind = ring_webview_find_bind(pRingWebView, RING_API_GETSTRING(2));
+	if (pBind && pBind->pCache)
+	{
+		RingWebViewCache *pCache = pBind->pCache;
+		const char *aNames[] = {"size", "max_size", "hits", "misses", "evictions"};
+		double aValues[] = {(double)pCache->nSize, (double)pCache->nMaxSize, pCache->nHits, pCache->nMisses,
+							pCache->nEvictions};
+		for (int i = 0; i < 5; i++)
+		{
+			List *pPair = ring_list_newlist_gc(pRingState, pList);
+			ring_list_addstring_gc(pRingState, pPair, aNames[i]);
+			ring_list_adddouble_gc(pRingState, pPair, aValues[i]);
+		}
+	}
+
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_trace_start)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RING_API_RETNUMBER(ring_webview_trace_begin_session(RING_API_GETSTRING(1)));
+}
+
+RING_FUNC(ring_webview_trace_stop)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+	long nWritten = ring_webview_trace_end_session();
+	if (nWritten < 0)
+	{
+		RING_API_ERROR("Failed to write trace file");
+		return;
+	}
+	RING_API_RETNUMBER(nWritten);
+}
+
+RING_FUNC(ring_webview_record_start)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	int nResult = ring_webview_record_begin(RING_API_GETSTRING(1));
+	if (nResult < 0)
+	{
+		RING_API_ERROR("Failed to open recording file");
+		return;
+	}
+	RING_API_RETNUMBER(nResult);
+}
+
+RING_FUNC(ring_webview_record_stop)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+	double nRecords = ring_webview_record_end();
+	if (nRecords < 0)
+	{
+		RING_API_ERROR("Failed to write recording file");
+		return;
+	}
+	RING_API_RETNUMBER(nRecords);
+}
+
+/* Loads a recording as a list of records:
+ *   ["call", nTimeMs, cName, cId, cRequestJson]
+ *   ["return", nTimeMs, cId, nStatus, cResultJson]
+ *   ["dispatch", nTimeMs, cCode]
+ *   ["eval", nTimeMs, cJs]
+ *   ["event", nTimeMs, cCallback, cArg]
+ * nTimeMs is measured from the start of the recording. */
+RING_FUNC(ring_webview_record_load)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	FILE *pFile = fopen(RING_API_GETSTRING(1), "rb");
+	if (pFile == NULL)
+	{
+		RING_API_ERROR("Failed to open recording file");
+		return;
+	}
+	fseek(pFile, 0, SEEK_END);
+	long nSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	unsigned char *pData = nSize > 0 ? (unsigned char *)malloc((size_t)nSize) : NULL;
+	if (pData == NULL || fread(pData, 1, (size_t)nSize, pFile) != (size_t)nSize ||
+		nSize < RING_WEBVIEW_RECORD_MAGIC_SIZE ||
+		memcmp(pData, RING_WEBVIEW_RECORD_MAGIC, RING_WEBVIEW_RECORD_MAGIC_SIZE) != 0)
+	{
+		free(pData);
+		fclose(pFile);
+		RING_API_ERROR("Not a webview recording");
+		return;
+	}
+	fclose(pFile);
+
+	RingState *pRingState = ((VM *)pPointer)->pRingState;
+	List *pList = RING_API_NEWLIST;
+	RingWebViewRecordReader oReader = {pData, (size_t)nSize, RING_WEBVIEW_RECORD_MAGIC_SIZE, 0};
+	double nTimeUs = 0;
+
+	while (oReader.nPos < oReader.nSize && !oReader.bError)
+	{
+		int nType = oReader.pData[oReader.nPos++];
+		nTimeUs += (double)ring_webview_record_read_varint(&oReader);
+
+		const char *cA, *cB, *cC;
+		size_t nA, nB, nC;
+		List *pRecord = ring_list_newlist_gc(pRingState, pList);
+		switch (nType)
+		{
+		case RING_WEBVIEW_RECORD_CALL:
+			nA = ring_webview_record_read_string(&oReader, &cA);
+			nB = ring_webview_record_read_string(&oReader, &cB);
+			nC = ring_webview_record_read_string(&oReader, &cC);
+			ring_list_addstring_gc(pRingState, pRecord, "call");
+			ring_list_adddouble_gc(pRingState, pRecord, nTimeUs / 1000.0);
+			ring_list_addstring2_gc(pRingState, pRecord, cA, (unsigned int)nA);
+			ring_list_addstring2_gc(pRingState, pRecord, cB, (unsigned int)nB);
+			ring_list_addstring2_gc(pRingState, pRecord, cC, (unsigned int)nC);
+			break;
+		case RING_WEBVIEW_RECORD_RETURN: {
+			nA = ring_webview_record_read_string(&oReader, &cA);
+			uint64_t nZigZag = ring_webview_record_read_varint(&oReader);
+			nC = ring_webview_record_read_string(&oReader, &cC);
+			ring_list_addstring_gc(pRingState, pRecord, "return");
+			ring_list_adddouble_gc(pRingState, pRecord, nTimeUs / 1000.0);
+			ring_list_addstring2_gc(pRingState, pRecord, cA, (unsigned int)nA);
+			ring_list_adddouble_gc(pRingState, pRecord, (double)((int64_t)(nZigZag >> 1) ^ -(int64_t)(nZigZag & 1)));
+			ring_list_addstring2_gc(pRingState, pRecord, cC, (unsigned int)nC);
+			break;
+		}
+		case RING_WEBVIEW_RECORD_DISPATCH:
+		case RING_WEBVIEW_RECORD_EVAL:
+			nA = ring_webview_record_read_string(&oReader, &cA);
+			ring_list_addstring_gc(pRingState, pRecord, nType == RING_WEBVIEW_RECORD_EVAL ? "eval" : "dispatch");
+			ring_list_adddouble_gc(pRingState, pRecord, nTimeUs / 1000.0);
+			ring_list_addstring2_gc(pRingState, pRecord, cA, (unsigned int)nA);
+			break;
+		case RING_WEBVIEW_RECORD_EVENT:
+			nA = ring_webview_record_read_string(&oReader, &cA);
+			nB = ring_webview_record_read_string(&oReader, &cB);
+			ring_list_addstring_gc(pRingState, pRecord, "event");
+			ring_list_adddouble_gc(pRingState, pRecord, nTimeUs / 1000.0);
+			ring_list_addstring2_gc(pRingState, pRecord, cA, (unsigned int)nA);
+			ring_list_addstring2_gc(pRingState, pRecord, cB, (unsigned int)nB);
+			break;
+		default:
+			oReader.bError = 1;
+			break;
+		}
+	}
+	free(pData);
+
+	// A truncated last record (e.g. the app crashed while recording) is dropped.
+	if (oReader.bError && ring_list_getsize(pList) > 0)
+	{
+		ring_list_deletelastitem_gc(pRingState, pList);
+	}
+
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_watchdog_start)
+{
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	double nThresholdMs = RING_API_GETNUMBER(2);
+	if (nThresholdMs <= 0)
+	{
+		RING_API_ERROR("Stall threshold must be positive");
+		return;
+	}
+
+	int nResult = ring_webview_watchdog_begin(pRingWebView, nThresholdMs, RING_API_GETSTRING(3));
+	if (nResult == -1)
+	{
+		RING_API_ERROR("Failed to open watchdog log file");
+		return;
+	}
+	if (nResult == -2)
+	{
+		RING_API_ERROR("Failed to start watchdog thread");
+		return;
+	}
+	RING_API_RETNUMBER(nResult);
+}
+
+RING_FUNC(ring_webview_watchdog_stop)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+	// The watchdog is process-wide; only the webview that started it stops it.
+	if (oRingWebViewWatchdog.pOwner != pRingWebView)
+	{
+		RING_API_RETNUMBER(0);
+		return;
+	}
+	RING_API_RETNUMBER(ring_webview_watchdog_end());
+}
+
+RING_FUNC(ring_webview_bind_stats)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	RingState *pRingState = ((VM *)pPointer)->pRingState;
+	List *pList = RING_API_NEWLIST;
+	List *pPair = ring_list_newlist_gc(pRingState, pList);
+	ring_list_addstring_gc(pRingState, pPair, "live");
+	ring_list_adddouble_gc(pRingState, pPair, (double)pRingWebView->nLiveBinds);
+	pPair = ring_list_newlist_gc(pRingState, pList);
+	ring_list_addstring_gc(pRingState, pPair, "bytes");
+	ring_list_adddouble_gc(pRingState, pPair, pRingWebView->nLiveBindBytes);
+
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_stats_enable)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	int bEnable = (int)RING_API_GETNUMBER(2) != 0;
+	if (bEnable && !pRingWebView->pStatsMap)
+	{
+		pRingWebView->pStatsMap = ring_webview_map_new(pRingWebView->pMainRingState);
+		if (!pRingWebView->pStatsMap)
+		{
+			RING_API_ERROR(RING_OOM);
+			return;
+		}
+	}
+	// Disabling keeps the collected numbers; webview_stats_reset() clears them.
+	pRingWebView->bStats = bEnable;
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_stats)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	RingState *pRingState = ((VM *)pPointer)->pRingState;
+	List *pList = RING_API_NEWLIST;
+	RingWebViewMap *pMap = pRingWebView->pStatsMap;
+	if (pMap)
+	{
+		for (unsigned int i = 0; i < pMap->nBuckets; i++)
+		{
+			for (RingWebViewMapEntry *pEntry = pMap->aBuckets[i]; pEntry; pEntry = pEntry->pNext)
+			{
+				List *pPair = ring_list_newlist_gc(pRingState, pList);
+				ring_list_addstring_gc(pRingState, pPair, pEntry->cKey);
+				ring_webview_stats_to_list(pRingState, ring_list_newlist_gc(pRingState, pPair),
+										   (RingWebViewStats *)pEntry->pValue);
+			}
+		}
+	}
+
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_stats_reset)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	RingWebViewMap *pMap = pRingWebView->pStatsMap;
+	if (pMap)
+	{
+		for (unsigned int i = 0; i < pMap->nBuckets; i++)
+		{
+			for (RingWebViewMapEntry *pEntry = pMap->aBuckets[i]; pEntry; pEntry = pEntry->pNext)
+			{
+				ring_webview_stats_clear((RingWebViewStats *)pEntry->pValue);
+			}
+		}
+	}
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_call_stats)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	RingState *pRingState = ((VM *)pPointer)->pRingState;
+	List *pList = RING_API_NEWLIST;
+	const char *aNames[] = {"pending", "completed", "cancelled", "timeouts", "late_returns"};
+	double aValues[] = {(double)pRingWebView->nPendingCalls, pRingWebView->nCallsCompleted,
+						pRingWebView->nCallsCancelled, pRingWebView->nCallsTimedOut, pRingWebView->nLateReturns};
+	for (int i = 0; i < 5; i++)
+	{
+		List *pPair = ring_list_newlist_gc(pRingState, pList);
+		ring_list_addstring_gc(pRingState, pPair, aNames[i]);
+		ring_list_adddouble_gc(pRingState, pPair, aValues[i]);
+	}
+
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_bind)
+{
+	if (RING_API_PARACOUNT != 3)
+	{
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISSTRING(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	const char *js_name = RING_API_GETSTRING(2);
+	const char *ring_func_name = RING_API_GETSTRING(3);
+
+	RingWebViewBind *pBind = NULL;
+	webview_error_t result = ring_webview_bind_name(RING_API_STATE, pRingWebView, js_name, ring_func_name, NULL, &pBind);
+
+	if (result == WEBVIEW_ERROR_OK)
+	{
+		// The record is owned by the webview's binding registry; the pointer is only a handle.
+		RING_API_RETCPOINTER(pBind, "webview_bind_t");
+	}
+	else
+	{
+		RING_API_RETNUMBER(result);
+	}
+}
+
+RING_FUNC(ring_webview_bind_method)
+{
+	if (RING_API_PARACOUNT != 4)
+	{
+		RING_API_ERROR(RING_API_MISS4PARA);
+		return;
+	}
+
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISOBJECT(3) || !RING_API_ISSTRING(4))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	// The object is borrowed: the caller must keep a reference to it alive
+	// (WebView.bind() does) for as long as the binding exists.
+	RingWebViewBind *pBind = NULL;
+	webview_error_t result = ring_webview_bind_name(RING_API_STATE, pRingWebView, RING_API_GETSTRING(2),
+													RING_API_GETSTRING(4), RING_API_GETLIST(3), &pBind);
+
+	if (result == WEBVIEW_ERROR_OK)
+	{
+		RING_API_RETCPOINTER(pBind, "webview_bind_t");
+	}
+	else
+	{
+		RING_API_RETNUMBER(result);
+	}
+}
+
+RING_FUNC(ring_webview_unbind)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	const char *js_name = RING_API_GETSTRING(2);
+	RingWebViewBind *pBind = ring_webview_find_bind(pRingWebView, js_name);
+
+	webview_error_t result;
+	if (pBind && pBind->bRouted)
+		result = WEBVIEW_ERROR_OK;
+	else
+		result = webview_unbind(pRingWebView->webview, js_name);
+
+	// Free the record (or hand it back once its running call returns).
+	if (pBind)
+		ring_webview_release_bind(pBind);
+	RING_API_RETNUMBER(result);
+}
+
+RING_FUNC(ring_webview_set_routing)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+
+	int bRouted = (int)RING_API_GETNUMBER(2) != 0;
+	if (bRouted && !pRingWebView->bRouterInstalled)
+	{
+		webview_error_t result = webview_bind(pRingWebView->webview, RING_WEBVIEW_ROUTE_BINDING,
+											  ring_webview_route_callback, pRingWebView);
+		if (result != WEBVIEW_ERROR_OK)
+		{
+			RING_API_RETNUMBER(result);
+			return;
+		}
+		webview_init(pRingWebView->webview, cRingWebViewRouteScript);
+		// Also cover the page that is already loaded.
+		webview_eval(pRingWebView->webview, cRingWebViewRouteScript);
+		pRingWebView->bRouterInstalled = 1;
+	}
+	// Only affects bindings made from now on.
+	pRingWebView->bRouted = bRouted;
+	RING_API_RETNUMBER(WEBVIEW_ERROR_OK);
+}
+
+RING_FUNC(ring_webview_version)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+	RING_API_RETSTRING(WEBVIEW_VERSION_NUMBER);
+}
+
+// Memory pressure settings for the web processes, see ring_webview_parse_memory_pressure().
+typedef struct RingWebViewMemoryPressure
+{
+	int bSet;
+	double nLimitMb;
+	// Fractions of the limit; -1 leaves WebKit's default.
+	double nConservative;
+	double nStrict;
+	double nKill;
+	double nPollInterval;
+} RingWebViewMemoryPressure;
+
+/* Engine options shared by every webview in the process, set with
+ * webview_set_process_options() and applied when a webview is created. All
+ * webviews already share WebKit's default web context and network session;
+ * these choose how it runs. -1 leaves WebKit's default. */
+typedef struct RingWebViewProcessOptions
+{
+	int nProcessModel;
+	int nCacheModel;
+	RingWebViewMemoryPressure oMemoryPressure;
+	// The web context exists, so the process model and memory pressure are fixed from now on.
+	int bStarted;
+	int nStartedProcessModel;
+} RingWebViewProcessOptions;
+
+static RingWebViewProcessOptions oRingWebViewProcessOptions = {-1, -1, {0, 0, 0, 0, 0, 0}, 0, -1};
+
+/* Reads [key, value] pairs: "limit" (MB), "conservative", "strict" and "kill"
+ * (fractions of the limit, kill 0 to never kill) and "pollInterval" (seconds). */
+static const char *ring_webview_parse_memory_pressure(List *pList, RingWebViewMemoryPressure *pPressure)
+{
+	pPressure->bSet = 1;
+	pPressure->nLimitMb = -1;
+	pPressure->nConservative = -1;
+	pPressure->nStrict = -1;
+	pPressure->nKill = -1;
+	pPressure->nPollInterval = -1;
+	for (unsigned int i = 1; i <= ring_list_getsize(pList); i++)
+	{
+		if (!ring_list_islist(pList, i))
+			return "Memory pressure options must be [key, value] pairs";
+		List *pPair = ring_list_getlist(pList, i);
+		if (ring_list_getsize(pPair) != 2 || !ring_list_isstring(pPair, 1) || !ring_list_isnumber(pPair, 2))
+			return "Memory pressure options must be [key, value] pairs";
+		const char *cKey = ring_list_getstring(pPair, 1);
+		double nValue = ring_list_getdouble(pPair, 2);
+		if (strcmp(cKey, "limit") == 0 && nValue >= 1)
+			pPressure->nLimitMb = nValue;
+		else if (strcmp(cKey, "conservative") == 0 && nValue > 0 && nValue < 1)
+			pPressure->nConservative = nValue;
+		else if (strcmp(cKey, "strict") == 0 && nValue > 0 && nValue < 1)
+			pPressure->nStrict = nValue;
+		else if (strcmp(cKey, "kill") == 0 && nValue >= 0)
+			pPressure->nKill = nValue;
+		else if (strcmp(cKey, "pollInterval") == 0 && nValue > 0)
+			pPressure->nPollInterval = nValue;
+		else
+			return "Invalid memory pressure option";
+	}
+	if (pPressure->nConservative > 0 && pPressure->nStrict > 0 && pPressure->nConservative >= pPressure->nStrict)
+		return "The conservative threshold must be lower than the strict one";
+	return NULL;
+}
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+/* WebKitGTK takes web process settings only when a web context is
+ * constructed, and webview always uses the default one, so only the network
+ * process gets these. They must be set before the first webview exists. */
+static void ring_webview_apply_memory_pressure(void)
+{
+	RingWebViewMemoryPressure *pPressure = &oRingWebViewProcessOptions.oMemoryPressure;
+	if (!pPressure->bSet)
+		return;
+	WebKitMemoryPressureSettings *pSettings = webkit_memory_pressure_settings_new();
+	if (pPressure->nLimitMb > 0)
+		webkit_memory_pressure_settings_set_memory_limit(pSettings, (guint)pPressure->nLimitMb);
+	if (pPressure->nConservative > 0)
+		webkit_memory_pressure_settings_set_conservative_threshold(pSettings, pPressure->nConservative);
+	if (pPressure->nStrict > 0)
+		webkit_memory_pressure_settings_set_strict_threshold(pSettings, pPressure->nStrict);
+	if (pPressure->nKill >= 0)
+		webkit_memory_pressure_settings_set_kill_threshold(pSettings, pPressure->nKill);
+	if (pPressure->nPollInterval > 0)
+		webkit_memory_pressure_settings_set_poll_interval(pSettings, pPressure->nPollInterval);
+	webkit_network_session_set_memory_pressure_settings(pSettings);
+	webkit_memory_pressure_settings_free(pSettings);
+}
+
+static void ring_webview_apply_cache_model(void)
+{
+	if (oRingWebViewProcessOptions.nCacheModel >= 0)
+		webkit_web_context_set_cache_model(webkit_web_context_get_default(),
+										   (WebKitCacheModel)oRingWebViewProcessOptions.nCacheModel);
+}
+#endif
+
+/* Creates a webview with its Ring-side state. A headless or pooled webview
+ * gets a toplevel we create and keep hidden; webview only presents windows it
+ * creates itself. Returns NULL and sets *pError on failure. */
+static RingWebView *ring_webview_new(RingState *pRingState, int bDebug, void *pWindow, int bHeadless, int bPooled,
+									 const char **pError)
+{
+	ring_webview_scheduler_init();
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWidget *pOwnedWindow = NULL;
+	if (bHeadless || bPooled)
+	{
+		if (!gtk_init_check())
+		{
+			*pError = "Headless mode needs a display (use Xvfb or a headless Wayland compositor)";
+			return NULL;
+		}
+		pOwnedWindow = gtk_window_new();
+		pWindow = pOwnedWindow;
+	}
+#else
+	if (bHeadless)
+	{
+		*pError = "Headless mode is only available on Linux/FreeBSD";
+		return NULL;
+	}
+#endif
+
+	RingWebView *pRingWebView;
+	pRingWebView = (RingWebView *)ring_state_malloc(pRingState, sizeof(RingWebView));
+	if (pRingWebView == NULL)
+	{
+#ifdef WEBVIEW_PLATFORM_UNIX
+		if (pOwnedWindow)
+			gtk_window_destroy(GTK_WINDOW(pOwnedWindow));
+#endif
+		*pError = RING_OOM;
+		return NULL;
+	}
+#ifdef WEBVIEW_PLATFORM_UNIX
+	/* WebKitGTK 6 has no process model API; its single-process switch is an
+	 * environment variable read when the default web context is created. */
+	if (!oRingWebViewProcessOptions.bStarted)
+	{
+		if (oRingWebViewProcessOptions.nProcessModel == RING_WEBVIEW_PROCESS_MODEL_SHARED)
+			g_setenv("WEBKIT_USE_SINGLE_WEB_PROCESS", "1", TRUE);
+		ring_webview_apply_memory_pressure();
+	}
+#endif
+	pRingWebView->webview = webview_create(bDebug, pWindow);
+	if (pRingWebView->webview == NULL)
+	{
+#ifdef WEBVIEW_PLATFORM_UNIX
+		if (pOwnedWindow)
+			gtk_window_destroy(GTK_WINDOW(pOwnedWindow));
+#endif
+		ring_state_free(pRingState, pRingWebView);
+		*pError = "Failed to create webview instance";
+		return NULL;
+	}
+	if (!oRingWebViewProcessOptions.bStarted)
+	{
+		oRingWebViewProcessOptions.bStarted = 1;
+		oRingWebViewProcessOptions.nStartedProcessModel = oRingWebViewProcessOptions.nProcessModel;
+#ifdef WEBVIEW_PLATFORM_UNIX
+		ring_webview_apply_cache_model();
+#endif
+	}
+	pRingWebView->bHeadless = bHeadless;
+	pRingWebView->bDebug = bDebug;
+	pRingWebView->bLowMemory = 0;
+	pRingWebView->nResizeIntervalMs = RING_WEBVIEW_RESIZE_INTERVAL_MS;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	pRingWebView->pOwnedWindow = pOwnedWindow;
+	pRingWebView->pMemoryRelease = NULL;
+	pRingWebView->nBackgroundPolicy = RING_WEBVIEW_BACKGROUND_NONE;
+	// Pooled windows start out hidden; they are shown when taken.
+	pRingWebView->nVisibility = bPooled ? RING_WEBVIEW_VISIBILITY_HIDDEN : RING_WEBVIEW_VISIBILITY_VISIBLE;
+	pRingWebView->nReportedVisibility = pRingWebView->nVisibility;
+	pRingWebView->bBackgroundScript = 0;
+	pRingWebView->nVisibilitySource = 0;
+	pRingWebView->nThrottleSource = 0;
+	pRingWebView->pStateSurface = NULL;
+	pRingWebView->nStateHandler = 0;
+	pRingWebView->nLayoutHandler = 0;
+	pRingWebView->oGeometry.bKnown = 0;
+	pRingWebView->oGeometry.nWidth = 0;
+	pRingWebView->oGeometry.nHeight = 0;
+	pRingWebView->nReportedWidth = -1;
+	pRingWebView->nReportedHeight = -1;
+	pRingWebView->nResizeReportedMs = 0;
+	pRingWebView->nResizeSource = 0;
+	ring_webview_mutex_init(&pRingWebView->oHeldMutex);
+	pRingWebView->pHeld = NULL;
+	pRingWebView->nHeldDispatches = 0;
+	pRingWebView->nCoalescedDispatches = 0;
+	pRingWebView->pSnapshots = NULL;
+	pRingWebView->pSnapshotBatch = NULL;
+	pRingWebView->nSnapshotId = 0;
+	pRingWebView->pPdfJobs = NULL;
+	pRingWebView->pPdfBatch = NULL;
+	pRingWebView->nPdfId = 0;
+#endif
+	pRingWebView->pMainRingState = pRingState;
+	pRingWebView->bRunning = 0;
+	pRingWebView->bStopped = 0;
+#ifdef WEBVIEW_PLATFORM_MACOS
+	pRingWebView->bClosed = 0;
+	pRingWebView->pCloseObserver = ring_webview_macos_watch_close(pRingWebView->webview, &pRingWebView->bClosed);
+#endif
+	pRingWebView->pTimers = NULL;
+	pRingWebView->nTimerId = 0;
+	pRingWebView->nWindowId = 0;
+	pRingWebView->pNextWindow = NULL;
+	pRingWebView->pIsolate = NULL;
+	pRingWebView->cOnClose = NULL;
+	pRingWebView->cOnResize = NULL;
+	pRingWebView->cOnFocus = NULL;
+	pRingWebView->cOnDomReady = NULL;
+	pRingWebView->cOnLoad = NULL;
+	pRingWebView->cOnNavigate = NULL;
+	pRingWebView->cOnTitle = NULL;
+	pRingWebView->cOnStall = NULL;
+	pRingWebView->cOnMemory = NULL;
+	pRingWebView->cOnVisibility = NULL;
+	pRingWebView->cOnPostError = NULL;
+	pRingWebView->pBinds = NULL;
+	pRingWebView->nLiveBinds = 0;
+	pRingWebView->nLiveBindBytes = 0;
+	pRingWebView->bStats = 0;
+	pRingWebView->pStatsMap = NULL;
+	pRingWebView->pPendingCalls = NULL;
+	pRingWebView->pPendingTail = NULL;
+	pRingWebView->pCancelledCalls = NULL;
+	pRingWebView->pCancelledTail = NULL;
+	pRingWebView->pBindMap = ring_webview_map_new(pRingState);
+	pRingWebView->pPendingMap = ring_webview_map_new(pRingState);
+	pRingWebView->pCallTokens = ring_webview_map_new(pRingState);
+	if (pRingWebView->pBindMap == NULL || pRingWebView->pPendingMap == NULL || pRingWebView->pCallTokens == NULL)
+	{
+		ring_webview_destroy_internal(pRingWebView);
+		if (pRingWebView->pBindMap)
+			ring_webview_map_free(pRingWebView->pBindMap);
+		if (pRingWebView->pPendingMap)
+			ring_webview_map_free(pRingWebView->pPendingMap);
+		if (pRingWebView->pCallTokens)
+			ring_webview_map_free(pRingWebView->pCallTokens);
+		ring_state_free(pRingState, pRingWebView);
+		*pError = RING_OOM;
+		return NULL;
+	}
+	pRingWebView->bRouted = 0;
+	pRingWebView->bRouterInstalled = 0;
+	pRingWebView->nPendingCalls = 0;
+	pRingWebView->nCancelledCalls = 0;
+	pRingWebView->nCallsCompleted = 0;
+	pRingWebView->nCallsCancelled = 0;
+	pRingWebView->nCallsTimedOut = 0;
+	pRingWebView->nLateReturns = 0;
+
+	// Lets JavaScript abort in-flight bound calls (see ringAbortable/ringCancel).
+	webview_bind(pRingWebView->webview, RING_WEBVIEW_CANCEL_BINDING, ring_webview_cancel_callback, pRingWebView);
+	webview_init(pRingWebView->webview, cRingWebViewCancelScript);
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	ring_webview_setup_drag_handler(pRingWebView);
+	ring_webview_setup_event_handlers(pRingWebView);
+	if (bHeadless)
+		ring_webview_headless_allocate(pRingWebView, RING_WEBVIEW_HEADLESS_WIDTH, RING_WEBVIEW_HEADLESS_HEIGHT);
+#endif
+	ring_webview_register_window(pRingWebView);
+
+	return pRingWebView;
+}
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+/* Pre-warmed webviews. Each one is created in a hidden window and loads an
+ * empty page, which starts its web process and injects the init scripts.
+ * webview_create() hands one out and presents its window; an idle callback
+ * then tops the pool up again. The pool is process-wide. */
+
+typedef struct RingWebViewPool
+{
+	RingState *pRingState;
+	RingWebView *aIdle[RING_WEBVIEW_POOL_MAX];
+	unsigned int nIdle;
+	unsigned int nTarget;
+	int bDebug;
+	guint nRefillSource;
+	double nHits;
+	double nMisses;
+} RingWebViewPool;
+
+static RingWebViewPool oRingWebViewPool = {NULL, {NULL}, 0, 0, 0, 0, 0, 0};
+
+static int ring_webview_pool_add(void)
+{
+	const char *cError = NULL;
+	RingWebView *pRingWebView =
+		ring_webview_new(oRingWebViewPool.pRingState, oRingWebViewPool.bDebug, NULL, 0, 1, &cError);
+	if (!pRingWebView)
+		return 0;
+	webview_set_html(pRingWebView->webview, "");
+	oRingWebViewPool.aIdle[oRingWebViewPool.nIdle++] = pRingWebView;
+	return 1;
+}
+
+static gboolean ring_webview_pool_refill(gpointer user_data)
+{
+	(void)user_data;
+	// One webview per idle pass, so a refill never holds up a window being shown.
+	if (oRingWebViewPool.nIdle < oRingWebViewPool.nTarget && ring_webview_pool_add() &&
+		oRingWebViewPool.nIdle < oRingWebViewPool.nTarget)
+		return G_SOURCE_CONTINUE;
+	oRingWebViewPool.nRefillSource = 0;
+	return G_SOURCE_REMOVE;
+}
+
+static void ring_webview_pool_drain(void)
+{
+	if (oRingWebViewPool.nRefillSource)
+	{
+		g_source_remove(oRingWebViewPool.nRefillSource);
+		oRingWebViewPool.nRefillSource = 0;
+	}
+	while (oRingWebViewPool.nIdle)
+	{
+		RingWebView *pRingWebView = oRingWebViewPool.aIdle[--oRingWebViewPool.nIdle];
+		ring_webview_free(oRingWebViewPool.pRingState, pRingWebView);
+	}
+	oRingWebViewPool.nTarget = 0;
+}
+
+// Returns a pooled webview with its window shown, or NULL if none matches.
+static RingWebView *ring_webview_pool_take(int bDebug)
+{
+	if (oRingWebViewPool.nTarget == 0)
+		return NULL;
+	if (oRingWebViewPool.nIdle == 0 || oRingWebViewPool.bDebug != bDebug)
+	{
+		oRingWebViewPool.nMisses++;
+		return NULL;
+	}
+	RingWebView *pRingWebView = oRingWebViewPool.aIdle[--oRingWebViewPool.nIdle];
+	oRingWebViewPool.nHits++;
+	gtk_window_present(GTK_WINDOW(pRingWebView->pOwnedWindow));
+	if (!oRingWebViewPool.nRefillSource)
+		oRingWebViewPool.nRefillSource = g_idle_add(ring_webview_pool_refill, NULL);
+	return pRingWebView;
+}
+#endif
+
+RING_FUNC(ring_webview_create)
+{
+	if (RING_API_PARACOUNT < 2 || RING_API_PARACOUNT > 3)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISNUMBER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	void *pWindow = NULL;
+	if (RING_API_ISPOINTER(2))
+	{
+		pWindow = RING_API_GETCPOINTER(2, "void");
+	}
+
+	int bHeadless = 0;
+	if (RING_API_PARACOUNT == 3)
+	{
+		if (!RING_API_ISNUMBER(3))
+		{
+			RING_API_ERROR(RING_API_BADPARATYPE);
+			return;
+		}
+		bHeadless = (int)RING_API_GETNUMBER(3) != 0;
+	}
+	if (bHeadless && pWindow != NULL)
+	{
+		RING_API_ERROR("A headless webview can't use an existing window");
+		return;
+	}
+
+	int bDebug = (int)RING_API_GETNUMBER(1);
+	RingWebView *pRingWebView = NULL;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	if (!bHeadless && pWindow == NULL)
+		pRingWebView = ring_webview_pool_take(bDebug);
+#endif
+	if (pRingWebView == NULL)
+	{
+		const char *cError = NULL;
+		pRingWebView = ring_webview_new(RING_API_STATE, bDebug, pWindow, bHeadless, 0, &cError);
+		if (pRingWebView == NULL)
+		{
+			RING_API_ERROR(cError);
+			return;
+		}
+	}
+
+	RING_API_RETMANAGEDCPOINTER(pRingWebView, "webview_t", ring_webview_free);
+}
+
+RING_FUNC(ring_webview_set_process_options)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISNUMBER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	int nProcessModel = (int)RING_API_GETNUMBER(1);
+	int nCacheModel = (int)RING_API_GETNUMBER(2);
+	if (nProcessModel < -1 || nProcessModel > RING_WEBVIEW_PROCESS_MODEL_SHARED)
+	{
+		RING_API_ERROR("Invalid process model");
+		return;
+	}
+	if (nCacheModel < -1 || nCacheModel > RING_WEBVIEW_CACHE_MODEL_DOCUMENT_BROWSER)
+	{
+		RING_API_ERROR("Invalid cache model");
+		return;
+	}
+	if (oRingWebViewProcessOptions.bStarted && nProcessModel != -1 &&
+		nProcessModel != oRingWebViewProcessOptions.nStartedProcessModel)
+	{
+		RING_API_ERROR("The process model can't change after the first webview is created");
+		return;
+	}
+
+	if (nProcessModel != -1)
+		oRingWebViewProcessOptions.nProcessModel = nProcessModel;
+	oRingWebViewProcessOptions.nCacheModel = nCacheModel;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	// The cache model can change at any time.
+	if (oRingWebViewProcessOptions.bStarted)
+		ring_webview_apply_cache_model();
+#endif
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_set_memory_pressure)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISLIST(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebViewMemoryPressure oPressure;
+	const char *cError = ring_webview_parse_memory_pressure(RING_API_GETLIST(1), &oPressure);
+	if (cError)
+	{
+		RING_API_ERROR(cError);
+		return;
+	}
+	if (oRingWebViewProcessOptions.bStarted)
+	{
+		// Passing the settings already in use again, as every new WebView does, is fine.
+		RingWebViewMemoryPressure *pCurrent = &oRingWebViewProcessOptions.oMemoryPressure;
+		if (!pCurrent->bSet || oPressure.nLimitMb != pCurrent->nLimitMb ||
+			oPressure.nConservative != pCurrent->nConservative || oPressure.nStrict != pCurrent->nStrict ||
+			oPressure.nKill != pCurrent->nKill || oPressure.nPollInterval != pCurrent->nPollInterval)
+		{
+			RING_API_ERROR("Memory pressure settings can't change after the first webview is created");
+			return;
+		}
+		RING_API_RETNUMBER(1);
+		return;
+	}
+	oRingWebViewProcessOptions.oMemoryPressure = oPressure;
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_process_memory)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+
+	RingWebViewProcessInfo aProcesses[RING_WEBVIEW_PROCESS_MAX];
+	int nCount = ring_webview_process_list(aProcesses, RING_WEBVIEW_PROCESS_MAX);
+	List *pList = RING_API_NEWLIST;
+	for (int i = 0; i < nCount; i++)
+	{
+		List *pItem = ring_list_newlist_gc(((VM *)pPointer)->pRingState, pList);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, (double)aProcesses[i].nPid);
+		ring_list_addstring_gc(((VM *)pPointer)->pRingState, pItem, aProcesses[i].cKind);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, aProcesses[i].nRssKb);
+		ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pItem, aProcesses[i].nCpuMs);
+	}
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_pool_prewarm)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISNUMBER(1) || !RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	int nCount = (int)RING_API_GETNUMBER(1);
+	if (nCount < 0 || nCount > RING_WEBVIEW_POOL_MAX)
+	{
+		RING_API_ERROR("Pool size must be between 0 and 8");
+		return;
+	}
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	int bDebug = (int)RING_API_GETNUMBER(2);
+	if (oRingWebViewPool.nIdle && oRingWebViewPool.bDebug != bDebug)
+		ring_webview_pool_drain();
+	// Shrinking drops the newest idle webviews first.
+	while (oRingWebViewPool.nIdle > (unsigned int)nCount)
+		ring_webview_free(oRingWebViewPool.pRingState, oRingWebViewPool.aIdle[--oRingWebViewPool.nIdle]);
+	oRingWebViewPool.pRingState = RING_API_STATE;
+	oRingWebViewPool.bDebug = bDebug;
+	oRingWebViewPool.nTarget = (unsigned int)nCount;
+	while (oRingWebViewPool.nIdle < oRingWebViewPool.nTarget)
+	{
+		if (!ring_webview_pool_add())
+		{
+			RING_API_ERROR("Failed to create pooled webview (is a display available?)");
+			return;
+		}
+	}
+	RING_API_RETNUMBER(oRingWebViewPool.nIdle);
+	return;
+#endif
+
+	RING_API_RETNUMBER(0);
+}
+
+RING_FUNC(ring_webview_pool_clear)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+#ifdef WEBVIEW_PLATFORM_UNIX
+	ring_webview_pool_drain();
+#endif
+	RING_API_RETNUMBER(1);
+}
+
+RING_FUNC(ring_webview_pool_stats)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+
+	List *pList = RING_API_NEWLIST;
+	double nTarget = 0, nIdle = 0, nReady = 0, nHits = 0, nMisses = 0;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	nTarget = oRingWebViewPool.nTarget;
+	nIdle = oRingWebViewPool.nIdle;
+	nHits = oRingWebViewPool.nHits;
+	nMisses = oRingWebViewPool.nMisses;
+	for (unsigned int i = 0; i < oRingWebViewPool.nIdle; i++)
+	{
+		WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(
+			oRingWebViewPool.aIdle[i]->webview, WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+		if (web_view && !webkit_web_view_is_loading(web_view))
+			nReady++;
+	}
+#endif
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nTarget);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nIdle);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nReady);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nHits);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nMisses);
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_workers_start)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISNUMBER(1) || !RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (oRingWebViewWorkers.nThreads)
+	{
+		RING_API_ERROR("The worker pool is already running; call webview_workers_stop() first");
+		return;
+	}
+	int nThreads = (int)RING_API_GETNUMBER(1);
+	if (nThreads < 1 || nThreads > RING_WEBVIEW_WORKERS_MAX)
+	{
+		RING_API_ERROR("The number of workers must be between 1 and 32");
+		return;
+	}
+
+	ring_webview_workers_init_sync();
+	oRingWebViewWorkers.cFile = ring_webview_worker_strdup(RING_API_GETSTRING(2));
+	if (!oRingWebViewWorkers.cFile)
+	{
+		RING_API_ERROR(RING_OOM);
+		return;
+	}
+	oRingWebViewWorkers.nMaxQueued = 0;
+	oRingWebViewWorkers.nCompleted = 0;
+	oRingWebViewWorkers.nFailed = 0;
+	oRingWebViewWorkers.nBusyMs = 0;
+	oRingWebViewWorkers.nStartMs = ring_webview_now_ms();
+
+	// Workers look themselves up by Ring state, so the count is raised before each starts.
+	for (int i = 0; i < nThreads; i++)
+	{
+		oRingWebViewWorkers.nThreads = i + 1;
+		if (!ring_webview_thread_create(&oRingWebViewWorkers.aWorkers[i].oThread, ring_webview_worker_main,
+										&oRingWebViewWorkers.aWorkers[i]))
+		{
+			oRingWebViewWorkers.nThreads = i;
+			break;
+		}
+	}
+	if (!oRingWebViewWorkers.nThreads)
+	{
+		free(oRingWebViewWorkers.cFile);
+		oRingWebViewWorkers.cFile = NULL;
+	}
+	RING_API_RETNUMBER(oRingWebViewWorkers.nThreads);
+}
+
+RING_FUNC(ring_webview_workers_stop)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+	ring_webview_workers_shutdown();
+}
+
+RING_FUNC(ring_webview_worker_stats)
+{
+	if (RING_API_PARACOUNT != 0)
+	{
+		RING_API_ERROR(RING_API_BADPARACOUNT);
+		return;
+	}
+	List *pList = RING_API_NEWLIST;
+	double nQueued = 0, nMaxQueued = 0, nRunning = 0, nCompleted = 0, nFailed = 0, nUtilization = 0;
+	if (oRingWebViewWorkers.bMutexReady)
+	{
+		ring_webview_mutex_lock(&oRingWebViewWorkers.oMutex);
+		double nNow = ring_webview_now_ms();
+		// Busy time of the jobs still running counts up to now.
+		double nBusyMs = oRingWebViewWorkers.nBusyMs;
+		for (int i = 0; i < oRingWebViewWorkers.nThreads; i++)
+		{
+			if (oRingWebViewWorkers.aWorkers[i].pJob)
+				nBusyMs += nNow - oRingWebViewWorkers.aWorkers[i].nJobStartMs;
+		}
+		double nCapacityMs = oRingWebViewWorkers.nThreads * (nNow - oRingWebViewWorkers.nStartMs);
+		if (nCapacityMs > 0)
+			nUtilization = nBusyMs / nCapacityMs;
+		nQueued = oRingWebViewWorkers.nQueued;
+		nMaxQueued = oRingWebViewWorkers.nMaxQueued;
+		nRunning = oRingWebViewWorkers.nRunning;
+		nCompleted = oRingWebViewWorkers.nCompleted;
+		nFailed = oRingWebViewWorkers.nFailed;
+		ring_webview_mutex_unlock(&oRingWebViewWorkers.oMutex);
+	}
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, oRingWebViewWorkers.nThreads);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nQueued);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nMaxQueued);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nRunning);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nCompleted);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nFailed);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nUtilization);
+	RING_API_RETLIST(pList);
+}
+
+RING_FUNC(ring_webview_destroy)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	ring_webview_destroy_internal(pRingWebView);
+	RING_API_SETNULLPOINTER(1);
+}
+
+RING_FUNC(ring_webview_run)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	pRingWebView->bRunning = 1;
+	pRingWebView->bStopped = 0;
+	webview_run(pRingWebView->webview);
+}
+
+RING_FUNC(ring_webview_terminate)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	pRingWebView->bStopped = 1;
+	webview_terminate(pRingWebView->webview);
+}
+
+RING_FUNC(ring_webview_get_window)
+{
+	if (RING_API_PARACOUNT != 1)
+	{
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RING_API_RETCPOINTER(webview_get_window(pRingWebView->webview), "void");
+}
+
+RING_FUNC(ring_webview_get_native_handle)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RING_API_RETCPOINTER(
+		webview_get_native_handle(pRingWebView->webview, (webview_native_handle_kind_t)(int)RING_API_GETNUMBER(2)),
+		"void");
+}
+
+RING_FUNC(ring_webview_set_title)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	webview_set_title(pRingWebView->webview, RING_API_GETSTRING(2));
+}
+
+RING_FUNC(ring_webview_set_size)
+{
+	if (RING_API_PARACOUNT != 4)
+	{
+		RING_API_ERROR(RING_API_MISS4PARA);
+		return;
+	}
+	if (!RING_API_ISNUMBER(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (!RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (!RING_API_ISNUMBER(4))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+#ifdef WEBVIEW_PLATFORM_UNIX
+	if (pRingWebView->bHeadless)
+	{
+		// Size hints only matter to a window manager; just resize the viewport.
+		if ((int)RING_API_GETNUMBER(4) == WEBVIEW_HINT_NONE || (int)RING_API_GETNUMBER(4) == WEBVIEW_HINT_FIXED)
+			ring_webview_headless_allocate(pRingWebView, (int)RING_API_GETNUMBER(2), (int)RING_API_GETNUMBER(3));
+		return;
+	}
+	// getSize() asks GTK until the new size has been laid out.
+	if ((int)RING_API_GETNUMBER(4) == WEBVIEW_HINT_NONE || (int)RING_API_GETNUMBER(4) == WEBVIEW_HINT_FIXED)
+		pRingWebView->oGeometry.bKnown = 0;
+#endif
+	webview_set_size(pRingWebView->webview, (int)RING_API_GETNUMBER(2), (int)RING_API_GETNUMBER(3),
+					 (webview_hint_t)(int)RING_API_GETNUMBER(4));
+}
+
+RING_FUNC(ring_webview_navigate)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	webview_navigate(pRingWebView->webview, RING_API_GETSTRING(2));
+}
+
+RING_FUNC(ring_webview_set_html)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	webview_set_html(pRingWebView->webview, RING_API_GETSTRING(2));
+}
+
+RING_FUNC(ring_webview_init)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	webview_init(pRingWebView->webview, RING_API_GETSTRING(2));
+}
+
+RING_FUNC(ring_webview_eval)
+{
+	if (RING_API_PARACOUNT != 2)
+	{
+		RING_API_ERROR(RING_API_MISS2PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	double nTrace = ring_webview_trace_begin();
+	ring_webview_record(RING_WEBVIEW_RECORD_EVAL, RING_API_GETSTRING(2), NULL, NULL, 0);
+	webview_eval(pRingWebView->webview, RING_API_GETSTRING(2));
+	ring_webview_trace_end("eval", "eval", nTrace);
+}
+
+RING_FUNC(ring_webview_return)
+{
+	if (RING_API_PARACOUNT != 4)
+	{
+		RING_API_ERROR(RING_API_MISS4PARA);
+		return;
+	}
+	if (!RING_API_ISSTRING(2))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	if (!RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (pRingWebView == NULL)
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	// The caller already gave up on this call; don't encode or deliver the result.
+	if (ring_webview_drop_late_return(pRingWebView, RING_API_GETSTRING(2)))
+	{
+		return;
+	}
+
+	const char *cJson;
+	char *cJsonOwned = NULL;
+	if (RING_API_ISLIST(4))
+	{
+		cJsonOwned = ring_list_to_json_string(RING_API_STATE, RING_API_GETLIST(4));
+		if (!cJsonOwned)
+		{
+			RING_API_ERROR("Failed to generate JSON string from list.");
+			return;
+		}
+		cJson = cJsonOwned;
+	}
+	else if (RING_API_ISNUMBER(4))
+	{
+		cJsonOwned = ring_number_to_json_string(RING_API_GETNUMBER(4));
+		if (!cJsonOwned)
+		{
+			RING_API_ERROR("Failed to generate JSON number.");
+			return;
+		}
+		cJson = cJsonOwned;
 	}
-
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	else if (RING_API_ISSTRING(4))
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
-		return;
+		cJson = RING_API_GETSTRING(4);
 	}
-
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+	else
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	const char *js_name = RING_API_GETSTRING(2);
-
-	webview_error_t result = webview_unbind(pRingWebView->webview, js_name);
-	RING_API_RETNUMBER(result);
-}
 
-RING_FUNC(ring_webview_version)
-{
-	if (RING_API_PARACOUNT != 0)
+	webview_return(pRingWebView->webview, RING_API_GETSTRING(2), (int)RING_API_GETNUMBER(3), cJson);
+	ring_webview_record(RING_WEBVIEW_RECORD_RETURN, RING_API_GETSTRING(2), NULL, cJson, (int)RING_API_GETNUMBER(3));
+	ring_webview_finish_call(pRingWebView, RING_API_GETSTRING(2), (int)RING_API_GETNUMBER(3), cJson);
+	if (cJsonOwned)
 	{
-		RING_API_ERROR(RING_API_BADPARACOUNT);
-		return;
+		free(cJsonOwned);
 	}
-	RING_API_RETSTRING(WEBVIEW_VERSION_NUMBER);
 }
 
-RING_FUNC(ring_webview_create)
+/* ============================================================================
+ * Window Management Functions
+ * ============================================================================ */
+
+RING_FUNC(ring_webview_set_decorated)
 {
 	if (RING_API_PARACOUNT != 2)
 	{
 		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISNUMBER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
-	void *pWindow = NULL;
-	if (RING_API_ISPOINTER(2))
-	{
-		pWindow = RING_API_GETCPOINTER(2, "void");
-	}
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	int decorated = (int)RING_API_GETNUMBER(2);
 
-	RingWebView *pRingWebView;
-	pRingWebView = (RingWebView *)RING_API_MALLOC(sizeof(RingWebView));
-	if (pRingWebView == NULL)
+	if (!pRingWebView || !pRingWebView->webview)
 	{
-		RING_API_ERROR(RING_OOM);
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-	pRingWebView->webview = webview_create((int)RING_API_GETNUMBER(1), pWindow);
-	if (pRingWebView->webview == NULL)
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
+	if (hwnd)
 	{
-		RING_API_FREE(pRingWebView);
-		RING_API_ERROR("Failed to create webview instance");
+		LONG style = GetWindowLong(hwnd, GWL_STYLE);
+		if (decorated)
+		{
+			style |= (WS_CAPTION | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX | WS_SYSMENU);
+			style &= ~WS_POPUP;
+		}
+		else
+		{
+			style &= ~(WS_CAPTION | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX | WS_SYSMENU);
+			style |= WS_POPUP;
+		}
+		SetWindowLong(hwnd, GWL_STYLE, style);
+		SetWindowPos(hwnd, NULL, 0, 0, 0, 0, SWP_FRAMECHANGED | SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	pRingWebView->pMainRingState = RING_API_STATE;
-	pRingWebView->bRunning = 0;
-	pRingWebView->cOnClose = NULL;
-	pRingWebView->cOnResize = NULL;
-	pRingWebView->cOnFocus = NULL;
-	pRingWebView->cOnDomReady = NULL;
-	pRingWebView->cOnLoad = NULL;
-	pRingWebView->cOnNavigate = NULL;
-	pRingWebView->cOnTitle = NULL;
-
-#ifdef WEBVIEW_PLATFORM_UNIX
-	ring_webview_setup_drag_handler(pRingWebView);
-	ring_webview_setup_event_handlers(pRingWebView);
 #endif
 
-	RING_API_RETMANAGEDCPOINTER(pRingWebView, "webview_t", ring_webview_free);
-}
-
-RING_FUNC(ring_webview_destroy)
-{
-	if (RING_API_PARACOUNT != 1)
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		gtk_window_set_decorated(window, decorated ? TRUE : FALSE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
+#endif
 
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+#ifdef WEBVIEW_PLATFORM_MACOS
+	if (ring_webview_macos_set_decorated(pRingWebView->webview, decorated))
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	ring_webview_destroy_internal(pRingWebView);
-	RING_API_SETNULLPOINTER(1);
+#endif
+
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_run)
+RING_FUNC(ring_webview_set_opacity)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	pRingWebView->bRunning = 1;
-	webview_run(pRingWebView->webview);
-}
 
-RING_FUNC(ring_webview_terminate)
-{
-	if (RING_API_PARACOUNT != 1)
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	double opacity = RING_API_GETNUMBER(2);
+
+	if (!pRingWebView || !pRingWebView->webview)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+
+	if (opacity < 0.0)
+		opacity = 0.0;
+	if (opacity > 1.0)
+		opacity = 1.0;
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
+	if (hwnd)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		LONG exStyle = GetWindowLong(hwnd, GWL_EXSTYLE);
+		SetWindowLong(hwnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
+		BYTE alpha = (BYTE)(opacity * 255);
+		SetLayeredWindowAttributes(hwnd, 0, alpha, LWA_ALPHA);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	webview_terminate(pRingWebView->webview);
-}
+#endif
 
-RING_FUNC(ring_webview_get_window)
-{
-	if (RING_API_PARACOUNT != 1)
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		gtk_widget_set_opacity(GTK_WIDGET(window), opacity);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+#endif
+
+#ifdef WEBVIEW_PLATFORM_MACOS
+	if (ring_webview_macos_set_opacity(pRingWebView->webview, opacity))
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	RING_API_RETCPOINTER(webview_get_window(pRingWebView->webview), "void");
+#endif
+
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_get_native_handle)
+RING_FUNC(ring_webview_set_always_on_top)
 {
 	if (RING_API_PARACOUNT != 2)
 	{
 		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISNUMBER(2))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
+
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
-	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
-		return;
-	}
-	RING_API_RETCPOINTER(
-		webview_get_native_handle(pRingWebView->webview, (webview_native_handle_kind_t)(int)RING_API_GETNUMBER(2)),
-		"void");
-}
+	int onTop = (int)RING_API_GETNUMBER(2);
 
-RING_FUNC(ring_webview_set_title)
-{
-	if (RING_API_PARACOUNT != 2)
+	if (!pRingWebView || !pRingWebView->webview)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-	if (!RING_API_ISSTRING(2))
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
+	if (hwnd)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		SetWindowPos(hwnd, onTop ? HWND_TOPMOST : HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+#endif
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	(void)pRingWebView;
+	(void)onTop;
+#endif
+
+#ifdef WEBVIEW_PLATFORM_MACOS
+	if (ring_webview_macos_set_always_on_top(pRingWebView->webview, onTop))
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	webview_set_title(pRingWebView->webview, RING_API_GETSTRING(2));
+#endif
+
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_size)
+RING_FUNC(ring_webview_minimize)
 {
-	if (RING_API_PARACOUNT != 4)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS4PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISNUMBER(2))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-	if (!RING_API_ISNUMBER(3))
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-	if (!RING_API_ISNUMBER(4))
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
+	if (hwnd)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		ShowWindow(hwnd, SW_MINIMIZE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+#endif
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		gtk_window_minimize(window);
+		if (pRingWebView->bLowMemory)
+			ring_webview_free_engine_memory(pRingWebView);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	webview_set_size(pRingWebView->webview, (int)RING_API_GETNUMBER(2), (int)RING_API_GETNUMBER(3),
-					 (webview_hint_t)(int)RING_API_GETNUMBER(4));
+#endif
+
+#ifdef WEBVIEW_PLATFORM_MACOS
+	if (ring_webview_macos_minimize(pRingWebView->webview))
+	{
+		RING_API_RETNUMBER(1);
+		return;
+	}
+#endif
+
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_navigate)
+RING_FUNC(ring_webview_maximize)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISSTRING(2))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
+
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+	if (!pRingWebView || !pRingWebView->webview)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-	webview_navigate(pRingWebView->webview, RING_API_GETSTRING(2));
-}
 
-RING_FUNC(ring_webview_set_html)
-{
-	if (RING_API_PARACOUNT != 2)
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
+	if (hwnd)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		ShowWindow(hwnd, SW_MAXIMIZE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	if (!RING_API_ISSTRING(2))
+#endif
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		gtk_window_maximize(window);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+#endif
+
+#ifdef WEBVIEW_PLATFORM_MACOS
+	if (ring_webview_macos_maximize(pRingWebView->webview))
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	webview_set_html(pRingWebView->webview, RING_API_GETSTRING(2));
+#endif
+
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_init)
+RING_FUNC(ring_webview_restore)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISSTRING(2))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
+
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+	if (!pRingWebView || !pRingWebView->webview)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-	webview_init(pRingWebView->webview, RING_API_GETSTRING(2));
-}
 
-RING_FUNC(ring_webview_eval)
-{
-	if (RING_API_PARACOUNT != 2)
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
+	if (hwnd)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		ShowWindow(hwnd, SW_RESTORE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	if (!RING_API_ISSTRING(2))
+#endif
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		gtk_window_unmaximize(window);
+		gtk_window_present(window);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+#endif
+
+#ifdef WEBVIEW_PLATFORM_MACOS
+	if (ring_webview_macos_restore(pRingWebView->webview))
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
-	webview_eval(pRingWebView->webview, RING_API_GETSTRING(2));
+#endif
+
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_return)
+RING_FUNC(ring_webview_is_maximized)
 {
-	if (RING_API_PARACOUNT != 4)
-	{
-		RING_API_ERROR(RING_API_MISS4PARA);
-		return;
-	}
-	if (!RING_API_ISSTRING(2))
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISNUMBER(3))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
+
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	if (pRingWebView == NULL)
+	if (!pRingWebView || !pRingWebView->webview)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
 
-	const char *cJson;
-	char *cJsonOwned = NULL;
-	if (RING_API_ISLIST(4))
-	{
-		cJsonOwned = ring_list_to_json_string(RING_API_STATE, RING_API_GETLIST(4));
-		if (!cJsonOwned)
-		{
-			RING_API_ERROR("Failed to generate JSON string from list.");
-			return;
-		}
-		cJson = cJsonOwned;
-	}
-	else if (RING_API_ISNUMBER(4))
-	{
-		cJsonOwned = ring_number_to_json_string(RING_API_GETNUMBER(4));
-		if (!cJsonOwned)
-		{
-			RING_API_ERROR("Failed to generate JSON number.");
-			return;
-		}
-		cJson = cJsonOwned;
-	}
-	else if (RING_API_ISSTRING(4))
-	{
-		cJson = RING_API_GETSTRING(4);
-	}
-	else
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
+	if (hwnd)
 	{
-		RING_API_ERROR(RING_API_BADPARATYPE);
+		RING_API_RETNUMBER(IsZoomed(hwnd) ? 1 : 0);
 		return;
 	}
+#endif
 
-	webview_return(pRingWebView->webview, RING_API_GETSTRING(2), (int)RING_API_GETNUMBER(3), cJson);
-	if (cJsonOwned)
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
 	{
-		free(cJsonOwned);
+		RING_API_RETNUMBER(gtk_window_is_maximized(window) ? 1 : 0);
+		return;
 	}
-}
+#endif
 
-/* ============================================================================
- * Window Management Functions
- * ============================================================================ */
+#ifdef WEBVIEW_PLATFORM_MACOS
+	RING_API_RETNUMBER(ring_webview_macos_is_maximized(pRingWebView->webview));
+	return;
+#endif
 
-RING_FUNC(ring_webview_set_decorated)
+	RING_API_RETNUMBER(0);
+}
+
+RING_FUNC(ring_webview_start_drag)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int decorated = (int)RING_API_GETNUMBER(2);
-
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
@@ -998,36 +7444,28 @@ RING_FUNC(ring_webview_set_decorated)
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		LONG style = GetWindowLong(hwnd, GWL_STYLE);
-		if (decorated)
-		{
-			style |= (WS_CAPTION | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX | WS_SYSMENU);
-			style &= ~WS_POPUP;
-		}
-		else
-		{
-			style &= ~(WS_CAPTION | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX | WS_SYSMENU);
-			style |= WS_POPUP;
-		}
-		SetWindowLong(hwnd, GWL_STYLE, style);
-		SetWindowPos(hwnd, NULL, 0, 0, 0, 0, SWP_FRAMECHANGED | SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER);
+		ReleaseCapture();
+		SendMessage(hwnd, WM_NCLBUTTONDOWN, HTCAPTION, 0);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
+	if (pRingWebView->bHasClickData && pRingWebView->pLastSurface)
 	{
-		gtk_window_set_decorated(window, decorated ? TRUE : FALSE);
+		gdk_toplevel_begin_move(GDK_TOPLEVEL(pRingWebView->pLastSurface), pRingWebView->pLastDevice,
+								pRingWebView->nLastButton, pRingWebView->dLastX, pRingWebView->dLastY,
+								pRingWebView->nLastTime);
 		RING_API_RETNUMBER(1);
 		return;
 	}
+	RING_API_RETNUMBER(0);
+	return;
 #endif
 
 #ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_set_decorated(pRingWebView->webview, decorated))
+	if (ring_webview_macos_start_drag(pRingWebView->webview))
 	{
 		RING_API_RETNUMBER(1);
 		return;
@@ -1037,21 +7475,22 @@ RING_FUNC(ring_webview_set_decorated)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_opacity)
+RING_FUNC(ring_webview_set_position)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 3)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS3PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	double opacity = RING_API_GETNUMBER(2);
+	int x = (int)RING_API_GETNUMBER(2);
+	int y = (int)RING_API_GETNUMBER(3);
 
 	if (!pRingWebView || !pRingWebView->webview)
 	{
@@ -1059,36 +7498,24 @@ RING_FUNC(ring_webview_set_opacity)
 		return;
 	}
 
-	if (opacity < 0.0)
-		opacity = 0.0;
-	if (opacity > 1.0)
-		opacity = 1.0;
-
 #ifdef WEBVIEW_PLATFORM_WINDOWS
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		LONG exStyle = GetWindowLong(hwnd, GWL_EXSTYLE);
-		SetWindowLong(hwnd, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
-		BYTE alpha = (BYTE)(opacity * 255);
-		SetLayeredWindowAttributes(hwnd, 0, alpha, LWA_ALPHA);
+		SetWindowPos(hwnd, NULL, x, y, 0, 0, SWP_NOSIZE | SWP_NOZORDER);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
-	{
-		gtk_widget_set_opacity(GTK_WIDGET(window), opacity);
-		RING_API_RETNUMBER(1);
-		return;
-	}
+	(void)pRingWebView;
+	(void)x;
+	(void)y;
 #endif
 
 #ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_set_opacity(pRingWebView->webview, opacity))
+	if (ring_webview_macos_set_position(pRingWebView->webview, x, y))
 	{
 		RING_API_RETNUMBER(1);
 		return;
@@ -1098,62 +7525,63 @@ RING_FUNC(ring_webview_set_opacity)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_always_on_top)
+RING_FUNC(ring_webview_get_position)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int onTop = (int)RING_API_GETNUMBER(2);
-
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
 
+	int x = 0, y = 0;
+
 #ifdef WEBVIEW_PLATFORM_WINDOWS
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		SetWindowPos(hwnd, onTop ? HWND_TOPMOST : HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
-		RING_API_RETNUMBER(1);
-		return;
+		RECT rect;
+		if (GetWindowRect(hwnd, &rect))
+		{
+			x = rect.left;
+			y = rect.top;
+		}
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_UNIX
 	(void)pRingWebView;
-	(void)onTop;
 #endif
 
 #ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_set_always_on_top(pRingWebView->webview, onTop))
-	{
-		RING_API_RETNUMBER(1);
-		return;
-	}
+	ring_webview_macos_get_position(pRingWebView->webview, &x, &y);
 #endif
 
-	RING_API_RETNUMBER(0);
+	List *pList = RING_API_NEWLIST;
+	ring_list_adddouble_gc(RING_API_STATE, pList, x);
+	ring_list_adddouble_gc(RING_API_STATE, pList, y);
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_webview_minimize)
+RING_FUNC(ring_webview_set_resize_interval)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
@@ -1165,39 +7593,17 @@ RING_FUNC(ring_webview_minimize)
 		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
-	if (hwnd)
-	{
-		ShowWindow(hwnd, SW_MINIMIZE);
-		RING_API_RETNUMBER(1);
-		return;
-	}
-#endif
-
-#ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
-	{
-		gtk_window_minimize(window);
-		RING_API_RETNUMBER(1);
-		return;
-	}
-#endif
-
-#ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_minimize(pRingWebView->webview))
+	if (RING_API_GETNUMBER(2) < 0)
 	{
-		RING_API_RETNUMBER(1);
+		RING_API_ERROR("The resize interval must be zero or a positive number of milliseconds");
 		return;
 	}
-#endif
-
-	RING_API_RETNUMBER(0);
+	// A change already held back keeps its timer.
+	pRingWebView->nResizeIntervalMs = (int)RING_API_GETNUMBER(2);
+	RING_API_RETNUMBER(1);
 }
 
-RING_FUNC(ring_webview_maximize)
+RING_FUNC(ring_webview_get_size)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -1217,38 +7623,50 @@ RING_FUNC(ring_webview_maximize)
 		return;
 	}
 
+	int width = 0, height = 0;
+
 #ifdef WEBVIEW_PLATFORM_WINDOWS
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		ShowWindow(hwnd, SW_MAXIMIZE);
-		RING_API_RETNUMBER(1);
-		return;
+		RECT rect;
+		if (GetWindowRect(hwnd, &rect))
+		{
+			width = rect.right - rect.left;
+			height = rect.bottom - rect.top;
+		}
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_UNIX
 	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
+	if (pRingWebView->oGeometry.bKnown)
 	{
-		gtk_window_maximize(window);
-		RING_API_RETNUMBER(1);
-		return;
+		width = pRingWebView->oGeometry.nWidth;
+		height = pRingWebView->oGeometry.nHeight;
+	}
+	else if (window)
+	{
+		gtk_window_get_default_size(window, &width, &height);
+		if (width <= 0 || height <= 0)
+		{
+			width = gtk_widget_get_width(GTK_WIDGET(window));
+			height = gtk_widget_get_height(GTK_WIDGET(window));
+		}
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_maximize(pRingWebView->webview))
-	{
-		RING_API_RETNUMBER(1);
-		return;
-	}
+	ring_webview_macos_get_size(pRingWebView->webview, &width, &height);
 #endif
 
-	RING_API_RETNUMBER(0);
+	List *pList = RING_API_NEWLIST;
+	ring_list_adddouble_gc(RING_API_STATE, pList, width);
+	ring_list_adddouble_gc(RING_API_STATE, pList, height);
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_webview_restore)
+RING_FUNC(ring_webview_focus)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -1272,7 +7690,8 @@ RING_FUNC(ring_webview_restore)
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		ShowWindow(hwnd, SW_RESTORE);
+		SetForegroundWindow(hwnd);
+		SetFocus(hwnd);
 		RING_API_RETNUMBER(1);
 		return;
 	}
@@ -1282,7 +7701,6 @@ RING_FUNC(ring_webview_restore)
 	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
 	if (window)
 	{
-		gtk_window_unmaximize(window);
 		gtk_window_present(window);
 		RING_API_RETNUMBER(1);
 		return;
@@ -1290,7 +7708,7 @@ RING_FUNC(ring_webview_restore)
 #endif
 
 #ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_restore(pRingWebView->webview))
+	if (ring_webview_macos_focus(pRingWebView->webview))
 	{
 		RING_API_RETNUMBER(1);
 		return;
@@ -1300,7 +7718,7 @@ RING_FUNC(ring_webview_restore)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_is_maximized)
+RING_FUNC(ring_webview_hide)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -1324,7 +7742,8 @@ RING_FUNC(ring_webview_is_maximized)
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		RING_API_RETNUMBER(IsZoomed(hwnd) ? 1 : 0);
+		ShowWindow(hwnd, SW_HIDE);
+		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
@@ -1333,20 +7752,26 @@ RING_FUNC(ring_webview_is_maximized)
 	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
 	if (window)
 	{
-		RING_API_RETNUMBER(gtk_window_is_maximized(window) ? 1 : 0);
+		gtk_widget_set_visible(GTK_WIDGET(window), FALSE);
+		if (pRingWebView->bLowMemory)
+			ring_webview_free_engine_memory(pRingWebView);
+		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_MACOS
-	RING_API_RETNUMBER(ring_webview_macos_is_maximized(pRingWebView->webview));
-	return;
+	if (ring_webview_macos_hide(pRingWebView->webview))
+	{
+		RING_API_RETNUMBER(1);
+		return;
+	}
 #endif
 
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_start_drag)
+RING_FUNC(ring_webview_show)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -1370,28 +7795,24 @@ RING_FUNC(ring_webview_start_drag)
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		ReleaseCapture();
-		SendMessage(hwnd, WM_NCLBUTTONDOWN, HTCAPTION, 0);
+		ShowWindow(hwnd, SW_SHOW);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	if (pRingWebView->bHasClickData && pRingWebView->pLastSurface)
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
 	{
-		gdk_toplevel_begin_move(GDK_TOPLEVEL(pRingWebView->pLastSurface), pRingWebView->pLastDevice,
-								pRingWebView->nLastButton, pRingWebView->dLastX, pRingWebView->dLastY,
-								pRingWebView->nLastTime);
+		gtk_widget_set_visible(GTK_WIDGET(window), TRUE);
 		RING_API_RETNUMBER(1);
 		return;
 	}
-	RING_API_RETNUMBER(0);
-	return;
 #endif
 
 #ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_start_drag(pRingWebView->webview))
+	if (ring_webview_macos_show(pRingWebView->webview))
 	{
 		RING_API_RETNUMBER(1);
 		return;
@@ -1401,22 +7822,21 @@ RING_FUNC(ring_webview_start_drag)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_position)
+RING_FUNC(ring_webview_start_resize)
 {
-	if (RING_API_PARACOUNT != 3)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int x = (int)RING_API_GETNUMBER(2);
-	int y = (int)RING_API_GETNUMBER(3);
+	int edge = (int)RING_API_GETNUMBER(2);
 
 	if (!pRingWebView || !pRingWebView->webview)
 	{
@@ -1428,79 +7848,165 @@ RING_FUNC(ring_webview_set_position)
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		SetWindowPos(hwnd, NULL, x, y, 0, 0, SWP_NOSIZE | SWP_NOZORDER);
+		WPARAM wParam = 0;
+		switch (edge)
+		{
+		case 1:
+			wParam = WMSZ_TOP;
+			break;
+		case 2:
+			wParam = WMSZ_BOTTOM;
+			break;
+		case 4:
+			wParam = WMSZ_LEFT;
+			break;
+		case 8:
+			wParam = WMSZ_RIGHT;
+			break;
+		case 6:
+			wParam = WMSZ_BOTTOMLEFT;
+			break;
+		case 10:
+			wParam = WMSZ_BOTTOMRIGHT;
+			break;
+		case 5:
+			wParam = WMSZ_TOPLEFT;
+			break;
+		case 9:
+			wParam = WMSZ_TOPRIGHT;
+			break;
+		default:
+			wParam = WMSZ_BOTTOMRIGHT;
+		}
+		ReleaseCapture();
+		SendMessage(hwnd, WM_SYSCOMMAND, SC_SIZE | wParam, 0);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	(void)pRingWebView;
-	(void)x;
-	(void)y;
-#endif
-
-#ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_set_position(pRingWebView->webview, x, y))
+	if (pRingWebView->bHasClickData && pRingWebView->pLastSurface)
 	{
+		GdkSurfaceEdge gdkEdge;
+		switch (edge)
+		{
+		case 1:
+			gdkEdge = GDK_SURFACE_EDGE_NORTH;
+			break;
+		case 2:
+			gdkEdge = GDK_SURFACE_EDGE_SOUTH;
+			break;
+		case 4:
+			gdkEdge = GDK_SURFACE_EDGE_WEST;
+			break;
+		case 8:
+			gdkEdge = GDK_SURFACE_EDGE_EAST;
+			break;
+		case 6:
+			gdkEdge = GDK_SURFACE_EDGE_SOUTH_WEST;
+			break;
+		case 10:
+			gdkEdge = GDK_SURFACE_EDGE_SOUTH_EAST;
+			break;
+		case 5:
+			gdkEdge = GDK_SURFACE_EDGE_NORTH_WEST;
+			break;
+		case 9:
+			gdkEdge = GDK_SURFACE_EDGE_NORTH_EAST;
+			break;
+		default:
+			gdkEdge = GDK_SURFACE_EDGE_SOUTH_EAST;
+		}
+		gdk_toplevel_begin_resize(GDK_TOPLEVEL(pRingWebView->pLastSurface), gdkEdge, pRingWebView->pLastDevice,
+								  pRingWebView->nLastButton, pRingWebView->dLastX, pRingWebView->dLastY,
+								  pRingWebView->nLastTime);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
+#ifdef WEBVIEW_PLATFORM_MACOS
+	(void)edge;
+#endif
+
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_get_position)
+RING_FUNC(ring_webview_set_fullscreen)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	int fullscreen = (int)RING_API_GETNUMBER(2);
+
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
 
-	int x = 0, y = 0;
-
 #ifdef WEBVIEW_PLATFORM_WINDOWS
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		RECT rect;
-		if (GetWindowRect(hwnd, &rect))
+		static WINDOWPLACEMENT g_wpPrev = {sizeof(g_wpPrev)};
+		static DWORD g_dwStyle = 0;
+		if (fullscreen)
 		{
-			x = rect.left;
-			y = rect.top;
+			MONITORINFO mi = {sizeof(mi)};
+			g_dwStyle = GetWindowLong(hwnd, GWL_STYLE);
+			if (GetWindowPlacement(hwnd, &g_wpPrev) &&
+				GetMonitorInfo(MonitorFromWindow(hwnd, MONITOR_DEFAULTTOPRIMARY), &mi))
+			{
+				SetWindowLong(hwnd, GWL_STYLE, g_dwStyle & ~WS_OVERLAPPEDWINDOW);
+				SetWindowPos(hwnd, HWND_TOP, mi.rcMonitor.left, mi.rcMonitor.top,
+							 mi.rcMonitor.right - mi.rcMonitor.left, mi.rcMonitor.bottom - mi.rcMonitor.top,
+							 SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
+			}
+		}
+		else
+		{
+			SetWindowLong(hwnd, GWL_STYLE, g_dwStyle);
+			SetWindowPlacement(hwnd, &g_wpPrev);
+			SetWindowPos(hwnd, NULL, 0, 0, 0, 0,
+						 SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
 		}
+		RING_API_RETNUMBER(1);
+		return;
+	}
+#endif
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
+	{
+		if (fullscreen)
+			gtk_window_fullscreen(window);
+		else
+			gtk_window_unfullscreen(window);
+		RING_API_RETNUMBER(1);
+		return;
 	}
 #endif
 
-#ifdef WEBVIEW_PLATFORM_UNIX
-	(void)pRingWebView;
-#endif
-
 #ifdef WEBVIEW_PLATFORM_MACOS
-	ring_webview_macos_get_position(pRingWebView->webview, &x, &y);
+	(void)fullscreen;
 #endif
 
-	List *pList = RING_API_NEWLIST;
-	ring_list_adddouble_gc(RING_API_STATE, pList, x);
-	ring_list_adddouble_gc(RING_API_STATE, pList, y);
-	RING_API_RETLIST(pList);
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_get_size)
+RING_FUNC(ring_webview_is_fullscreen)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -1520,58 +8026,34 @@ RING_FUNC(ring_webview_get_size)
 		return;
 	}
 
-	int width = 0, height = 0;
-
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
-	if (hwnd)
-	{
-		RECT rect;
-		if (GetWindowRect(hwnd, &rect))
-		{
-			width = rect.right - rect.left;
-			height = rect.bottom - rect.top;
-		}
-	}
-#endif
-
 #ifdef WEBVIEW_PLATFORM_UNIX
 	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
 	if (window)
 	{
-		gtk_window_get_default_size(window, &width, &height);
-		if (width <= 0 || height <= 0)
-		{
-			width = gtk_widget_get_width(GTK_WIDGET(window));
-			height = gtk_widget_get_height(GTK_WIDGET(window));
-		}
+		RING_API_RETNUMBER(gtk_window_is_fullscreen(window) ? 1 : 0);
+		return;
 	}
 #endif
 
-#ifdef WEBVIEW_PLATFORM_MACOS
-	ring_webview_macos_get_size(pRingWebView->webview, &width, &height);
-#endif
-
-	List *pList = RING_API_NEWLIST;
-	ring_list_adddouble_gc(RING_API_STATE, pList, width);
-	ring_list_adddouble_gc(RING_API_STATE, pList, height);
-	RING_API_RETLIST(pList);
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_focus)
+RING_FUNC(ring_webview_set_resizable)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	int resizable = (int)RING_API_GETNUMBER(2);
+
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
@@ -1582,8 +8064,12 @@ RING_FUNC(ring_webview_focus)
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		SetForegroundWindow(hwnd);
-		SetFocus(hwnd);
+		LONG style = GetWindowLong(hwnd, GWL_STYLE);
+		if (resizable)
+			style |= WS_THICKFRAME | WS_MAXIMIZEBOX;
+		else
+			style &= ~(WS_THICKFRAME | WS_MAXIMIZEBOX);
+		SetWindowLong(hwnd, GWL_STYLE, style);
 		RING_API_RETNUMBER(1);
 		return;
 	}
@@ -1593,24 +8079,20 @@ RING_FUNC(ring_webview_focus)
 	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
 	if (window)
 	{
-		gtk_window_present(window);
+		gtk_window_set_resizable(window, resizable ? TRUE : FALSE);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
 #ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_focus(pRingWebView->webview))
-	{
-		RING_API_RETNUMBER(1);
-		return;
-	}
+	(void)resizable;
 #endif
 
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_hide)
+RING_FUNC(ring_webview_is_resizable)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -1634,8 +8116,8 @@ RING_FUNC(ring_webview_hide)
 	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
 	if (hwnd)
 	{
-		ShowWindow(hwnd, SW_HIDE);
-		RING_API_RETNUMBER(1);
+		LONG style = GetWindowLong(hwnd, GWL_STYLE);
+		RING_API_RETNUMBER((style & WS_THICKFRAME) ? 1 : 0);
 		return;
 	}
 #endif
@@ -1644,89 +8126,99 @@ RING_FUNC(ring_webview_hide)
 	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
 	if (window)
 	{
-		gtk_widget_set_visible(GTK_WIDGET(window), FALSE);
-		RING_API_RETNUMBER(1);
-		return;
-	}
-#endif
-
-#ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_hide(pRingWebView->webview))
-	{
-		RING_API_RETNUMBER(1);
+		RING_API_RETNUMBER(gtk_window_get_resizable(window) ? 1 : 0);
 		return;
 	}
 #endif
 
-	RING_API_RETNUMBER(0);
+	RING_API_RETNUMBER(1);
 }
 
-RING_FUNC(ring_webview_show)
+RING_FUNC(ring_webview_set_min_size)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 3)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS3PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	int width = (int)RING_API_GETNUMBER(2);
+	int height = (int)RING_API_GETNUMBER(3);
+
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
-	if (hwnd)
+#ifdef WEBVIEW_PLATFORM_UNIX
+	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
+	if (window)
 	{
-		ShowWindow(hwnd, SW_SHOW);
+		gtk_widget_set_size_request(GTK_WIDGET(window), width, height);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
-#ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
+	(void)width;
+	(void)height;
+	RING_API_RETNUMBER(0);
+}
+
+RING_FUNC(ring_webview_set_max_size)
+{
+	if (RING_API_PARACOUNT != 3)
 	{
-		gtk_widget_set_visible(GTK_WIDGET(window), TRUE);
-		RING_API_RETNUMBER(1);
+		RING_API_ERROR(RING_API_MISS3PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
-#endif
 
-#ifdef WEBVIEW_PLATFORM_MACOS
-	if (ring_webview_macos_show(pRingWebView->webview))
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	int width = (int)RING_API_GETNUMBER(2);
+	int height = (int)RING_API_GETNUMBER(3);
+
+	if (!pRingWebView || !pRingWebView->webview)
 	{
-		RING_API_RETNUMBER(1);
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-#endif
 
+	(void)width;
+	(void)height;
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_start_resize)
+RING_FUNC(ring_webview_set_background_color)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 5)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR("Bad parameter count - expected 5 (webview, r, g, b, a)");
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3) || !RING_API_ISNUMBER(4) ||
+		!RING_API_ISNUMBER(5))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int edge = (int)RING_API_GETNUMBER(2);
+	int r = (int)RING_API_GETNUMBER(2);
+	int g = (int)RING_API_GETNUMBER(3);
+	int b = (int)RING_API_GETNUMBER(4);
+	int a = (int)RING_API_GETNUMBER(5);
 
 	if (!pRingWebView || !pRingWebView->webview)
 	{
@@ -1734,169 +8226,98 @@ RING_FUNC(ring_webview_start_resize)
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
-	if (hwnd)
+#ifdef WEBVIEW_PLATFORM_UNIX
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (web_view)
 	{
-		WPARAM wParam = 0;
-		switch (edge)
-		{
-		case 1:
-			wParam = WMSZ_TOP;
-			break;
-		case 2:
-			wParam = WMSZ_BOTTOM;
-			break;
-		case 4:
-			wParam = WMSZ_LEFT;
-			break;
-		case 8:
-			wParam = WMSZ_RIGHT;
-			break;
-		case 6:
-			wParam = WMSZ_BOTTOMLEFT;
-			break;
-		case 10:
-			wParam = WMSZ_BOTTOMRIGHT;
-			break;
-		case 5:
-			wParam = WMSZ_TOPLEFT;
-			break;
-		case 9:
-			wParam = WMSZ_TOPRIGHT;
-			break;
-		default:
-			wParam = WMSZ_BOTTOMRIGHT;
-		}
-		ReleaseCapture();
-		SendMessage(hwnd, WM_SYSCOMMAND, SC_SIZE | wParam, 0);
+		GdkRGBA color = {.red = r / 255.0f, .green = g / 255.0f, .blue = b / 255.0f, .alpha = a / 255.0f};
+		webkit_web_view_set_background_color(web_view, &color);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
-#ifdef WEBVIEW_PLATFORM_UNIX
-	if (pRingWebView->bHasClickData && pRingWebView->pLastSurface)
+	(void)r;
+	(void)g;
+	(void)b;
+	(void)a;
+	RING_API_RETNUMBER(0);
+}
+
+/* ============================================================================
+ * Navigation & WebView Features
+ * ============================================================================ */
+
+RING_FUNC(ring_webview_back)
+{
+	if (RING_API_PARACOUNT != 1)
 	{
-		GdkSurfaceEdge gdkEdge;
-		switch (edge)
-		{
-		case 1:
-			gdkEdge = GDK_SURFACE_EDGE_NORTH;
-			break;
-		case 2:
-			gdkEdge = GDK_SURFACE_EDGE_SOUTH;
-			break;
-		case 4:
-			gdkEdge = GDK_SURFACE_EDGE_WEST;
-			break;
-		case 8:
-			gdkEdge = GDK_SURFACE_EDGE_EAST;
-			break;
-		case 6:
-			gdkEdge = GDK_SURFACE_EDGE_SOUTH_WEST;
-			break;
-		case 10:
-			gdkEdge = GDK_SURFACE_EDGE_SOUTH_EAST;
-			break;
-		case 5:
-			gdkEdge = GDK_SURFACE_EDGE_NORTH_WEST;
-			break;
-		case 9:
-			gdkEdge = GDK_SURFACE_EDGE_NORTH_EAST;
-			break;
-		default:
-			gdkEdge = GDK_SURFACE_EDGE_SOUTH_EAST;
-		}
-		gdk_toplevel_begin_resize(GDK_TOPLEVEL(pRingWebView->pLastSurface), gdkEdge, pRingWebView->pLastDevice,
-								  pRingWebView->nLastButton, pRingWebView->dLastX, pRingWebView->dLastY,
-								  pRingWebView->nLastTime);
-		RING_API_RETNUMBER(1);
+		RING_API_ERROR(RING_API_MISS1PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
-#endif
 
-#ifdef WEBVIEW_PLATFORM_MACOS
-	(void)edge;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (web_view)
+	{
+		webkit_web_view_go_back(web_view);
+		RING_API_RETNUMBER(1);
+		return;
+	}
 #endif
 
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_fullscreen)
+RING_FUNC(ring_webview_forward)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int fullscreen = (int)RING_API_GETNUMBER(2);
-
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
-	if (hwnd)
-	{
-		static WINDOWPLACEMENT g_wpPrev = {sizeof(g_wpPrev)};
-		static DWORD g_dwStyle = 0;
-		if (fullscreen)
-		{
-			MONITORINFO mi = {sizeof(mi)};
-			g_dwStyle = GetWindowLong(hwnd, GWL_STYLE);
-			if (GetWindowPlacement(hwnd, &g_wpPrev) &&
-				GetMonitorInfo(MonitorFromWindow(hwnd, MONITOR_DEFAULTTOPRIMARY), &mi))
-			{
-				SetWindowLong(hwnd, GWL_STYLE, g_dwStyle & ~WS_OVERLAPPEDWINDOW);
-				SetWindowPos(hwnd, HWND_TOP, mi.rcMonitor.left, mi.rcMonitor.top,
-							 mi.rcMonitor.right - mi.rcMonitor.left, mi.rcMonitor.bottom - mi.rcMonitor.top,
-							 SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
-			}
-		}
-		else
-		{
-			SetWindowLong(hwnd, GWL_STYLE, g_dwStyle);
-			SetWindowPlacement(hwnd, &g_wpPrev);
-			SetWindowPos(hwnd, NULL, 0, 0, 0, 0,
-						 SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
-		}
-		RING_API_RETNUMBER(1);
-		return;
-	}
-#endif
-
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (web_view)
 	{
-		if (fullscreen)
-			gtk_window_fullscreen(window);
-		else
-			gtk_window_unfullscreen(window);
+		webkit_web_view_go_forward(web_view);
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
-#ifdef WEBVIEW_PLATFORM_MACOS
-	(void)fullscreen;
-#endif
-
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_is_fullscreen)
+RING_FUNC(ring_webview_reload)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -1917,10 +8338,12 @@ RING_FUNC(ring_webview_is_fullscreen)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (web_view)
 	{
-		RING_API_RETNUMBER(gtk_window_is_fullscreen(window) ? 1 : 0);
+		webkit_web_view_reload(web_view);
+		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
@@ -1928,7 +8351,7 @@ RING_FUNC(ring_webview_is_fullscreen)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_resizable)
+RING_FUNC(ring_webview_set_dev_tools)
 {
 	if (RING_API_PARACOUNT != 2)
 	{
@@ -1942,7 +8365,7 @@ RING_FUNC(ring_webview_set_resizable)
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int resizable = (int)RING_API_GETNUMBER(2);
+	int enabled = (int)RING_API_GETNUMBER(2);
 
 	if (!pRingWebView || !pRingWebView->webview)
 	{
@@ -1950,39 +8373,33 @@ RING_FUNC(ring_webview_set_resizable)
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
-	if (hwnd)
-	{
-		LONG style = GetWindowLong(hwnd, GWL_STYLE);
-		if (resizable)
-			style |= WS_THICKFRAME | WS_MAXIMIZEBOX;
-		else
-			style &= ~(WS_THICKFRAME | WS_MAXIMIZEBOX);
-		SetWindowLong(hwnd, GWL_STYLE, style);
-		RING_API_RETNUMBER(1);
-		return;
-	}
-#endif
-
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (web_view)
 	{
-		gtk_window_set_resizable(window, resizable ? TRUE : FALSE);
+		WebKitSettings *settings = webkit_web_view_get_settings(web_view);
+		webkit_settings_set_enable_developer_extras(settings, enabled ? TRUE : FALSE);
+		if (enabled)
+		{
+			WebKitWebInspector *inspector = webkit_web_view_get_inspector(web_view);
+			webkit_web_inspector_show(inspector);
+		}
+		else
+		{
+			WebKitWebInspector *inspector = webkit_web_view_get_inspector(web_view);
+			webkit_web_inspector_close(inspector);
+		}
 		RING_API_RETNUMBER(1);
 		return;
 	}
 #endif
 
-#ifdef WEBVIEW_PLATFORM_MACOS
-	(void)resizable;
-#endif
-
+	(void)enabled;
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_is_resizable)
+RING_FUNC(ring_webview_get_url)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -2002,45 +8419,37 @@ RING_FUNC(ring_webview_is_resizable)
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = ring_webview_get_hwnd(pRingWebView);
-	if (hwnd)
-	{
-		LONG style = GetWindowLong(hwnd, GWL_STYLE);
-		RING_API_RETNUMBER((style & WS_THICKFRAME) ? 1 : 0);
-		return;
-	}
-#endif
-
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (web_view)
 	{
-		RING_API_RETNUMBER(gtk_window_get_resizable(window) ? 1 : 0);
-		return;
+		const char *uri = webkit_web_view_get_uri(web_view);
+		if (uri)
+		{
+			RING_API_RETSTRING(uri);
+			return;
+		}
 	}
 #endif
 
-	RING_API_RETNUMBER(1);
+	RING_API_RETSTRING("");
 }
 
-RING_FUNC(ring_webview_set_min_size)
+RING_FUNC(ring_webview_get_title)
 {
-	if (RING_API_PARACOUNT != 3)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int width = (int)RING_API_GETNUMBER(2);
-	int height = (int)RING_API_GETNUMBER(3);
-
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
@@ -2048,36 +8457,37 @@ RING_FUNC(ring_webview_set_min_size)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window = ring_webview_get_gtk_window(pRingWebView);
-	if (window)
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (web_view)
 	{
-		gtk_widget_set_size_request(GTK_WIDGET(window), width, height);
-		RING_API_RETNUMBER(1);
-		return;
+		const char *title = webkit_web_view_get_title(web_view);
+		if (title)
+		{
+			RING_API_RETSTRING(title);
+			return;
+		}
 	}
 #endif
 
-	(void)width;
-	(void)height;
-	RING_API_RETNUMBER(0);
+	RING_API_RETSTRING("");
 }
 
-RING_FUNC(ring_webview_set_max_size)
+RING_FUNC(ring_webview_set_context_menu)
 {
-	if (RING_API_PARACOUNT != 3)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS3PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int width = (int)RING_API_GETNUMBER(2);
-	int height = (int)RING_API_GETNUMBER(3);
+	int enabled = (int)RING_API_GETNUMBER(2);
 
 	if (!pRingWebView || !pRingWebView->webview)
 	{
@@ -2085,30 +8495,47 @@ RING_FUNC(ring_webview_set_max_size)
 		return;
 	}
 
-	(void)width;
-	(void)height;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	if (web_view)
+	{
+		static gulong handler_id = 0;
+
+		if (!enabled && handler_id == 0)
+		{
+			handler_id =
+				g_signal_connect(web_view, "context-menu", G_CALLBACK(ring_webview_suppress_context_menu), NULL);
+		}
+		else if (enabled && handler_id != 0)
+		{
+			g_signal_handler_disconnect(web_view, handler_id);
+			handler_id = 0;
+		}
+		RING_API_RETNUMBER(1);
+		return;
+	}
+#endif
+
+	(void)enabled;
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_background_color)
+RING_FUNC(ring_webview_set_icon)
 {
-	if (RING_API_PARACOUNT != 5)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR("Bad parameter count - expected 5 (webview, r, g, b, a)");
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3) || !RING_API_ISNUMBER(4) ||
-		!RING_API_ISNUMBER(5))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int r = (int)RING_API_GETNUMBER(2);
-	int g = (int)RING_API_GETNUMBER(3);
-	int b = (int)RING_API_GETNUMBER(4);
-	int a = (int)RING_API_GETNUMBER(5);
+	const char *icon_path = RING_API_GETSTRING(2);
 
 	if (!pRingWebView || !pRingWebView->webview)
 	{
@@ -2117,29 +8544,46 @@ RING_FUNC(ring_webview_set_background_color)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	if (web_view)
+	GtkWindow *window =
+		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (window)
 	{
-		GdkRGBA color = {.red = r / 255.0f, .green = g / 255.0f, .blue = b / 255.0f, .alpha = a / 255.0f};
-		webkit_web_view_set_background_color(web_view, &color);
-		RING_API_RETNUMBER(1);
-		return;
+		GError *error = NULL;
+		GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(icon_path, &error);
+		if (pixbuf)
+		{
+			GdkTexture *texture = gdk_texture_new_for_pixbuf(pixbuf);
+			gtk_window_set_icon_name(window, NULL);
+			g_object_unref(pixbuf);
+			g_object_unref(texture);
+			RING_API_RETNUMBER(1);
+			return;
+		}
+		if (error)
+			g_error_free(error);
+	}
+#endif
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (hwnd)
+	{
+		HICON hIcon = (HICON)LoadImageA(NULL, icon_path, IMAGE_ICON, 0, 0, LR_LOADFROMFILE | LR_DEFAULTSIZE);
+		if (hIcon)
+		{
+			SendMessage(hwnd, WM_SETICON, ICON_BIG, (LPARAM)hIcon);
+			SendMessage(hwnd, WM_SETICON, ICON_SMALL, (LPARAM)hIcon);
+			RING_API_RETNUMBER(1);
+			return;
+		}
 	}
 #endif
 
-	(void)r;
-	(void)g;
-	(void)b;
-	(void)a;
+	(void)icon_path;
 	RING_API_RETNUMBER(0);
 }
 
-/* ============================================================================
- * Navigation & WebView Features
- * ============================================================================ */
-
-RING_FUNC(ring_webview_back)
+RING_FUNC(ring_webview_is_focused)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -2160,12 +8604,20 @@ RING_FUNC(ring_webview_back)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	if (web_view)
+	GtkWindow *window =
+		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (window)
 	{
-		webkit_web_view_go_back(web_view);
-		RING_API_RETNUMBER(1);
+		RING_API_RETNUMBER(gtk_window_is_active(window) ? 1 : 0);
+		return;
+	}
+#endif
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (hwnd)
+	{
+		RING_API_RETNUMBER(GetForegroundWindow() == hwnd ? 1 : 0);
 		return;
 	}
 #endif
@@ -2173,7 +8625,7 @@ RING_FUNC(ring_webview_back)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_forward)
+RING_FUNC(ring_webview_is_visible)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -2194,12 +8646,20 @@ RING_FUNC(ring_webview_forward)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	if (web_view)
+	GtkWindow *window =
+		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (window)
 	{
-		webkit_web_view_go_forward(web_view);
-		RING_API_RETNUMBER(1);
+		RING_API_RETNUMBER(gtk_widget_is_visible(GTK_WIDGET(window)) ? 1 : 0);
+		return;
+	}
+#endif
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (hwnd)
+	{
+		RING_API_RETNUMBER(IsWindowVisible(hwnd) ? 1 : 0);
 		return;
 	}
 #endif
@@ -2207,7 +8667,7 @@ RING_FUNC(ring_webview_forward)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_reload)
+RING_FUNC(ring_webview_close)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -2228,11 +8688,21 @@ RING_FUNC(ring_webview_reload)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	if (web_view)
+	GtkWindow *window =
+		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (window)
 	{
-		webkit_web_view_reload(web_view);
+		gtk_window_close(window);
+		RING_API_RETNUMBER(1);
+		return;
+	}
+#endif
+
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (hwnd)
+	{
+		PostMessage(hwnd, WM_CLOSE, 0, 0);
 		RING_API_RETNUMBER(1);
 		return;
 	}
@@ -2241,7 +8711,7 @@ RING_FUNC(ring_webview_reload)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_dev_tools)
+RING_FUNC(ring_webview_set_force_dark)
 {
 	if (RING_API_PARACOUNT != 2)
 	{
@@ -2264,22 +8734,11 @@ RING_FUNC(ring_webview_set_dev_tools)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	if (web_view)
+	AdwStyleManager *style_manager = adw_style_manager_get_default();
+	if (style_manager)
 	{
-		WebKitSettings *settings = webkit_web_view_get_settings(web_view);
-		webkit_settings_set_enable_developer_extras(settings, enabled ? TRUE : FALSE);
-		if (enabled)
-		{
-			WebKitWebInspector *inspector = webkit_web_view_get_inspector(web_view);
-			webkit_web_inspector_show(inspector);
-		}
-		else
-		{
-			WebKitWebInspector *inspector = webkit_web_view_get_inspector(web_view);
-			webkit_web_inspector_close(inspector);
-		}
+		adw_style_manager_set_color_scheme(style_manager,
+										   enabled ? ADW_COLOR_SCHEME_FORCE_DARK : ADW_COLOR_SCHEME_DEFAULT);
 		RING_API_RETNUMBER(1);
 		return;
 	}
@@ -2289,7 +8748,7 @@ RING_FUNC(ring_webview_set_dev_tools)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_get_url)
+RING_FUNC(ring_webview_is_force_dark)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -2310,23 +8769,19 @@ RING_FUNC(ring_webview_get_url)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	if (web_view)
+	AdwStyleManager *style_manager = adw_style_manager_get_default();
+	if (style_manager)
 	{
-		const char *uri = webkit_web_view_get_uri(web_view);
-		if (uri)
-		{
-			RING_API_RETSTRING(uri);
-			return;
-		}
+		AdwColorScheme scheme = adw_style_manager_get_color_scheme(style_manager);
+		RING_API_RETNUMBER(scheme == ADW_COLOR_SCHEME_FORCE_DARK ? 1 : 0);
+		return;
 	}
 #endif
 
-	RING_API_RETSTRING("");
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_get_title)
+RING_FUNC(ring_webview_get_screens)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -2346,24 +8801,44 @@ RING_FUNC(ring_webview_get_title)
 		return;
 	}
 
+	List *pList = RING_API_NEWLIST;
+
 #ifdef WEBVIEW_PLATFORM_UNIX
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	if (web_view)
+	GdkDisplay *display = gdk_display_get_default();
+	if (display)
 	{
-		const char *title = webkit_web_view_get_title(web_view);
-		if (title)
+		GListModel *monitors = gdk_display_get_monitors(display);
+		guint n_monitors = g_list_model_get_n_items(monitors);
+
+		for (guint i = 0; i < n_monitors; i++)
 		{
-			RING_API_RETSTRING(title);
-			return;
+			GdkMonitor *monitor = (GdkMonitor *)g_list_model_get_item(monitors, i);
+			if (monitor)
+			{
+				GdkRectangle rect;
+				gdk_monitor_get_geometry(monitor, &rect);
+				const char *model = gdk_monitor_get_model(monitor);
+
+				List *pScreenList = ring_list_newlist_gc(((VM *)pPointer)->pRingState, pList);
+				ring_list_addstring_gc(((VM *)pPointer)->pRingState, pScreenList, model ? model : "Unknown");
+				ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pScreenList, (double)rect.x);
+				ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pScreenList, (double)rect.y);
+				ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pScreenList, (double)rect.width);
+				ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pScreenList, (double)rect.height);
+				g_object_unref(monitor);
+			}
 		}
 	}
 #endif
 
-	RING_API_RETSTRING("");
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	EnumDisplayMonitors(NULL, NULL, ring_webview_monitor_enum_proc, (LPARAM)pList);
+#endif
+
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_webview_set_context_menu)
+RING_FUNC(ring_webview_set_click_through)
 {
 	if (RING_API_PARACOUNT != 2)
 	{
@@ -2385,22 +8860,18 @@ RING_FUNC(ring_webview_set_context_menu)
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_UNIX
-	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
-																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
-	if (web_view)
+#ifdef WEBVIEW_PLATFORM_WINDOWS
+	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
+	if (hwnd)
 	{
-		static gulong handler_id = 0;
-
-		if (!enabled && handler_id == 0)
+		LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
+		if (enabled)
 		{
-			handler_id =
-				g_signal_connect(web_view, "context-menu", G_CALLBACK(ring_webview_suppress_context_menu), NULL);
+			SetWindowLongPtr(hwnd, GWL_EXSTYLE, exStyle | WS_EX_TRANSPARENT | WS_EX_LAYERED);
 		}
-		else if (enabled && handler_id != 0)
+		else
 		{
-			g_signal_handler_disconnect(web_view, handler_id);
-			handler_id = 0;
+			SetWindowLongPtr(hwnd, GWL_EXSTYLE, exStyle & ~(WS_EX_TRANSPARENT | WS_EX_LAYERED));
 		}
 		RING_API_RETNUMBER(1);
 		return;
@@ -2411,76 +8882,98 @@ RING_FUNC(ring_webview_set_context_menu)
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_icon)
+RING_FUNC(ring_webview_is_click_through)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	const char *icon_path = RING_API_GETSTRING(2);
-
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window =
-		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (window)
-	{
-		GError *error = NULL;
-		GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(icon_path, &error);
-		if (pixbuf)
-		{
-			GdkTexture *texture = gdk_texture_new_for_pixbuf(pixbuf);
-			gtk_window_set_icon_name(window, NULL);
-			g_object_unref(pixbuf);
-			g_object_unref(texture);
-			RING_API_RETNUMBER(1);
-			return;
-		}
-		if (error)
-			g_error_free(error);
-	}
-#endif
-
 #ifdef WEBVIEW_PLATFORM_WINDOWS
 	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
 	if (hwnd)
 	{
-		HICON hIcon = (HICON)LoadImageA(NULL, icon_path, IMAGE_ICON, 0, 0, LR_LOADFROMFILE | LR_DEFAULTSIZE);
-		if (hIcon)
-		{
-			SendMessage(hwnd, WM_SETICON, ICON_BIG, (LPARAM)hIcon);
-			SendMessage(hwnd, WM_SETICON, ICON_SMALL, (LPARAM)hIcon);
-			RING_API_RETNUMBER(1);
-			return;
-		}
+		LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
+		RING_API_RETNUMBER((exStyle & WS_EX_TRANSPARENT) ? 1 : 0);
+		return;
 	}
 #endif
 
-	(void)icon_path;
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_is_focused)
+// Error message for a region or format that isn't one of the snapshot constants, or NULL.
+static const char *ring_webview_check_snapshot_args(double nRegion, double nFormat)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (nRegion != RING_WEBVIEW_SNAPSHOT_VISIBLE && nRegion != RING_WEBVIEW_SNAPSHOT_FULL_DOCUMENT)
+		return "Snapshot region must be WEBVIEW_SNAPSHOT_VISIBLE or WEBVIEW_SNAPSHOT_FULL_DOCUMENT";
+	if (nFormat != RING_WEBVIEW_SNAPSHOT_PNG && nFormat != RING_WEBVIEW_SNAPSHOT_RGBA)
+		return "Snapshot format must be WEBVIEW_SNAPSHOT_PNG or WEBVIEW_SNAPSHOT_RGBA";
+	return NULL;
+}
+
+RING_FUNC(ring_webview_snapshot)
+{
+	if (RING_API_PARACOUNT != 4)
+	{
+		RING_API_ERROR(RING_API_MISS4PARA);
+		return;
+	}
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2) || !RING_API_ISNUMBER(3) || !RING_API_ISSTRING(4))
+	{
+		RING_API_ERROR(RING_API_BADPARATYPE);
+		return;
+	}
+
+	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
+	if (!pRingWebView || !pRingWebView->webview)
+	{
+		RING_API_ERROR("Invalid webview pointer");
+		return;
+	}
+	const char *cError = ring_webview_check_snapshot_args(RING_API_GETNUMBER(2), RING_API_GETNUMBER(3));
+	if (cError)
+	{
+		RING_API_ERROR(cError);
+		return;
+	}
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	double nId = ++pRingWebView->nSnapshotId;
+	if (ring_webview_snapshot_begin(pRingWebView, (int)RING_API_GETNUMBER(2), (int)RING_API_GETNUMBER(3),
+									RING_API_GETSTRING(4), nId, 0))
+	{
+		RING_API_RETNUMBER(nId);
+		return;
+	}
+	RING_API_RETNUMBER(0);
+#else
+	RING_API_ERROR("Snapshots are only supported on Linux/FreeBSD");
+#endif
+}
+
+RING_FUNC(ring_webview_snapshot_batch)
+{
+	if (RING_API_PARACOUNT != 5)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_BADPARACOUNT);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISLIST(2) || !RING_API_ISNUMBER(3) || !RING_API_ISNUMBER(4) ||
+		!RING_API_ISSTRING(5))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
@@ -2493,36 +8986,76 @@ RING_FUNC(ring_webview_is_focused)
 		return;
 	}
 
+	List *pItems = RING_API_GETLIST(2);
+	unsigned int nItems = ring_list_getsize(pItems);
+	for (unsigned int i = 1; i <= nItems; i++)
+	{
+		if (!ring_list_isstring(pItems, i))
+		{
+			RING_API_ERROR("Snapshot batch items must be URLs or HTML strings");
+			return;
+		}
+	}
+	const char *cError = ring_webview_check_snapshot_args(RING_API_GETNUMBER(3), RING_API_GETNUMBER(4));
+	if (cError)
+	{
+		RING_API_ERROR(cError);
+		return;
+	}
+
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window =
-		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (window)
+	if (pRingWebView->pSnapshotBatch)
 	{
-		RING_API_RETNUMBER(gtk_window_is_active(window) ? 1 : 0);
+		RING_API_ERROR("A snapshot batch is already running");
+		return;
+	}
+	if (nItems == 0)
+	{
+		RING_API_RETNUMBER(0);
 		return;
 	}
-#endif
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (hwnd)
+	RingState *pRingState = pRingWebView->pMainRingState;
+	RingWebViewSnapshotBatch *pBatch =
+		(RingWebViewSnapshotBatch *)ring_state_calloc(pRingState, 1, sizeof(RingWebViewSnapshotBatch));
+	if (!pBatch)
 	{
-		RING_API_RETNUMBER(GetForegroundWindow() == hwnd ? 1 : 0);
+		RING_API_ERROR(RING_OOM);
+		return;
+	}
+	pBatch->aItems = (char **)ring_state_calloc(pRingState, nItems, sizeof(char *));
+	pBatch->cCallback = ring_webview_string_strdup(pRingState, RING_API_GETSTRING(5));
+	int bFailed = !pBatch->aItems || !pBatch->cCallback;
+	for (unsigned int i = 0; !bFailed && i < nItems; i++)
+	{
+		pBatch->aItems[i] = ring_webview_string_strdup(pRingState, ring_list_getstring(pItems, i + 1));
+		pBatch->nItems = i + 1;
+		bFailed = pBatch->aItems[i] == NULL;
+	}
+	if (bFailed)
+	{
+		ring_webview_free_snapshot_batch(pRingState, pBatch);
+		RING_API_ERROR(RING_OOM);
 		return;
 	}
+	pBatch->nRegion = (int)RING_API_GETNUMBER(3);
+	pBatch->nFormat = (int)RING_API_GETNUMBER(4);
+	pRingWebView->pSnapshotBatch = pBatch;
+	ring_webview_snapshot_batch_next(pRingWebView);
+	RING_API_RETNUMBER(nItems);
+#else
+	RING_API_ERROR("Snapshots are only supported on Linux/FreeBSD");
 #endif
-
-	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_is_visible)
+RING_FUNC(ring_webview_print_to_pdf)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 4)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS4PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISSTRING(2) || !RING_API_ISLIST(3) || !RING_API_ISSTRING(4))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
@@ -2536,35 +9069,38 @@ RING_FUNC(ring_webview_is_visible)
 	}
 
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window =
-		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (window)
+	RingWebViewPdfOptions oOptions;
+	if (!ring_webview_pdf_parse_options(RING_API_GETLIST(3), &oOptions))
 	{
-		RING_API_RETNUMBER(gtk_widget_is_visible(GTK_WIDGET(window)) ? 1 : 0);
+		RING_API_ERROR("Invalid PDF options");
 		return;
 	}
-#endif
-
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (hwnd)
+	WebKitWebView *web_view = (WebKitWebView *)webview_get_native_handle(pRingWebView->webview,
+																		 WEBVIEW_NATIVE_HANDLE_KIND_BROWSER_CONTROLLER);
+	double nId = pRingWebView->nPdfId + 1;
+	if (web_view &&
+		ring_webview_pdf_begin(pRingWebView, web_view, RING_API_GETSTRING(2), &oOptions, RING_API_GETSTRING(4), nId,
+							   NULL))
 	{
-		RING_API_RETNUMBER(IsWindowVisible(hwnd) ? 1 : 0);
+		pRingWebView->nPdfId = nId;
+		RING_API_RETNUMBER(nId);
 		return;
 	}
-#endif
-
 	RING_API_RETNUMBER(0);
+#else
+	RING_API_ERROR("PDF export is only supported on Linux/FreeBSD");
+#endif
 }
 
-RING_FUNC(ring_webview_close)
+RING_FUNC(ring_webview_print_batch)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 5)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_BADPARACOUNT);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISLIST(2) || !RING_API_ISLIST(3) || !RING_API_ISSTRING(4) ||
+		!RING_API_ISNUMBER(5))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
@@ -2577,75 +9113,148 @@ RING_FUNC(ring_webview_close)
 		return;
 	}
 
+	List *pJobs = RING_API_GETLIST(2);
+	unsigned int nJobs = ring_list_getsize(pJobs);
+	for (unsigned int i = 1; i <= nJobs; i++)
+	{
+		List *pJob = ring_list_islist(pJobs, i) ? ring_list_getlist(pJobs, i) : NULL;
+		if (!pJob || ring_list_getsize(pJob) != 2 || !ring_list_isstring(pJob, 1) || !ring_list_isstring(pJob, 2))
+		{
+			RING_API_ERROR("PDF batch jobs must be [source, output path] pairs");
+			return;
+		}
+	}
+
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GtkWindow *window =
-		(GtkWindow *)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (window)
+	RingWebViewPdfBatch *pOld = pRingWebView->pPdfBatch;
+	if (pOld && pOld->nDone < pOld->nJobs)
 	{
-		gtk_window_close(window);
-		RING_API_RETNUMBER(1);
+		RING_API_ERROR("A PDF batch is already running");
+		return;
+	}
+	RingWebViewPdfOptions oOptions;
+	if (!ring_webview_pdf_parse_options(RING_API_GETLIST(3), &oOptions))
+	{
+		RING_API_ERROR("Invalid PDF options");
+		return;
+	}
+	if (nJobs == 0)
+	{
+		RING_API_RETNUMBER(0);
 		return;
 	}
-#endif
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (hwnd)
+	RingState *pRingState = pRingWebView->pMainRingState;
+	if (pOld)
 	{
-		PostMessage(hwnd, WM_CLOSE, 0, 0);
-		RING_API_RETNUMBER(1);
+		ring_webview_free_pdf_batch(pRingState, pOld);
+		pRingWebView->pPdfBatch = NULL;
+	}
+	RingWebViewPdfBatch *pBatch =
+		(RingWebViewPdfBatch *)ring_state_calloc(pRingState, 1, sizeof(RingWebViewPdfBatch));
+	if (!pBatch)
+	{
+		RING_API_ERROR(RING_OOM);
 		return;
 	}
-#endif
+	pBatch->aSources = (char **)ring_state_calloc(pRingState, nJobs, sizeof(char *));
+	pBatch->aPaths = (char **)ring_state_calloc(pRingState, nJobs, sizeof(char *));
+	pBatch->cCallback = ring_webview_string_strdup(pRingState, RING_API_GETSTRING(4));
+	int bFailed = !pBatch->aSources || !pBatch->aPaths || !pBatch->cCallback;
+	for (unsigned int i = 0; !bFailed && i < nJobs; i++)
+	{
+		List *pJob = ring_list_getlist(pJobs, i + 1);
+		pBatch->aSources[i] = ring_webview_string_strdup(pRingState, ring_list_getstring(pJob, 1));
+		pBatch->aPaths[i] = ring_webview_string_strdup(pRingState, ring_list_getstring(pJob, 2));
+		pBatch->nJobs = i + 1;
+		bFailed = !pBatch->aSources[i] || !pBatch->aPaths[i];
+	}
+	if (bFailed)
+	{
+		ring_webview_free_pdf_batch(pRingState, pBatch);
+		RING_API_ERROR(RING_OOM);
+		return;
+	}
+	pBatch->pRingWebView = pRingWebView;
+	pBatch->oOptions = oOptions;
 
-	RING_API_RETNUMBER(0);
+	int nWorkers = (int)RING_API_GETNUMBER(5);
+	if (nWorkers < 1)
+		nWorkers = 1;
+	if (nWorkers > RING_WEBVIEW_PDF_MAX_WORKERS)
+		nWorkers = RING_WEBVIEW_PDF_MAX_WORKERS;
+	if ((unsigned int)nWorkers > nJobs)
+		nWorkers = (int)nJobs;
+	for (int i = 0; i < nWorkers; i++)
+	{
+		if (!ring_webview_pdf_add_worker(pBatch))
+			break;
+	}
+	if (pBatch->nWorkers == 0)
+	{
+		ring_webview_free_pdf_batch(pRingState, pBatch);
+		RING_API_ERROR("Failed to create the hidden webviews");
+		return;
+	}
+
+	pRingWebView->pPdfBatch = pBatch;
+	pBatch->nStart = ring_webview_now_ms();
+	for (unsigned int i = 0; i < pBatch->nWorkers; i++)
+		ring_webview_pdf_worker_next(&pBatch->aWorkers[i]);
+	RING_API_RETNUMBER(nJobs);
+#else
+	RING_API_ERROR("PDF export is only supported on Linux/FreeBSD");
+#endif
 }
 
-RING_FUNC(ring_webview_set_force_dark)
+RING_FUNC(ring_webview_print_batch_stats)
 {
-	if (RING_API_PARACOUNT != 2)
+	if (RING_API_PARACOUNT != 1)
 	{
-		RING_API_ERROR(RING_API_MISS2PARA);
+		RING_API_ERROR(RING_API_MISS1PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
+	if (!RING_API_ISCPOINTER(1))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int enabled = (int)RING_API_GETNUMBER(2);
-
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
 
+	List *pList = RING_API_NEWLIST;
+	double nJobs = 0, nDone = 0, nFailed = 0, nElapsed = 0;
 #ifdef WEBVIEW_PLATFORM_UNIX
-	AdwStyleManager *style_manager = adw_style_manager_get_default();
-	if (style_manager)
+	RingWebViewPdfBatch *pBatch = pRingWebView->pPdfBatch;
+	if (pBatch)
 	{
-		adw_style_manager_set_color_scheme(style_manager,
-										   enabled ? ADW_COLOR_SCHEME_FORCE_DARK : ADW_COLOR_SCHEME_DEFAULT);
-		RING_API_RETNUMBER(1);
-		return;
+		nJobs = pBatch->nJobs;
+		nDone = pBatch->nDone;
+		nFailed = pBatch->nFailed;
+		nElapsed = pBatch->nDone < pBatch->nJobs ? ring_webview_now_ms() - pBatch->nStart : pBatch->nElapsed;
 	}
 #endif
-
-	(void)enabled;
-	RING_API_RETNUMBER(0);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nJobs);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nDone);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nFailed);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nElapsed);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nElapsed > 0 ? nDone * 1000.0 / nElapsed : 0);
+	RING_API_RETLIST(pList);
 }
 
-RING_FUNC(ring_webview_is_force_dark)
+RING_FUNC(ring_webview_set_low_memory)
 {
-	if (RING_API_PARACOUNT != 1)
+	if (RING_API_PARACOUNT != 2)
 	{
-		RING_API_ERROR(RING_API_MISS1PARA);
+		RING_API_ERROR(RING_API_MISS2PARA);
 		return;
 	}
-	if (!RING_API_ISCPOINTER(1))
+	if (!RING_API_ISCPOINTER(1) || !RING_API_ISNUMBER(2))
 	{
 		RING_API_ERROR(RING_API_BADPARATYPE);
 		return;
@@ -2658,20 +9267,16 @@ RING_FUNC(ring_webview_is_force_dark)
 		return;
 	}
 
+	pRingWebView->bLowMemory = (int)RING_API_GETNUMBER(2) != 0;
 #ifdef WEBVIEW_PLATFORM_UNIX
-	AdwStyleManager *style_manager = adw_style_manager_get_default();
-	if (style_manager)
-	{
-		AdwColorScheme scheme = adw_style_manager_get_color_scheme(style_manager);
-		RING_API_RETNUMBER(scheme == ADW_COLOR_SCHEME_FORCE_DARK ? 1 : 0);
-		return;
-	}
+	RING_API_RETNUMBER(1);
+	return;
 #endif
 
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_get_screens)
+RING_FUNC(ring_webview_release_memory)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -2691,44 +9296,15 @@ RING_FUNC(ring_webview_get_screens)
 		return;
 	}
 
-	List *pList = RING_API_NEWLIST;
-
 #ifdef WEBVIEW_PLATFORM_UNIX
-	GdkDisplay *display = gdk_display_get_default();
-	if (display)
-	{
-		GListModel *monitors = gdk_display_get_monitors(display);
-		guint n_monitors = g_list_model_get_n_items(monitors);
-
-		for (guint i = 0; i < n_monitors; i++)
-		{
-			GdkMonitor *monitor = (GdkMonitor *)g_list_model_get_item(monitors, i);
-			if (monitor)
-			{
-				GdkRectangle rect;
-				gdk_monitor_get_geometry(monitor, &rect);
-				const char *model = gdk_monitor_get_model(monitor);
-
-				List *pScreenList = ring_list_newlist_gc(((VM *)pPointer)->pRingState, pList);
-				ring_list_addstring_gc(((VM *)pPointer)->pRingState, pScreenList, model ? model : "Unknown");
-				ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pScreenList, (double)rect.x);
-				ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pScreenList, (double)rect.y);
-				ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pScreenList, (double)rect.width);
-				ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pScreenList, (double)rect.height);
-				g_object_unref(monitor);
-			}
-		}
-	}
-#endif
-
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	EnumDisplayMonitors(NULL, NULL, ring_webview_monitor_enum_proc, (LPARAM)pList);
+	RING_API_RETNUMBER(ring_webview_free_engine_memory(pRingWebView));
+	return;
 #endif
 
-	RING_API_RETLIST(pList);
+	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_set_click_through)
+RING_FUNC(ring_webview_set_background_policy)
 {
 	if (RING_API_PARACOUNT != 2)
 	{
@@ -2742,37 +9318,40 @@ RING_FUNC(ring_webview_set_click_through)
 	}
 
 	RingWebView *pRingWebView = (RingWebView *)RING_API_GETCPOINTER(1, "webview_t");
-	int enabled = (int)RING_API_GETNUMBER(2);
-
 	if (!pRingWebView || !pRingWebView->webview)
 	{
 		RING_API_ERROR("Invalid webview pointer");
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (hwnd)
+	int nPolicy = (int)RING_API_GETNUMBER(2);
+	if (nPolicy < RING_WEBVIEW_BACKGROUND_NONE || nPolicy > RING_WEBVIEW_BACKGROUND_PAUSE)
 	{
-		LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
-		if (enabled)
-		{
-			SetWindowLongPtr(hwnd, GWL_EXSTYLE, exStyle | WS_EX_TRANSPARENT | WS_EX_LAYERED);
-		}
-		else
-		{
-			SetWindowLongPtr(hwnd, GWL_EXSTYLE, exStyle & ~(WS_EX_TRANSPARENT | WS_EX_LAYERED));
-		}
-		RING_API_RETNUMBER(1);
+		RING_API_ERROR("Invalid background policy");
 		return;
 	}
+
+#ifdef WEBVIEW_PLATFORM_UNIX
+	if (nPolicy != RING_WEBVIEW_BACKGROUND_NONE && !pRingWebView->bBackgroundScript)
+	{
+		webview_init(pRingWebView->webview, cRingWebViewBackgroundScript);
+		// Also cover the page that is already loaded.
+		webview_eval(pRingWebView->webview, cRingWebViewBackgroundScript);
+		pRingWebView->bBackgroundScript = 1;
+	}
+	ring_webview_mutex_lock(&pRingWebView->oHeldMutex);
+	pRingWebView->nBackgroundPolicy = nPolicy;
+	ring_webview_mutex_unlock(&pRingWebView->oHeldMutex);
+	ring_webview_update_visibility(pRingWebView);
+	ring_webview_apply_background(pRingWebView);
+	RING_API_RETNUMBER(1);
+	return;
 #endif
 
-	(void)enabled;
 	RING_API_RETNUMBER(0);
 }
 
-RING_FUNC(ring_webview_is_click_through)
+RING_FUNC(ring_webview_background_stats)
 {
 	if (RING_API_PARACOUNT != 1)
 	{
@@ -2792,17 +9371,23 @@ RING_FUNC(ring_webview_is_click_through)
 		return;
 	}
 
-#ifdef WEBVIEW_PLATFORM_WINDOWS
-	HWND hwnd = (HWND)webview_get_native_handle(pRingWebView->webview, WEBVIEW_NATIVE_HANDLE_KIND_UI_WINDOW);
-	if (hwnd)
-	{
-		LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
-		RING_API_RETNUMBER((exStyle & WS_EX_TRANSPARENT) ? 1 : 0);
-		return;
-	}
+	List *pList = RING_API_NEWLIST;
+	const char *cVisibility = "visible";
+	double nHeld = 0, nCoalesced = 0, nWaiting = 0;
+#ifdef WEBVIEW_PLATFORM_UNIX
+	ring_webview_mutex_lock(&pRingWebView->oHeldMutex);
+	cVisibility = ring_webview_visibility_name(pRingWebView->nVisibility);
+	nHeld = pRingWebView->nHeldDispatches;
+	nCoalesced = pRingWebView->nCoalescedDispatches;
+	for (RingWebViewDispatch *pDispatch = pRingWebView->pHeld; pDispatch; pDispatch = pDispatch->pNext)
+		nWaiting++;
+	ring_webview_mutex_unlock(&pRingWebView->oHeldMutex);
 #endif
-
-	RING_API_RETNUMBER(0);
+	ring_list_addstring_gc(((VM *)pPointer)->pRingState, pList, cVisibility);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nWaiting);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nHeld);
+	ring_list_adddouble_gc(((VM *)pPointer)->pRingState, pList, nCoalesced);
+	RING_API_RETLIST(pList);
 }
 
 /* ============================================================================
@@ -2939,6 +9524,81 @@ RING_FUNC(ring_get_webview_edge_bottom_right)
 	RING_API_RETNUMBER(10);
 }
 
+RING_FUNC(ring_get_webview_snapshot_visible)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_SNAPSHOT_VISIBLE);
+}
+
+RING_FUNC(ring_get_webview_snapshot_full_document)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_SNAPSHOT_FULL_DOCUMENT);
+}
+
+RING_FUNC(ring_get_webview_snapshot_png)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_SNAPSHOT_PNG);
+}
+
+RING_FUNC(ring_get_webview_snapshot_rgba)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_SNAPSHOT_RGBA);
+}
+
+RING_FUNC(ring_get_webview_background_none)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_BACKGROUND_NONE);
+}
+
+RING_FUNC(ring_get_webview_background_throttle)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_BACKGROUND_THROTTLE);
+}
+
+RING_FUNC(ring_get_webview_background_pause)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_BACKGROUND_PAUSE);
+}
+
+RING_FUNC(ring_get_webview_priority_interactive)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_PRIORITY_INTERACTIVE);
+}
+
+RING_FUNC(ring_get_webview_priority_normal)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_PRIORITY_NORMAL);
+}
+
+RING_FUNC(ring_get_webview_priority_background)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_PRIORITY_BACKGROUND);
+}
+
+RING_FUNC(ring_get_webview_process_model_per_window)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_PROCESS_MODEL_PER_WINDOW);
+}
+
+RING_FUNC(ring_get_webview_process_model_shared)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_PROCESS_MODEL_SHARED);
+}
+
+RING_FUNC(ring_get_webview_cache_model_document_viewer)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_CACHE_MODEL_DOCUMENT_VIEWER);
+}
+
+RING_FUNC(ring_get_webview_cache_model_web_browser)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_CACHE_MODEL_WEB_BROWSER);
+}
+
+RING_FUNC(ring_get_webview_cache_model_document_browser)
+{
+	RING_API_RETNUMBER(RING_WEBVIEW_CACHE_MODEL_DOCUMENT_BROWSER);
+}
+
 /* ============================================================================
  * Event Callback Functions
  * ============================================================================ */
@@ -2950,6 +9610,10 @@ RING_WEBVIEW_SET_EVENT_FUNC(ring_webview_on_dom_ready, cOnDomReady)
 RING_WEBVIEW_SET_EVENT_FUNC(ring_webview_on_load, cOnLoad)
 RING_WEBVIEW_SET_EVENT_FUNC(ring_webview_on_navigate, cOnNavigate)
 RING_WEBVIEW_SET_EVENT_FUNC(ring_webview_on_title, cOnTitle)
+RING_WEBVIEW_SET_EVENT_FUNC(ring_webview_on_stall, cOnStall)
+RING_WEBVIEW_SET_EVENT_FUNC(ring_webview_on_memory, cOnMemory)
+RING_WEBVIEW_SET_EVENT_FUNC(ring_webview_on_visibility, cOnVisibility)
+RING_WEBVIEW_SET_EVENT_FUNC(ring_webview_on_post_error, cOnPostError)
 
 /* ============================================================================
  * Library Initialization
@@ -2959,6 +9623,15 @@ RING_LIBINIT
 {
 	// Core WebView Functions
 	RING_API_REGISTER("webview_create", ring_webview_create);
+	RING_API_REGISTER("webview_set_process_options", ring_webview_set_process_options);
+	RING_API_REGISTER("webview_set_memory_pressure", ring_webview_set_memory_pressure);
+	RING_API_REGISTER("webview_process_memory", ring_webview_process_memory);
+	RING_API_REGISTER("webview_pool_prewarm", ring_webview_pool_prewarm);
+	RING_API_REGISTER("webview_pool_clear", ring_webview_pool_clear);
+	RING_API_REGISTER("webview_pool_stats", ring_webview_pool_stats);
+	RING_API_REGISTER("webview_workers_start", ring_webview_workers_start);
+	RING_API_REGISTER("webview_workers_stop", ring_webview_workers_stop);
+	RING_API_REGISTER("webview_worker_stats", ring_webview_worker_stats);
 	RING_API_REGISTER("webview_destroy", ring_webview_destroy);
 	RING_API_REGISTER("webview_run", ring_webview_run);
 	RING_API_REGISTER("webview_terminate", ring_webview_terminate);
@@ -2972,9 +9645,45 @@ RING_LIBINIT
 	RING_API_REGISTER("webview_eval", ring_webview_eval);
 	RING_API_REGISTER("webview_return", ring_webview_return);
 	RING_API_REGISTER("webview_bind", ring_webview_bind);
+	RING_API_REGISTER("webview_bind_method", ring_webview_bind_method);
 	RING_API_REGISTER("webview_unbind", ring_webview_unbind);
+	RING_API_REGISTER("webview_set_routing", ring_webview_set_routing);
 	RING_API_REGISTER("webview_version", ring_webview_version);
 	RING_API_REGISTER("webview_dispatch", ring_webview_dispatch);
+	RING_API_REGISTER("webview_yield", ring_webview_yield);
+	RING_API_REGISTER("webview_step", ring_webview_step);
+	RING_API_REGISTER("webview_poll_fds", ring_webview_poll_fds);
+	RING_API_REGISTER("webview_set_interval", ring_webview_set_interval);
+	RING_API_REGISTER("webview_set_timeout", ring_webview_set_timeout);
+	RING_API_REGISTER("webview_clear_timer", ring_webview_clear_timer);
+	RING_API_REGISTER("webview_timer_stats", ring_webview_timer_stats);
+	RING_API_REGISTER("webview_spawn", ring_webview_spawn);
+	RING_API_REGISTER("webview_set_isolated", ring_webview_set_isolated);
+	RING_API_REGISTER("webview_window_id", ring_webview_window_id);
+	RING_API_REGISTER("webview_isolate_stats", ring_webview_isolate_stats);
+	RING_API_REGISTER("webview_post", ring_webview_post);
+	RING_API_REGISTER("webview_call_cancelled", ring_webview_call_cancelled);
+	RING_API_REGISTER("webview_cancel_call", ring_webview_cancel_call);
+	RING_API_REGISTER("webview_set_bind_timeout", ring_webview_set_bind_timeout);
+	RING_API_REGISTER("webview_set_bind_priority", ring_webview_set_bind_priority);
+	RING_API_REGISTER("webview_set_starvation_limit", ring_webview_set_starvation_limit);
+	RING_API_REGISTER("webview_scheduler_stats", ring_webview_scheduler_stats);
+	RING_API_REGISTER("webview_scheduler_stats_reset", ring_webview_scheduler_stats_reset);
+	RING_API_REGISTER("webview_call_stats", ring_webview_call_stats);
+	RING_API_REGISTER("webview_bind_stats", ring_webview_bind_stats);
+	RING_API_REGISTER("webview_stats_enable", ring_webview_stats_enable);
+	RING_API_REGISTER("webview_stats", ring_webview_stats);
+	RING_API_REGISTER("webview_stats_reset", ring_webview_stats_reset);
+	RING_API_REGISTER("webview_bind_cache", ring_webview_bind_cache);
+	RING_API_REGISTER("webview_bind_cache_clear", ring_webview_bind_cache_clear);
+	RING_API_REGISTER("webview_bind_cache_stats", ring_webview_bind_cache_stats);
+	RING_API_REGISTER("webview_trace_start", ring_webview_trace_start);
+	RING_API_REGISTER("webview_trace_stop", ring_webview_trace_stop);
+	RING_API_REGISTER("webview_record_start", ring_webview_record_start);
+	RING_API_REGISTER("webview_record_stop", ring_webview_record_stop);
+	RING_API_REGISTER("webview_record_load", ring_webview_record_load);
+	RING_API_REGISTER("webview_watchdog_start", ring_webview_watchdog_start);
+	RING_API_REGISTER("webview_watchdog_stop", ring_webview_watchdog_stop);
 
 	// Window Management Functions
 	RING_API_REGISTER("webview_set_decorated", ring_webview_set_decorated);
@@ -2988,6 +9697,7 @@ RING_LIBINIT
 	RING_API_REGISTER("webview_set_position", ring_webview_set_position);
 	RING_API_REGISTER("webview_get_position", ring_webview_get_position);
 	RING_API_REGISTER("webview_get_size", ring_webview_get_size);
+	RING_API_REGISTER("webview_set_resize_interval", ring_webview_set_resize_interval);
 	RING_API_REGISTER("webview_focus", ring_webview_focus);
 	RING_API_REGISTER("webview_hide", ring_webview_hide);
 	RING_API_REGISTER("webview_show", ring_webview_show);
@@ -3017,6 +9727,15 @@ RING_LIBINIT
 	RING_API_REGISTER("webview_get_screens", ring_webview_get_screens);
 	RING_API_REGISTER("webview_set_click_through", ring_webview_set_click_through);
 	RING_API_REGISTER("webview_is_click_through", ring_webview_is_click_through);
+	RING_API_REGISTER("webview_snapshot", ring_webview_snapshot);
+	RING_API_REGISTER("webview_snapshot_batch", ring_webview_snapshot_batch);
+	RING_API_REGISTER("webview_print_to_pdf", ring_webview_print_to_pdf);
+	RING_API_REGISTER("webview_print_batch", ring_webview_print_batch);
+	RING_API_REGISTER("webview_print_batch_stats", ring_webview_print_batch_stats);
+	RING_API_REGISTER("webview_set_low_memory", ring_webview_set_low_memory);
+	RING_API_REGISTER("webview_release_memory", ring_webview_release_memory);
+	RING_API_REGISTER("webview_set_background_policy", ring_webview_set_background_policy);
+	RING_API_REGISTER("webview_background_stats", ring_webview_background_stats);
 
 	// Event Callback Functions
 	RING_API_REGISTER("webview_on_close", ring_webview_on_close);
@@ -3026,6 +9745,10 @@ RING_LIBINIT
 	RING_API_REGISTER("webview_on_load", ring_webview_on_load);
 	RING_API_REGISTER("webview_on_navigate", ring_webview_on_navigate);
 	RING_API_REGISTER("webview_on_title", ring_webview_on_title);
+	RING_API_REGISTER("webview_on_stall", ring_webview_on_stall);
+	RING_API_REGISTER("webview_on_memory", ring_webview_on_memory);
+	RING_API_REGISTER("webview_on_visibility", ring_webview_on_visibility);
+	RING_API_REGISTER("webview_on_post_error", ring_webview_on_post_error);
 
 	// Constants
 	RING_API_REGISTER("get_webview_hint_none", ring_get_webview_hint_none);
@@ -3055,4 +9778,19 @@ RING_LIBINIT
 	RING_API_REGISTER("get_webview_edge_top_right", ring_get_webview_edge_top_right);
 	RING_API_REGISTER("get_webview_edge_bottom_left", ring_get_webview_edge_bottom_left);
 	RING_API_REGISTER("get_webview_edge_bottom_right", ring_get_webview_edge_bottom_right);
+	RING_API_REGISTER("get_webview_snapshot_visible", ring_get_webview_snapshot_visible);
+	RING_API_REGISTER("get_webview_snapshot_full_document", ring_get_webview_snapshot_full_document);
+	RING_API_REGISTER("get_webview_snapshot_png", ring_get_webview_snapshot_png);
+	RING_API_REGISTER("get_webview_snapshot_rgba", ring_get_webview_snapshot_rgba);
+	RING_API_REGISTER("get_webview_background_none", ring_get_webview_background_none);
+	RING_API_REGISTER("get_webview_background_throttle", ring_get_webview_background_throttle);
+	RING_API_REGISTER("get_webview_background_pause", ring_get_webview_background_pause);
+	RING_API_REGISTER("get_webview_priority_interactive", ring_get_webview_priority_interactive);
+	RING_API_REGISTER("get_webview_priority_normal", ring_get_webview_priority_normal);
+	RING_API_REGISTER("get_webview_priority_background", ring_get_webview_priority_background);
+	RING_API_REGISTER("get_webview_process_model_per_window", ring_get_webview_process_model_per_window);
+	RING_API_REGISTER("get_webview_process_model_shared", ring_get_webview_process_model_shared);
+	RING_API_REGISTER("get_webview_cache_model_document_viewer", ring_get_webview_cache_model_document_viewer);
+	RING_API_REGISTER("get_webview_cache_model_web_browser", ring_get_webview_cache_model_web_browser);
+	RING_API_REGISTER("get_webview_cache_model_document_browser", ring_get_webview_cache_model_document_browser);
 }
\ No newline at end of file
@@ -0,0 +1,247 @@
+/*
+ * ring_webview_cache.h
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ */
+
+#ifndef RING_WEBVIEW_CACHE_H
+#define RING_WEBVIEW_CACHE_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
+
+/* A small LRU cache mapping raw request JSON to the JSON result of a bound
+ * function. Lookups go through a chained hash table keyed by the FNV-1a hash
+ * of the request; the request text is stored too so collisions never return
+ * the wrong result. */
+
+typedef struct RingWebViewCacheEntry
+{
+	uint64_t nHash;
+	char *cReq;
+	char *cResult;
+	double nExpires;
+	struct RingWebViewCacheEntry *pPrev;
+	struct RingWebViewCacheEntry *pNext;
+	struct RingWebViewCacheEntry *pChain;
+} RingWebViewCacheEntry;
+
+typedef struct RingWebViewCache
+{
+	void *pState;
+	unsigned int nMaxSize;
+	unsigned int nSize;
+	unsigned int nBuckets;
+	double nTtlMs;
+	RingWebViewCacheEntry **aBuckets;
+	RingWebViewCacheEntry *pHead;
+	RingWebViewCacheEntry *pTail;
+	double nHits;
+	double nMisses;
+	double nEvictions;
+} RingWebViewCache;
+
+// Monotonic clock in milliseconds.
+static double ring_webview_now_ms(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	LARGE_INTEGER nFreq, nCounter;
+	QueryPerformanceFrequency(&nFreq);
+	QueryPerformanceCounter(&nCounter);
+	return (double)nCounter.QuadPart * 1000.0 / (double)nFreq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+#endif
+}
+
+static uint64_t ring_webview_cache_hash(const char *cStr)
+{
+	uint64_t nHash = 14695981039346656037ULL;
+	while (*cStr)
+	{
+		nHash ^= (unsigned char)*cStr++;
+		nHash *= 1099511628211ULL;
+	}
+	return nHash;
+}
+
+static char *ring_webview_cache_strdup(void *pState, const char *cStr)
+{
+	size_t nSize = strlen(cStr);
+	char *cString = (char *)ring_state_malloc(pState, nSize + 1);
+	if (cString == NULL)
+	{
+		return NULL;
+	}
+	memcpy(cString, cStr, nSize + 1);
+	return cString;
+}
+
+static RingWebViewCache *ring_webview_cache_new(void *pState, unsigned int nMaxSize, double nTtlMs)
+{
+	RingWebViewCache *pCache = (RingWebViewCache *)ring_state_malloc(pState, sizeof(RingWebViewCache));
+	if (pCache == NULL)
+	{
+		return NULL;
+	}
+
+	// Power-of-two bucket count, roughly one bucket per entry.
+	unsigned int nBuckets = 16;
+	while (nBuckets < nMaxSize)
+	{
+		nBuckets <<= 1;
+	}
+
+	pCache->aBuckets =
+		(RingWebViewCacheEntry **)ring_state_calloc(pState, nBuckets, sizeof(RingWebViewCacheEntry *));
+	if (pCache->aBuckets == NULL)
+	{
+		ring_state_free(pState, pCache);
+		return NULL;
+	}
+	pCache->pState = pState;
+	pCache->nMaxSize = nMaxSize;
+	pCache->nSize = 0;
+	pCache->nBuckets = nBuckets;
+	pCache->nTtlMs = nTtlMs;
+	pCache->pHead = NULL;
+	pCache->pTail = NULL;
+	pCache->nHits = 0;
+	pCache->nMisses = 0;
+	pCache->nEvictions = 0;
+	return pCache;
+}
+
+static void ring_webview_cache_unlink(RingWebViewCache *pCache, RingWebViewCacheEntry *pEntry)
+{
+	if (pEntry->pPrev)
+		pEntry->pPrev->pNext = pEntry->pNext;
+	else
+		pCache->pHead = pEntry->pNext;
+	if (pEntry->pNext)
+		pEntry->pNext->pPrev = pEntry->pPrev;
+	else
+		pCache->pTail = pEntry->pPrev;
+	pEntry->pPrev = NULL;
+	pEntry->pNext = NULL;
+}
+
+static void ring_webview_cache_push_front(RingWebViewCache *pCache, RingWebViewCacheEntry *pEntry)
+{
+	pEntry->pPrev = NULL;
+	pEntry->pNext = pCache->pHead;
+	if (pCache->pHead)
+		pCache->pHead->pPrev = pEntry;
+	else
+		pCache->pTail = pEntry;
+	pCache->pHead = pEntry;
+}
+
+static void ring_webview_cache_remove(RingWebViewCache *pCache, RingWebViewCacheEntry *pEntry)
+{
+	RingWebViewCacheEntry **ppLink = &pCache->aBuckets[pEntry->nHash & (pCache->nBuckets - 1)];
+	while (*ppLink)
+	{
+		if (*ppLink == pEntry)
+		{
+			*ppLink = pEntry->pChain;
+			break;
+		}
+		ppLink = &(*ppLink)->pChain;
+	}
+	ring_webview_cache_unlink(pCache, pEntry);
+	ring_state_free(pCache->pState, pEntry->cReq);
+	ring_state_free(pCache->pState, pEntry->cResult);
+	ring_state_free(pCache->pState, pEntry);
+	pCache->nSize--;
+}
+
+// Returns the cached result JSON, or NULL on a miss. Updates the counters.
+static const char *ring_webview_cache_get(RingWebViewCache *pCache, uint64_t nHash, const char *cReq)
+{
+	RingWebViewCacheEntry *pEntry = pCache->aBuckets[nHash & (pCache->nBuckets - 1)];
+	while (pEntry)
+	{
+		if (pEntry->nHash == nHash && strcmp(pEntry->cReq, cReq) == 0)
+		{
+			if (pEntry->nExpires > 0 && ring_webview_now_ms() >= pEntry->nExpires)
+			{
+				ring_webview_cache_remove(pCache, pEntry);
+				break;
+			}
+			ring_webview_cache_unlink(pCache, pEntry);
+			ring_webview_cache_push_front(pCache, pEntry);
+			pCache->nHits++;
+			return pEntry->cResult;
+		}
+		pEntry = pEntry->pChain;
+	}
+	pCache->nMisses++;
+	return NULL;
+}
+
+static void ring_webview_cache_put(RingWebViewCache *pCache, uint64_t nHash, const char *cReq, const char *cResult)
+{
+	RingWebViewCacheEntry *pEntry = pCache->aBuckets[nHash & (pCache->nBuckets - 1)];
+	while (pEntry)
+	{
+		if (pEntry->nHash == nHash && strcmp(pEntry->cReq, cReq) == 0)
+		{
+			ring_webview_cache_remove(pCache, pEntry);
+			break;
+		}
+		pEntry = pEntry->pChain;
+	}
+
+	while (pCache->nSize >= pCache->nMaxSize && pCache->pTail)
+	{
+		ring_webview_cache_remove(pCache, pCache->pTail);
+		pCache->nEvictions++;
+	}
+
+	pEntry = (RingWebViewCacheEntry *)ring_state_malloc(pCache->pState, sizeof(RingWebViewCacheEntry));
+	if (pEntry == NULL)
+	{
+		return;
+	}
+	pEntry->cReq = ring_webview_cache_strdup(pCache->pState, cReq);
+	pEntry->cResult = ring_webview_cache_strdup(pCache->pState, cResult);
+	if (pEntry->cReq == NULL || pEntry->cResult == NULL)
+	{
+		if (pEntry->cReq)
+			ring_state_free(pCache->pState, pEntry->cReq);
+		if (pEntry->cResult)
+			ring_state_free(pCache->pState, pEntry->cResult);
+		ring_state_free(pCache->pState, pEntry);
+		return;
+	}
+	pEntry->nHash = nHash;
+	pEntry->nExpires = pCache->nTtlMs > 0 ? ring_webview_now_ms() + pCache->nTtlMs : 0;
+	pEntry->pChain = pCache->aBuckets[nHash & (pCache->nBuckets - 1)];
+	pCache->aBuckets[nHash & (pCache->nBuckets - 1)] = pEntry;
+	ring_webview_cache_push_front(pCache, pEntry);
+	pCache->nSize++;
+}
+
+static void ring_webview_cache_clear(RingWebViewCache *pCache)
+{
+	while (pCache->pHead)
+	{
+		ring_webview_cache_remove(pCache, pCache->pHead);
+	}
+}
+
+static void ring_webview_cache_free(RingWebViewCache *pCache)
+{
+	ring_webview_cache_clear(pCache);
+	ring_state_free(pCache->pState, pCache->aBuckets);
+	ring_state_free(pCache->pState, pCache);
+}
+
+#endif
@@ -236,4 +236,19 @@ static char *ring_number_to_json_string(double nNumber)
 	return cJson;
 }
 
+/* Encode a string as a JSON string literal, malloc'd (caller frees).
+ * NULL on allocation failure. */
+static char *ring_string_to_json_string(const char *cText)
+{
+	yyjson_mut_doc *pDoc;
+	char *cJson;
+
+	pDoc = yyjson_mut_doc_new(NULL);
+	if (!pDoc)
+		return NULL;
+	cJson = yyjson_mut_val_write(yyjson_mut_str(pDoc, cText), 0, NULL);
+	yyjson_mut_doc_free(pDoc);
+	return cJson;
+}
+
 #endif /* RING_WEBVIEW_JSON_H */
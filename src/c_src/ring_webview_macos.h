@@ -22,6 +22,12 @@ extern "C"
 	int ring_webview_macos_focus(webview_t w);
 	int ring_webview_macos_hide(webview_t w);
 	int ring_webview_macos_show(webview_t w);
+	int ring_webview_macos_pump_events(int nMaxEvents);
+	int ring_webview_macos_step_events(int nTimeoutMs, int nMaxEvents);
+	void *ring_webview_macos_watch_close(webview_t w, int *pClosed);
+	void ring_webview_macos_unwatch_close(void *pObserver);
+	void *ring_webview_macos_timer_start(unsigned int nDelayMs, void (*fCallback)(void *), void *pData);
+	void ring_webview_macos_timer_stop(void *pTimer);
 
 #ifdef __cplusplus
 }
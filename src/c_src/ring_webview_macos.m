@@ -194,3 +194,92 @@ int ring_webview_macos_show(webview_t w)
     [window makeKeyAndOrderFront:nil];
     return 1;
 }
+
+int ring_webview_macos_pump_events(int nMaxEvents)
+{
+    int nEvents = 0;
+    
+    // Running the default run loop mode also drains blocks queued by webview_dispatch().
+    while (nEvents < nMaxEvents) {
+        NSEvent *event = [NSApp nextEventMatchingMask:NSEventMaskAny
+                                            untilDate:[NSDate distantPast]
+                                               inMode:NSDefaultRunLoopMode
+                                              dequeue:YES];
+        if (!event) break;
+        [NSApp sendEvent:event];
+        nEvents++;
+    }
+    
+    return nEvents;
+}
+
+int ring_webview_macos_step_events(int nTimeoutMs, int nMaxEvents)
+{
+    int nEvents = 0;
+    
+    // Wait for the first event (nTimeoutMs < 0 waits forever), then drain the rest.
+    NSDate *until = nTimeoutMs < 0 ? [NSDate distantFuture]
+                                   : [NSDate dateWithTimeIntervalSinceNow:nTimeoutMs / 1000.0];
+    NSEvent *event = [NSApp nextEventMatchingMask:NSEventMaskAny
+                                        untilDate:until
+                                           inMode:NSDefaultRunLoopMode
+                                          dequeue:YES];
+    if (event) {
+        [NSApp sendEvent:event];
+        nEvents++;
+    }
+    
+    return nEvents + ring_webview_macos_pump_events(nMaxEvents - nEvents);
+}
+
+void *ring_webview_macos_watch_close(webview_t w, int *pClosed)
+{
+    if (!w || !pClosed) return NULL;
+    
+    NSWindow *window = (__bridge NSWindow *)webview_get_window(w);
+    if (!window) return NULL;
+    
+    // Closing the window doesn't end a loop driven by webview_step(), so flag it.
+    id observer = [[NSNotificationCenter defaultCenter] addObserverForName:NSWindowWillCloseNotification
+                                                                    object:window
+                                                                     queue:nil
+                                                                usingBlock:^(NSNotification *note) {
+        (void)note;
+        *pClosed = 1;
+    }];
+    return (__bridge_retained void *)observer;
+}
+
+void ring_webview_macos_unwatch_close(void *pObserver)
+{
+    if (!pObserver) return;
+    
+    id observer = (__bridge_transfer id)pObserver;
+    [[NSNotificationCenter defaultCenter] removeObserver:observer];
+}
+
+void *ring_webview_macos_timer_start(unsigned int nDelayMs, void (*fCallback)(void *), void *pData)
+{
+    if (!fCallback) return NULL;
+    
+    // One-shot on the main run loop, in the common modes so run() and webview_step() both fire it.
+    CFRunLoopTimerRef timer = CFRunLoopTimerCreateWithHandler(kCFAllocatorDefault,
+                                                              CFAbsoluteTimeGetCurrent() + nDelayMs / 1000.0,
+                                                              0, 0, 0, ^(CFRunLoopTimerRef fired) {
+        (void)fired;
+        fCallback(pData);
+    });
+    if (!timer) return NULL;
+    
+    CFRunLoopAddTimer(CFRunLoopGetMain(), timer, kCFRunLoopCommonModes);
+    return (void *)timer;
+}
+
+void ring_webview_macos_timer_stop(void *pTimer)
+{
+    if (!pTimer) return;
+    
+    CFRunLoopTimerRef timer = (CFRunLoopTimerRef)pTimer;
+    CFRunLoopTimerInvalidate(timer);
+    CFRelease(timer);
+}
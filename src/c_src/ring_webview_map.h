@@ -0,0 +1,187 @@
+/*
+ * ring_webview_map.h
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ */
+
+#ifndef RING_WEBVIEW_MAP_H
+#define RING_WEBVIEW_MAP_H
+
+#include <stdint.h>
+
+/* A string-keyed hash map with separate chaining. Keys are copied, values
+ * are borrowed. The table doubles once it holds more than one entry per
+ * bucket, so set/get/remove stay O(1) on average. */
+
+#define RING_WEBVIEW_MAP_MIN_BUCKETS 32
+
+typedef struct RingWebViewMapEntry
+{
+	uint32_t nHash;
+	char *cKey;
+	void *pValue;
+	struct RingWebViewMapEntry *pNext;
+} RingWebViewMapEntry;
+
+typedef struct RingWebViewMap
+{
+	void *pState;
+	unsigned int nSize;
+	unsigned int nBuckets;
+	RingWebViewMapEntry **aBuckets;
+} RingWebViewMap;
+
+static uint32_t ring_webview_map_hash(const char *cKey)
+{
+	uint32_t nHash = 2166136261U;
+	while (*cKey)
+	{
+		nHash ^= (unsigned char)*cKey++;
+		nHash *= 16777619U;
+	}
+	return nHash;
+}
+
+static RingWebViewMap *ring_webview_map_new(void *pState)
+{
+	RingWebViewMap *pMap = (RingWebViewMap *)ring_state_malloc(pState, sizeof(RingWebViewMap));
+	if (pMap == NULL)
+	{
+		return NULL;
+	}
+	pMap->aBuckets = (RingWebViewMapEntry **)ring_state_calloc(pState, RING_WEBVIEW_MAP_MIN_BUCKETS,
+															   sizeof(RingWebViewMapEntry *));
+	if (pMap->aBuckets == NULL)
+	{
+		ring_state_free(pState, pMap);
+		return NULL;
+	}
+	pMap->pState = pState;
+	pMap->nSize = 0;
+	pMap->nBuckets = RING_WEBVIEW_MAP_MIN_BUCKETS;
+	return pMap;
+}
+
+static void ring_webview_map_grow(RingWebViewMap *pMap)
+{
+	unsigned int nBuckets = pMap->nBuckets * 2;
+	RingWebViewMapEntry **aBuckets =
+		(RingWebViewMapEntry **)ring_state_calloc(pMap->pState, nBuckets, sizeof(RingWebViewMapEntry *));
+	if (aBuckets == NULL)
+	{
+		// Keep the current table; lookups just get longer chains.
+		return;
+	}
+	for (unsigned int i = 0; i < pMap->nBuckets; i++)
+	{
+		RingWebViewMapEntry *pEntry = pMap->aBuckets[i];
+		while (pEntry)
+		{
+			RingWebViewMapEntry *pNext = pEntry->pNext;
+			pEntry->pNext = aBuckets[pEntry->nHash & (nBuckets - 1)];
+			aBuckets[pEntry->nHash & (nBuckets - 1)] = pEntry;
+			pEntry = pNext;
+		}
+	}
+	ring_state_free(pMap->pState, pMap->aBuckets);
+	pMap->aBuckets = aBuckets;
+	pMap->nBuckets = nBuckets;
+}
+
+static void *ring_webview_map_get(RingWebViewMap *pMap, const char *cKey)
+{
+	uint32_t nHash = ring_webview_map_hash(cKey);
+	RingWebViewMapEntry *pEntry = pMap->aBuckets[nHash & (pMap->nBuckets - 1)];
+	while (pEntry)
+	{
+		if (pEntry->nHash == nHash && strcmp(pEntry->cKey, cKey) == 0)
+		{
+			return pEntry->pValue;
+		}
+		pEntry = pEntry->pNext;
+	}
+	return NULL;
+}
+
+// Inserts or replaces the value for cKey. Returns 0 on allocation failure.
+static int ring_webview_map_set(RingWebViewMap *pMap, const char *cKey, void *pValue)
+{
+	uint32_t nHash = ring_webview_map_hash(cKey);
+	RingWebViewMapEntry *pEntry = pMap->aBuckets[nHash & (pMap->nBuckets - 1)];
+	while (pEntry)
+	{
+		if (pEntry->nHash == nHash && strcmp(pEntry->cKey, cKey) == 0)
+		{
+			pEntry->pValue = pValue;
+			return 1;
+		}
+		pEntry = pEntry->pNext;
+	}
+
+	pEntry = (RingWebViewMapEntry *)ring_state_malloc(pMap->pState, sizeof(RingWebViewMapEntry));
+	if (pEntry == NULL)
+	{
+		return 0;
+	}
+	size_t nLen = strlen(cKey);
+	pEntry->cKey = (char *)ring_state_malloc(pMap->pState, nLen + 1);
+	if (pEntry->cKey == NULL)
+	{
+		ring_state_free(pMap->pState, pEntry);
+		return 0;
+	}
+	memcpy(pEntry->cKey, cKey, nLen + 1);
+	pEntry->nHash = nHash;
+	pEntry->pValue = pValue;
+	pEntry->pNext = pMap->aBuckets[nHash & (pMap->nBuckets - 1)];
+	pMap->aBuckets[nHash & (pMap->nBuckets - 1)] = pEntry;
+	pMap->nSize++;
+
+	if (pMap->nSize > pMap->nBuckets)
+	{
+		ring_webview_map_grow(pMap);
+	}
+	return 1;
+}
+
+// Removes cKey, but only while it still maps to pValue (NULL matches any value).
+static void ring_webview_map_remove(RingWebViewMap *pMap, const char *cKey, void *pValue)
+{
+	uint32_t nHash = ring_webview_map_hash(cKey);
+	RingWebViewMapEntry **ppLink = &pMap->aBuckets[nHash & (pMap->nBuckets - 1)];
+	while (*ppLink)
+	{
+		RingWebViewMapEntry *pEntry = *ppLink;
+		if (pEntry->nHash == nHash && strcmp(pEntry->cKey, cKey) == 0)
+		{
+			if (pValue == NULL || pEntry->pValue == pValue)
+			{
+				*ppLink = pEntry->pNext;
+				ring_state_free(pMap->pState, pEntry->cKey);
+				ring_state_free(pMap->pState, pEntry);
+				pMap->nSize--;
+			}
+			return;
+		}
+		ppLink = &pEntry->pNext;
+	}
+}
+
+static void ring_webview_map_free(RingWebViewMap *pMap)
+{
+	for (unsigned int i = 0; i < pMap->nBuckets; i++)
+	{
+		RingWebViewMapEntry *pEntry = pMap->aBuckets[i];
+		while (pEntry)
+		{
+			RingWebViewMapEntry *pNext = pEntry->pNext;
+			ring_state_free(pMap->pState, pEntry->cKey);
+			ring_state_free(pMap->pState, pEntry);
+			pEntry = pNext;
+		}
+	}
+	ring_state_free(pMap->pState, pMap->aBuckets);
+	ring_state_free(pMap->pState, pMap);
+}
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * ring_webview_process.h
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ */
+
+#ifndef RING_WEBVIEW_PROCESS_H
+#define RING_WEBVIEW_PROCESS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+/* Resident memory and CPU time of this process and the engine processes it
+ * started.
+ *
+ * WebKitGTK runs pages in WebKitWebProcess children, plus a network process
+ * and possibly a GPU process. They may sit below a bubblewrap sandbox, so
+ * every descendant of this process is scanned and the ones whose name starts
+ * with "WebKit" are kept. Linux only; elsewhere nothing is reported. */
+
+#define RING_WEBVIEW_PROCESS_MAX 64
+#define RING_WEBVIEW_PROCESS_SCAN_MAX 4096
+
+typedef struct RingWebViewProcessInfo
+{
+	long nPid;
+	// "ui", "web", "network", "gpu" or "other".
+	const char *cKind;
+	double nRssKb;
+	// User and system CPU time used so far.
+	double nCpuMs;
+} RingWebViewProcessInfo;
+
+#if defined(__linux__)
+typedef struct RingWebViewProcessEntry
+{
+	long nPid;
+	long nParent;
+	double nCpuMs;
+	char cName[32];
+} RingWebViewProcessEntry;
+
+static double ring_webview_process_rss_kb(long nPid)
+{
+	char cPath[64];
+	char cLine[256];
+	double nRss = 0;
+	snprintf(cPath, sizeof(cPath), "/proc/%ld/status", nPid);
+	FILE *pFile = fopen(cPath, "r");
+	if (!pFile)
+		return 0;
+	while (fgets(cLine, sizeof(cLine), pFile))
+	{
+		if (strncmp(cLine, "VmRSS:", 6) == 0)
+		{
+			nRss = strtod(cLine + 6, NULL);
+			break;
+		}
+	}
+	fclose(pFile);
+	return nRss;
+}
+
+// Reads the parent pid, name and CPU time from /proc/<pid>/stat.
+static int ring_webview_process_read_entry(long nPid, RingWebViewProcessEntry *pEntry)
+{
+	char cPath[64];
+	char cStat[512];
+	snprintf(cPath, sizeof(cPath), "/proc/%ld/stat", nPid);
+	FILE *pFile = fopen(cPath, "r");
+	if (!pFile)
+		return 0;
+	size_t nRead = fread(cStat, 1, sizeof(cStat) - 1, pFile);
+	fclose(pFile);
+	cStat[nRead] = '\0';
+
+	// "pid (name) state ppid ...", where the name may itself contain ")".
+	char *pOpen = strchr(cStat, '(');
+	char *pClose = strrchr(cStat, ')');
+	if (!pOpen || !pClose || pClose < pOpen || pClose[1] == '\0')
+		return 0;
+	size_t nName = (size_t)(pClose - pOpen - 1);
+	if (nName >= sizeof(pEntry->cName))
+		nName = sizeof(pEntry->cName) - 1;
+	memcpy(pEntry->cName, pOpen + 1, nName);
+	pEntry->cName[nName] = '\0';
+
+	char cState;
+	long nParent;
+	unsigned long nUserTicks, nSystemTicks;
+	if (sscanf(pClose + 2, "%c %ld %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &cState, &nParent, &nUserTicks,
+			   &nSystemTicks) != 4)
+		return 0;
+	long nTicksPerSec = sysconf(_SC_CLK_TCK);
+	pEntry->nPid = nPid;
+	pEntry->nParent = nParent;
+	pEntry->nCpuMs = nTicksPerSec > 0 ? (double)(nUserTicks + nSystemTicks) * 1000.0 / nTicksPerSec : 0;
+	return 1;
+}
+
+static const char *ring_webview_process_kind(const char *cName)
+{
+	// Names are cut to 15 characters, e.g. "WebKitNetworkPr".
+	if (strncmp(cName, "WebKitWebProc", 13) == 0)
+		return "web";
+	if (strncmp(cName, "WebKitNetwork", 13) == 0)
+		return "network";
+	if (strncmp(cName, "WebKitGPU", 9) == 0)
+		return "gpu";
+	return "other";
+}
+#endif
+
+// Fills aOut with this process first, then its WebKit processes. Returns the count.
+static int ring_webview_process_list(RingWebViewProcessInfo *aOut, int nMax)
+{
+	int nCount = 0;
+#if defined(__linux__)
+	if (nMax < 1)
+		return 0;
+	long nSelf = (long)getpid();
+	RingWebViewProcessEntry oSelf;
+	aOut[nCount].nPid = nSelf;
+	aOut[nCount].cKind = "ui";
+	aOut[nCount].nRssKb = ring_webview_process_rss_kb(nSelf);
+	aOut[nCount].nCpuMs = ring_webview_process_read_entry(nSelf, &oSelf) ? oSelf.nCpuMs : 0;
+	nCount++;
+
+	DIR *pDir = opendir("/proc");
+	if (!pDir)
+		return nCount;
+	RingWebViewProcessEntry *aEntries =
+		(RingWebViewProcessEntry *)malloc(sizeof(RingWebViewProcessEntry) * RING_WEBVIEW_PROCESS_SCAN_MAX);
+	if (!aEntries)
+	{
+		closedir(pDir);
+		return nCount;
+	}
+	int nEntries = 0;
+	struct dirent *pItem;
+	while ((pItem = readdir(pDir)) != NULL && nEntries < RING_WEBVIEW_PROCESS_SCAN_MAX)
+	{
+		char *pEnd;
+		long nPid = strtol(pItem->d_name, &pEnd, 10);
+		if (*pEnd != '\0' || nPid <= 0 || nPid == nSelf)
+			continue;
+		if (ring_webview_process_read_entry(nPid, &aEntries[nEntries]))
+			nEntries++;
+	}
+	closedir(pDir);
+
+	// Keep every entry that has this process as an ancestor.
+	long aAncestors[RING_WEBVIEW_PROCESS_MAX];
+	int nAncestors = 0;
+	aAncestors[nAncestors++] = nSelf;
+	for (int nFound = 1; nFound && nAncestors < RING_WEBVIEW_PROCESS_MAX;)
+	{
+		nFound = 0;
+		for (int i = 0; i < nEntries && nAncestors < RING_WEBVIEW_PROCESS_MAX; i++)
+		{
+			if (aEntries[i].nPid == 0)
+				continue;
+			for (int j = 0; j < nAncestors; j++)
+			{
+				if (aEntries[i].nParent != aAncestors[j])
+					continue;
+				aAncestors[nAncestors++] = aEntries[i].nPid;
+				if (strncmp(aEntries[i].cName, "WebKit", 6) == 0 && nCount < nMax)
+				{
+					aOut[nCount].nPid = aEntries[i].nPid;
+					aOut[nCount].cKind = ring_webview_process_kind(aEntries[i].cName);
+					aOut[nCount].nRssKb = ring_webview_process_rss_kb(aEntries[i].nPid);
+					aOut[nCount].nCpuMs = aEntries[i].nCpuMs;
+					nCount++;
+				}
+				// Visited.
+				aEntries[i].nPid = 0;
+				nFound = 1;
+				break;
+			}
+		}
+	}
+	free(aEntries);
+#else
+	(void)aOut;
+	(void)nMax;
+#endif
+	return nCount;
+}
+
+// Total resident memory of the web processes, in KiB.
+static double ring_webview_process_web_rss_kb(void)
+{
+	RingWebViewProcessInfo aProcesses[RING_WEBVIEW_PROCESS_MAX];
+	int nCount = ring_webview_process_list(aProcesses, RING_WEBVIEW_PROCESS_MAX);
+	double nTotal = 0;
+	for (int i = 0; i < nCount; i++)
+	{
+		if (strcmp(aProcesses[i].cKind, "web") == 0)
+			nTotal += aProcesses[i].nRssKb;
+	}
+	return nTotal;
+}
+
+#endif
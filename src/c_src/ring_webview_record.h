@@ -0,0 +1,201 @@
+/*
+ * ring_webview_record.h
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ */
+
+#ifndef RING_WEBVIEW_RECORD_H
+#define RING_WEBVIEW_RECORD_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// ring_webview_now_ms()
+#include "ring_webview_cache.h"
+#include "ring_webview_thread.h"
+
+/* Bridge traffic recorder.
+ *
+ * File layout: the 8-byte magic "RWVREC1\n", then one record per event:
+ *
+ *   u8      record type (RING_WEBVIEW_RECORD_*)
+ *   varint  microseconds since the previous record
+ *   fields  depending on the type, each string as varint length + bytes:
+ *             CALL      name, id, request JSON
+ *             RETURN    id, zigzag varint status, result JSON
+ *             DISPATCH  Ring code
+ *             EVAL      JavaScript
+ *             EVENT     callback, argument
+ *
+ * Varints are unsigned LEB128. Records can be written from any thread
+ * (dispatch() is usually called from worker threads), so writes are
+ * serialized with a mutex. */
+
+#define RING_WEBVIEW_RECORD_MAGIC "RWVREC1\n"
+#define RING_WEBVIEW_RECORD_MAGIC_SIZE 8
+
+#define RING_WEBVIEW_RECORD_CALL 1
+#define RING_WEBVIEW_RECORD_RETURN 2
+#define RING_WEBVIEW_RECORD_DISPATCH 3
+#define RING_WEBVIEW_RECORD_EVAL 4
+#define RING_WEBVIEW_RECORD_EVENT 5
+
+static FILE *pRingWebViewRecordFile = NULL;
+static RingWebViewMutex oRingWebViewRecordMutex;
+static int bRingWebViewRecordMutexReady = 0;
+static volatile int bRingWebViewRecording = 0;
+static double nRingWebViewRecordLast = 0;
+static double nRingWebViewRecordCount = 0;
+
+static void ring_webview_record_varint(FILE *pFile, uint64_t nValue)
+{
+	unsigned char aBuf[10];
+	int nLen = 0;
+	do
+	{
+		unsigned char c = (unsigned char)(nValue & 0x7F);
+		nValue >>= 7;
+		aBuf[nLen++] = nValue ? (unsigned char)(c | 0x80) : c;
+	} while (nValue);
+	fwrite(aBuf, 1, (size_t)nLen, pFile);
+}
+
+static void ring_webview_record_string(FILE *pFile, const char *cStr)
+{
+	size_t nLen = cStr ? strlen(cStr) : 0;
+	ring_webview_record_varint(pFile, nLen);
+	if (nLen)
+		fwrite(cStr, 1, nLen, pFile);
+}
+
+// Returns 1 on success, 0 if already recording, -1 if cPath can't be opened.
+static int ring_webview_record_begin(const char *cPath)
+{
+	if (!bRingWebViewRecordMutexReady)
+	{
+		ring_webview_mutex_init(&oRingWebViewRecordMutex);
+		bRingWebViewRecordMutexReady = 1;
+	}
+	if (bRingWebViewRecording)
+	{
+		return 0;
+	}
+	FILE *pFile = fopen(cPath, "wb");
+	if (pFile == NULL)
+	{
+		return -1;
+	}
+	fwrite(RING_WEBVIEW_RECORD_MAGIC, 1, RING_WEBVIEW_RECORD_MAGIC_SIZE, pFile);
+
+	ring_webview_mutex_lock(&oRingWebViewRecordMutex);
+	pRingWebViewRecordFile = pFile;
+	nRingWebViewRecordLast = ring_webview_now_ms();
+	nRingWebViewRecordCount = 0;
+	bRingWebViewRecording = 1;
+	ring_webview_mutex_unlock(&oRingWebViewRecordMutex);
+	return 1;
+}
+
+// Returns the number of records written, or -1 if the file couldn't be flushed.
+static double ring_webview_record_end(void)
+{
+	if (!bRingWebViewRecording)
+	{
+		return 0;
+	}
+	ring_webview_mutex_lock(&oRingWebViewRecordMutex);
+	bRingWebViewRecording = 0;
+	int bFailed = ferror(pRingWebViewRecordFile) != 0;
+	if (fclose(pRingWebViewRecordFile) != 0)
+		bFailed = 1;
+	pRingWebViewRecordFile = NULL;
+	double nCount = nRingWebViewRecordCount;
+	ring_webview_mutex_unlock(&oRingWebViewRecordMutex);
+	return bFailed ? -1 : nCount;
+}
+
+// Appends one record; cA..cC are the string fields of nType, nStatus is used by RETURN.
+static void ring_webview_record(int nType, const char *cA, const char *cB, const char *cC, int nStatus)
+{
+	if (!bRingWebViewRecording)
+	{
+		return;
+	}
+	ring_webview_mutex_lock(&oRingWebViewRecordMutex);
+	if (pRingWebViewRecordFile)
+	{
+		FILE *pFile = pRingWebViewRecordFile;
+		double nNow = ring_webview_now_ms();
+		double nDelta = (nNow - nRingWebViewRecordLast) * 1000.0;
+		nRingWebViewRecordLast = nNow;
+
+		fputc(nType, pFile);
+		ring_webview_record_varint(pFile, nDelta > 0 ? (uint64_t)nDelta : 0);
+		switch (nType)
+		{
+		case RING_WEBVIEW_RECORD_CALL:
+			ring_webview_record_string(pFile, cA);
+			ring_webview_record_string(pFile, cB);
+			ring_webview_record_string(pFile, cC);
+			break;
+		case RING_WEBVIEW_RECORD_RETURN:
+			ring_webview_record_string(pFile, cA);
+			ring_webview_record_varint(pFile, ((uint64_t)(int64_t)nStatus << 1) ^ (uint64_t)((int64_t)nStatus >> 63));
+			ring_webview_record_string(pFile, cC);
+			break;
+		case RING_WEBVIEW_RECORD_EVENT:
+			ring_webview_record_string(pFile, cA);
+			ring_webview_record_string(pFile, cB);
+			break;
+		default:
+			ring_webview_record_string(pFile, cA);
+			break;
+		}
+		nRingWebViewRecordCount++;
+	}
+	ring_webview_mutex_unlock(&oRingWebViewRecordMutex);
+}
+
+/* Reading recordings back. */
+
+typedef struct RingWebViewRecordReader
+{
+	const unsigned char *pData;
+	size_t nSize;
+	size_t nPos;
+	int bError;
+} RingWebViewRecordReader;
+
+static uint64_t ring_webview_record_read_varint(RingWebViewRecordReader *pReader)
+{
+	uint64_t nValue = 0;
+	int nShift = 0;
+	while (pReader->nPos < pReader->nSize && nShift < 64)
+	{
+		unsigned char c = pReader->pData[pReader->nPos++];
+		nValue |= (uint64_t)(c & 0x7F) << nShift;
+		if (!(c & 0x80))
+			return nValue;
+		nShift += 7;
+	}
+	pReader->bError = 1;
+	return 0;
+}
+
+// Points *pStr at the next string field (not NUL-terminated) and returns its length.
+static size_t ring_webview_record_read_string(RingWebViewRecordReader *pReader, const char **pStr)
+{
+	uint64_t nLen = ring_webview_record_read_varint(pReader);
+	if (pReader->bError || nLen > pReader->nSize - pReader->nPos)
+	{
+		pReader->bError = 1;
+		*pStr = "";
+		return 0;
+	}
+	*pStr = (const char *)pReader->pData + pReader->nPos;
+	pReader->nPos += (size_t)nLen;
+	return (size_t)nLen;
+}
+
+#endif
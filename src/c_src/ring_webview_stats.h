@@ -0,0 +1,158 @@
+/*
+ * ring_webview_stats.h
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ */
+
+#ifndef RING_WEBVIEW_STATS_H
+#define RING_WEBVIEW_STATS_H
+
+#include <stdint.h>
+
+// ring_webview_now_ms()
+#include "ring_webview_cache.h"
+
+/* Per-name call counters and latency histograms.
+ *
+ * Histograms are log-linear (HDR style): values below 8us get one bucket
+ * each, and every power of two above that is split into 8 sub-buckets, so
+ * any recorded value is known within 12.5%. Values are in microseconds. */
+
+#define RING_WEBVIEW_HIST_SUB_BITS 3
+#define RING_WEBVIEW_HIST_SUB_COUNT (1 << RING_WEBVIEW_HIST_SUB_BITS)
+#define RING_WEBVIEW_HIST_BUCKETS (RING_WEBVIEW_HIST_SUB_COUNT * 40)
+
+typedef struct RingWebViewHistogram
+{
+	double nCount;
+	double nSum;
+	double nMax;
+	uint32_t aBuckets[RING_WEBVIEW_HIST_BUCKETS];
+} RingWebViewHistogram;
+
+typedef struct RingWebViewStats
+{
+	double nCalls;
+	double nErrors;
+	double nBytesIn;
+	double nBytesOut;
+	RingWebViewHistogram hDecode;
+	RingWebViewHistogram hVM;
+	RingWebViewHistogram hMutexWait;
+	RingWebViewHistogram hLatency;
+} RingWebViewStats;
+
+static int ring_webview_hist_index(uint64_t nValue)
+{
+	if (nValue < RING_WEBVIEW_HIST_SUB_COUNT)
+	{
+		return (int)nValue;
+	}
+	int nExp = 0;
+	uint64_t nTemp = nValue;
+	while (nTemp >>= 1)
+	{
+		nExp++;
+	}
+	int nShift = nExp - RING_WEBVIEW_HIST_SUB_BITS;
+	int nIndex = (nShift + 1) * RING_WEBVIEW_HIST_SUB_COUNT +
+				 (int)((nValue >> nShift) & (RING_WEBVIEW_HIST_SUB_COUNT - 1));
+	return nIndex < RING_WEBVIEW_HIST_BUCKETS ? nIndex : RING_WEBVIEW_HIST_BUCKETS - 1;
+}
+
+// Midpoint of the values that fall into bucket nIndex.
+static double ring_webview_hist_value(int nIndex)
+{
+	if (nIndex < RING_WEBVIEW_HIST_SUB_COUNT)
+	{
+		return (double)nIndex;
+	}
+	int nShift = nIndex / RING_WEBVIEW_HIST_SUB_COUNT - 1;
+	double nLow = (double)((uint64_t)(RING_WEBVIEW_HIST_SUB_COUNT + nIndex % RING_WEBVIEW_HIST_SUB_COUNT) << nShift);
+	return nLow + (double)((uint64_t)1 << nShift) / 2.0;
+}
+
+static void ring_webview_hist_record(RingWebViewHistogram *pHist, double nMicros)
+{
+	if (nMicros < 0)
+	{
+		nMicros = 0;
+	}
+	pHist->aBuckets[ring_webview_hist_index((uint64_t)nMicros)]++;
+	pHist->nCount++;
+	pHist->nSum += nMicros;
+	if (nMicros > pHist->nMax)
+	{
+		pHist->nMax = nMicros;
+	}
+}
+
+static double ring_webview_hist_percentile(RingWebViewHistogram *pHist, double nPercent)
+{
+	if (pHist->nCount == 0)
+	{
+		return 0;
+	}
+	double nTarget = pHist->nCount * nPercent / 100.0;
+	double nSeen = 0;
+	for (int i = 0; i < RING_WEBVIEW_HIST_BUCKETS; i++)
+	{
+		nSeen += pHist->aBuckets[i];
+		if (nSeen >= nTarget && pHist->aBuckets[i])
+		{
+			double nValue = ring_webview_hist_value(i);
+			return nValue < pHist->nMax ? nValue : pHist->nMax;
+		}
+	}
+	return pHist->nMax;
+}
+
+static RingWebViewStats *ring_webview_stats_new(void *pState)
+{
+	RingWebViewStats *pStats = (RingWebViewStats *)ring_state_calloc(pState, 1, sizeof(RingWebViewStats));
+	return pStats;
+}
+
+static void ring_webview_stats_clear(RingWebViewStats *pStats)
+{
+	memset(pStats, 0, sizeof(RingWebViewStats));
+}
+
+static void ring_webview_hist_to_list(void *pState, List *pList, const char *cName, RingWebViewHistogram *pHist)
+{
+	List *pPair = ring_list_newlist_gc(pState, pList);
+	ring_list_addstring_gc(pState, pPair, cName);
+	List *pValues = ring_list_newlist_gc(pState, pPair);
+
+	const char *aNames[] = {"count", "mean", "p50", "p90", "p99", "max"};
+	double aValues[] = {pHist->nCount,
+						pHist->nCount ? pHist->nSum / pHist->nCount : 0,
+						ring_webview_hist_percentile(pHist, 50),
+						ring_webview_hist_percentile(pHist, 90),
+						ring_webview_hist_percentile(pHist, 99),
+						pHist->nMax};
+	for (int i = 0; i < 6; i++)
+	{
+		List *pItem = ring_list_newlist_gc(pState, pValues);
+		ring_list_addstring_gc(pState, pItem, aNames[i]);
+		ring_list_adddouble_gc(pState, pItem, aValues[i]);
+	}
+}
+
+static void ring_webview_stats_to_list(void *pState, List *pList, RingWebViewStats *pStats)
+{
+	const char *aNames[] = {"calls", "errors", "bytes_in", "bytes_out"};
+	double aValues[] = {pStats->nCalls, pStats->nErrors, pStats->nBytesIn, pStats->nBytesOut};
+	for (int i = 0; i < 4; i++)
+	{
+		List *pPair = ring_list_newlist_gc(pState, pList);
+		ring_list_addstring_gc(pState, pPair, aNames[i]);
+		ring_list_adddouble_gc(pState, pPair, aValues[i]);
+	}
+	ring_webview_hist_to_list(pState, pList, "decode_us", &pStats->hDecode);
+	ring_webview_hist_to_list(pState, pList, "vm_us", &pStats->hVM);
+	ring_webview_hist_to_list(pState, pList, "mutex_wait_us", &pStats->hMutexWait);
+	ring_webview_hist_to_list(pState, pList, "latency_us", &pStats->hLatency);
+}
+
+#endif
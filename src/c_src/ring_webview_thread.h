@@ -0,0 +1,215 @@
+/*
+ * ring_webview_thread.h
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ */
+
+#ifndef RING_WEBVIEW_THREAD_H
+#define RING_WEBVIEW_THREAD_H
+
+/* Minimal native threads for the library's own helper threads: Win32 on
+ * Windows, pthreads everywhere else. */
+
+#include <stdlib.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+
+typedef HANDLE RingWebViewThread;
+typedef CRITICAL_SECTION RingWebViewMutex;
+typedef CONDITION_VARIABLE RingWebViewCond;
+typedef void (*RingWebViewThreadFunc)(void *pArg);
+
+typedef struct RingWebViewThreadStart
+{
+	RingWebViewThreadFunc pFunc;
+	void *pArg;
+} RingWebViewThreadStart;
+
+static DWORD WINAPI ring_webview_thread_entry(LPVOID pParam)
+{
+	RingWebViewThreadStart oStart = *(RingWebViewThreadStart *)pParam;
+	free(pParam);
+	oStart.pFunc(oStart.pArg);
+	return 0;
+}
+
+// Returns 1 on success.
+static int ring_webview_thread_create(RingWebViewThread *pThread, RingWebViewThreadFunc pFunc, void *pArg)
+{
+	RingWebViewThreadStart *pStart = (RingWebViewThreadStart *)malloc(sizeof(RingWebViewThreadStart));
+	if (pStart == NULL)
+	{
+		return 0;
+	}
+	pStart->pFunc = pFunc;
+	pStart->pArg = pArg;
+	*pThread = CreateThread(NULL, 0, ring_webview_thread_entry, pStart, 0, NULL);
+	if (*pThread == NULL)
+	{
+		free(pStart);
+		return 0;
+	}
+	return 1;
+}
+
+static void ring_webview_thread_join(RingWebViewThread oThread)
+{
+	WaitForSingleObject(oThread, INFINITE);
+	CloseHandle(oThread);
+}
+
+static void ring_webview_mutex_init(RingWebViewMutex *pMutex)
+{
+	InitializeCriticalSection(pMutex);
+}
+
+static void ring_webview_mutex_lock(RingWebViewMutex *pMutex)
+{
+	EnterCriticalSection(pMutex);
+}
+
+static void ring_webview_mutex_unlock(RingWebViewMutex *pMutex)
+{
+	LeaveCriticalSection(pMutex);
+}
+
+static void ring_webview_mutex_destroy(RingWebViewMutex *pMutex)
+{
+	DeleteCriticalSection(pMutex);
+}
+
+static void ring_webview_cond_init(RingWebViewCond *pCond)
+{
+	InitializeConditionVariable(pCond);
+}
+
+// Releases pMutex while waiting and takes it back before returning.
+static void ring_webview_cond_wait(RingWebViewCond *pCond, RingWebViewMutex *pMutex)
+{
+	SleepConditionVariableCS(pCond, pMutex, INFINITE);
+}
+
+static void ring_webview_cond_signal(RingWebViewCond *pCond)
+{
+	WakeConditionVariable(pCond);
+}
+
+static void ring_webview_cond_broadcast(RingWebViewCond *pCond)
+{
+	WakeAllConditionVariable(pCond);
+}
+
+static void ring_webview_cond_destroy(RingWebViewCond *pCond)
+{
+	(void)pCond;
+}
+
+static void ring_webview_sleep_ms(unsigned int nMs)
+{
+	Sleep(nMs);
+}
+
+#else
+#include <pthread.h>
+#include <time.h>
+
+typedef pthread_t RingWebViewThread;
+typedef pthread_mutex_t RingWebViewMutex;
+typedef pthread_cond_t RingWebViewCond;
+typedef void (*RingWebViewThreadFunc)(void *pArg);
+
+typedef struct RingWebViewThreadStart
+{
+	RingWebViewThreadFunc pFunc;
+	void *pArg;
+} RingWebViewThreadStart;
+
+static void *ring_webview_thread_entry(void *pParam)
+{
+	RingWebViewThreadStart oStart = *(RingWebViewThreadStart *)pParam;
+	free(pParam);
+	oStart.pFunc(oStart.pArg);
+	return NULL;
+}
+
+// Returns 1 on success.
+static int ring_webview_thread_create(RingWebViewThread *pThread, RingWebViewThreadFunc pFunc, void *pArg)
+{
+	RingWebViewThreadStart *pStart = (RingWebViewThreadStart *)malloc(sizeof(RingWebViewThreadStart));
+	if (pStart == NULL)
+	{
+		return 0;
+	}
+	pStart->pFunc = pFunc;
+	pStart->pArg = pArg;
+	if (pthread_create(pThread, NULL, ring_webview_thread_entry, pStart) != 0)
+	{
+		free(pStart);
+		return 0;
+	}
+	return 1;
+}
+
+static void ring_webview_thread_join(RingWebViewThread oThread)
+{
+	pthread_join(oThread, NULL);
+}
+
+static void ring_webview_mutex_init(RingWebViewMutex *pMutex)
+{
+	pthread_mutex_init(pMutex, NULL);
+}
+
+static void ring_webview_mutex_lock(RingWebViewMutex *pMutex)
+{
+	pthread_mutex_lock(pMutex);
+}
+
+static void ring_webview_mutex_unlock(RingWebViewMutex *pMutex)
+{
+	pthread_mutex_unlock(pMutex);
+}
+
+static void ring_webview_mutex_destroy(RingWebViewMutex *pMutex)
+{
+	pthread_mutex_destroy(pMutex);
+}
+
+static void ring_webview_cond_init(RingWebViewCond *pCond)
+{
+	pthread_cond_init(pCond, NULL);
+}
+
+// Releases pMutex while waiting and takes it back before returning.
+static void ring_webview_cond_wait(RingWebViewCond *pCond, RingWebViewMutex *pMutex)
+{
+	pthread_cond_wait(pCond, pMutex);
+}
+
+static void ring_webview_cond_signal(RingWebViewCond *pCond)
+{
+	pthread_cond_signal(pCond);
+}
+
+static void ring_webview_cond_broadcast(RingWebViewCond *pCond)
+{
+	pthread_cond_broadcast(pCond);
+}
+
+static void ring_webview_cond_destroy(RingWebViewCond *pCond)
+{
+	pthread_cond_destroy(pCond);
+}
+
+static void ring_webview_sleep_ms(unsigned int nMs)
+{
+	struct timespec ts;
+	ts.tv_sec = nMs / 1000;
+	ts.tv_nsec = (long)(nMs % 1000) * 1000000L;
+	nanosleep(&ts, NULL);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ * ring_webview_trace.h
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ */
+
+#ifndef RING_WEBVIEW_TRACE_H
+#define RING_WEBVIEW_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ring_webview_now_ms()
+#include "ring_webview_cache.h"
+
+/* Bridge tracer. Spans are written into a fixed-size ring buffer by any
+ * thread without locks: a writer claims a slot with an atomic increment and
+ * publishes it by storing its sequence number last. When the buffer wraps,
+ * the oldest spans are overwritten. ring_webview_trace_end_session() dumps the
+ * published spans as Chrome trace-event JSON (chrome://tracing, Perfetto).
+ * Writers are counted while they hold the buffer so ending a session never
+ * frees it under a span that is still being written. */
+
+#define RING_WEBVIEW_TRACE_CAPACITY 65536
+#define RING_WEBVIEW_TRACE_NAME_SIZE 64
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define RING_WEBVIEW_ATOMIC_FETCH_INC(p) ((uint64_t)InterlockedIncrement64((volatile LONG64 *)(p)) - 1)
+#define RING_WEBVIEW_ATOMIC_STORE(p, v) InterlockedExchange64((volatile LONG64 *)(p), (LONG64)(v))
+#define RING_WEBVIEW_ATOMIC_LOAD(p) ((uint64_t)InterlockedCompareExchange64((volatile LONG64 *)(p), 0, 0))
+#define RING_WEBVIEW_ATOMIC_ADD(p, v) ((uint64_t)InterlockedAdd64((volatile LONG64 *)(p), (LONG64)(v)))
+#define RING_WEBVIEW_ATOMIC_FENCE() MemoryBarrier()
+#define RING_WEBVIEW_THREAD_LOCAL __declspec(thread)
+#else
+#define RING_WEBVIEW_ATOMIC_FETCH_INC(p) __atomic_fetch_add((p), 1, __ATOMIC_RELAXED)
+#define RING_WEBVIEW_ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RING_WEBVIEW_ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_WEBVIEW_ATOMIC_ADD(p, v) __atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+#define RING_WEBVIEW_ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define RING_WEBVIEW_THREAD_LOCAL __thread
+#endif
+
+typedef struct RingWebViewTraceEvent
+{
+	// Sequence number + 1 once the slot is fully written; 0 while empty.
+	uint64_t nSeq;
+	double nStart;
+	double nDuration;
+	uint32_t nThread;
+	const char *cCategory;
+	char cName[RING_WEBVIEW_TRACE_NAME_SIZE];
+} RingWebViewTraceEvent;
+
+static RingWebViewTraceEvent *aRingWebViewTrace = NULL;
+static uint64_t nRingWebViewTraceHead = 0;
+static uint64_t nRingWebViewTraceThreads = 0;
+// Spans currently writing into aRingWebViewTrace.
+static uint64_t nRingWebViewTraceWriters = 0;
+static double nRingWebViewTraceOrigin = 0;
+static char *cRingWebViewTracePath = NULL;
+static volatile int bRingWebViewTracing = 0;
+
+// Small per-thread ids so the timeline shows one row per thread.
+static uint32_t ring_webview_trace_thread_id(void)
+{
+	static RING_WEBVIEW_THREAD_LOCAL uint32_t nThread = 0;
+	if (nThread == 0)
+	{
+		nThread = (uint32_t)RING_WEBVIEW_ATOMIC_FETCH_INC(&nRingWebViewTraceThreads) + 1;
+	}
+	return nThread;
+}
+
+static int ring_webview_trace_begin_session(const char *cPath)
+{
+	if (aRingWebViewTrace)
+	{
+		return 0;
+	}
+	cRingWebViewTracePath = (char *)malloc(strlen(cPath) + 1);
+	aRingWebViewTrace = (RingWebViewTraceEvent *)calloc(RING_WEBVIEW_TRACE_CAPACITY, sizeof(RingWebViewTraceEvent));
+	if (aRingWebViewTrace == NULL || cRingWebViewTracePath == NULL)
+	{
+		free(aRingWebViewTrace);
+		free(cRingWebViewTracePath);
+		aRingWebViewTrace = NULL;
+		cRingWebViewTracePath = NULL;
+		return 0;
+	}
+	strcpy(cRingWebViewTracePath, cPath);
+	nRingWebViewTraceHead = 0;
+	nRingWebViewTraceOrigin = ring_webview_now_ms();
+	bRingWebViewTracing = 1;
+	return 1;
+}
+
+// Start time of a span, or 0 when tracing is off (the span is then skipped).
+static double ring_webview_trace_begin(void)
+{
+	return bRingWebViewTracing ? ring_webview_now_ms() : 0;
+}
+
+static void ring_webview_trace_end(const char *cCategory, const char *cName, double nStart)
+{
+	if (!bRingWebViewTracing || nStart == 0)
+	{
+		return;
+	}
+	// Register as a writer before looking at the buffer; recheck the flag afterwards.
+	RING_WEBVIEW_ATOMIC_ADD(&nRingWebViewTraceWriters, 1);
+	RingWebViewTraceEvent *aEvents = bRingWebViewTracing ? aRingWebViewTrace : NULL;
+	if (aEvents == NULL)
+	{
+		RING_WEBVIEW_ATOMIC_ADD(&nRingWebViewTraceWriters, -1);
+		return;
+	}
+
+	uint64_t nSeq = RING_WEBVIEW_ATOMIC_FETCH_INC(&nRingWebViewTraceHead);
+	RingWebViewTraceEvent *pEvent = &aEvents[nSeq & (RING_WEBVIEW_TRACE_CAPACITY - 1)];
+	RING_WEBVIEW_ATOMIC_STORE(&pEvent->nSeq, 0);
+	pEvent->nStart = nStart;
+	pEvent->nDuration = ring_webview_now_ms() - nStart;
+	pEvent->nThread = ring_webview_trace_thread_id();
+	pEvent->cCategory = cCategory;
+	snprintf(pEvent->cName, sizeof(pEvent->cName), "%s", cName ? cName : "");
+	RING_WEBVIEW_ATOMIC_STORE(&pEvent->nSeq, nSeq + 1);
+	RING_WEBVIEW_ATOMIC_ADD(&nRingWebViewTraceWriters, -1);
+}
+
+static void ring_webview_trace_write_string(FILE *pFile, const char *cStr)
+{
+	fputc('"', pFile);
+	for (; *cStr; cStr++)
+	{
+		unsigned char c = (unsigned char)*cStr;
+		if (c == '"' || c == '\\')
+			fprintf(pFile, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(pFile, "\\u%04x", c);
+		else
+			fputc(c, pFile);
+	}
+	fputc('"', pFile);
+}
+
+/* Stops recording and writes the spans to the path given when tracing
+ * started. Returns the number of spans written, or -1 if the file could not
+ * be written. Call it from the UI thread. */
+static long ring_webview_trace_end_session(void)
+{
+	if (!aRingWebViewTrace)
+	{
+		return 0;
+	}
+	bRingWebViewTracing = 0;
+	// Let spans that saw the flag still set finish before the buffer is read and freed.
+	RING_WEBVIEW_ATOMIC_FENCE();
+	while (RING_WEBVIEW_ATOMIC_LOAD(&nRingWebViewTraceWriters) != 0)
+	{
+	}
+
+	long nWritten = -1;
+	FILE *pFile = fopen(cRingWebViewTracePath, "wb");
+	if (pFile)
+	{
+		uint64_t nHead = RING_WEBVIEW_ATOMIC_LOAD(&nRingWebViewTraceHead);
+		uint64_t nFirst = nHead > RING_WEBVIEW_TRACE_CAPACITY ? nHead - RING_WEBVIEW_TRACE_CAPACITY : 0;
+		nWritten = 0;
+		fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", pFile);
+		for (uint64_t nSeq = nFirst; nSeq < nHead; nSeq++)
+		{
+			RingWebViewTraceEvent *pEvent = &aRingWebViewTrace[nSeq & (RING_WEBVIEW_TRACE_CAPACITY - 1)];
+			// Skip slots still being written or already reused by a later span.
+			if (RING_WEBVIEW_ATOMIC_LOAD(&pEvent->nSeq) != nSeq + 1)
+			{
+				continue;
+			}
+			fputs(nWritten ? ",\n{\"name\":" : "\n{\"name\":", pFile);
+			ring_webview_trace_write_string(pFile, pEvent->cName);
+			fprintf(pFile, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+					pEvent->cCategory, (pEvent->nStart - nRingWebViewTraceOrigin) * 1000.0,
+					pEvent->nDuration * 1000.0, pEvent->nThread);
+			nWritten++;
+		}
+		fputs("\n]}\n", pFile);
+		if (fclose(pFile) != 0)
+		{
+			nWritten = -1;
+		}
+	}
+
+	free(aRingWebViewTrace);
+	free(cRingWebViewTracePath);
+	aRingWebViewTrace = NULL;
+	cRingWebViewTracePath = NULL;
+	return nWritten;
+}
+
+#endif
@@ -0,0 +1,320 @@
+/*
+ * ring_webview_watchdog.h
+ * This file is part of the Ring WebView library.
+ * Author: Youssef Saeed (ysdragon) <youssefelkholey@gmail.com>
+ */
+
+#ifndef RING_WEBVIEW_WATCHDOG_H
+#define RING_WEBVIEW_WATCHDOG_H
+
+#include <stdio.h>
+#include <string.h>
+
+// ring_webview_now_ms()
+#include "ring_webview_cache.h"
+#include "ring_webview_thread.h"
+
+/* Main-thread stall watchdog.
+ *
+ * Every bound call, event callback and dispatch pushes its name on a small
+ * stack when it starts running Ring code and pops it when it returns. A
+ * helper thread polls that stack; once the outermost handler has been
+ * running for longer than the threshold, the stall is logged right away and
+ * a report is queued. The report is handed to Ring on the main thread once
+ * the stall is over, since Ring code can't run while the thread is stuck. */
+
+#define RING_WEBVIEW_WATCHDOG_MAX_STACK 16
+#define RING_WEBVIEW_WATCHDOG_NAME_SIZE 128
+#define RING_WEBVIEW_WATCHDOG_REPORT_SIZE 2048
+
+typedef struct RingWebViewWatchdog
+{
+	RingWebViewMutex oMutex;
+	int bMutexReady;
+	RingWebViewThread oThread;
+	volatile int bRunning;
+	double nThresholdMs;
+	FILE *pLog;
+	// Webview whose onStall callback receives the reports.
+	void *pOwner;
+
+	// Handlers currently running on the main thread, outermost first.
+	int nDepth;
+	char aStack[RING_WEBVIEW_WATCHDOG_MAX_STACK][RING_WEBVIEW_WATCHDOG_NAME_SIZE];
+	double nBusySince;
+
+	// The running handler already passed the threshold; its stack at that time.
+	int bStalled;
+	int nStallDepth;
+	char aStallStack[RING_WEBVIEW_WATCHDOG_MAX_STACK][RING_WEBVIEW_WATCHDOG_NAME_SIZE];
+
+	int bReportPending;
+	char cReport[RING_WEBVIEW_WATCHDOG_REPORT_SIZE];
+} RingWebViewWatchdog;
+
+static RingWebViewWatchdog oRingWebViewWatchdog;
+
+static const char *ring_webview_watchdog_stall_name(void)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	int nTop = pDog->nStallDepth < RING_WEBVIEW_WATCHDOG_MAX_STACK ? pDog->nStallDepth : RING_WEBVIEW_WATCHDOG_MAX_STACK;
+	return nTop > 0 ? pDog->aStallStack[nTop - 1] : "";
+}
+
+static void ring_webview_watchdog_stall_stack(char *cBuf, size_t nSize, const char *cSeparator)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	int nTop = pDog->nStallDepth < RING_WEBVIEW_WATCHDOG_MAX_STACK ? pDog->nStallDepth : RING_WEBVIEW_WATCHDOG_MAX_STACK;
+	size_t nUsed = 0;
+	cBuf[0] = '\0';
+	for (int i = 0; i < nTop && nUsed < nSize; i++)
+	{
+		int nWritten = snprintf(cBuf + nUsed, nSize - nUsed, "%s%s", i ? cSeparator : "", pDog->aStallStack[i]);
+		if (nWritten < 0)
+			break;
+		nUsed += (size_t)nWritten;
+	}
+}
+
+// Appends cStr to cBuf as a JSON string.
+static size_t ring_webview_watchdog_json_string(char *cBuf, size_t nSize, size_t nUsed, const char *cStr)
+{
+	if (nUsed + 2 >= nSize)
+		return nUsed;
+	cBuf[nUsed++] = '"';
+	for (; *cStr && nUsed + 8 < nSize; cStr++)
+	{
+		unsigned char c = (unsigned char)*cStr;
+		if (c == '"' || c == '\\')
+		{
+			cBuf[nUsed++] = '\\';
+			cBuf[nUsed++] = (char)c;
+		}
+		else if (c < 0x20)
+			nUsed += (size_t)snprintf(cBuf + nUsed, nSize - nUsed, "\\u%04x", c);
+		else
+			cBuf[nUsed++] = (char)c;
+	}
+	cBuf[nUsed++] = '"';
+	cBuf[nUsed] = '\0';
+	return nUsed;
+}
+
+// Called with the mutex held when a stalled handler finally returns.
+static void ring_webview_watchdog_end_stall(double nElapsedMs)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	char *cReport = pDog->cReport;
+	size_t nSize = sizeof(pDog->cReport);
+	size_t nUsed = (size_t)snprintf(cReport, nSize, "{\"name\":");
+	nUsed = ring_webview_watchdog_json_string(cReport, nSize, nUsed, ring_webview_watchdog_stall_name());
+	nUsed += (size_t)snprintf(cReport + nUsed, nSize - nUsed, ",\"elapsed_ms\":%.1f,\"stack\":[", nElapsedMs);
+	int nTop = pDog->nStallDepth < RING_WEBVIEW_WATCHDOG_MAX_STACK ? pDog->nStallDepth : RING_WEBVIEW_WATCHDOG_MAX_STACK;
+	for (int i = 0; i < nTop && nUsed + 4 < nSize; i++)
+	{
+		if (i)
+			cReport[nUsed++] = ',';
+		nUsed = ring_webview_watchdog_json_string(cReport, nSize, nUsed, pDog->aStallStack[i]);
+	}
+	if (nUsed + 3 < nSize)
+		snprintf(cReport + nUsed, nSize - nUsed, "]}");
+	pDog->bReportPending = 1;
+
+	if (pDog->pLog)
+	{
+		fprintf(pDog->pLog, "ring-webview: stall in %s ended after %.0f ms\n", ring_webview_watchdog_stall_name(),
+				nElapsedMs);
+		fflush(pDog->pLog);
+	}
+	pDog->bStalled = 0;
+}
+
+static void ring_webview_watchdog_thread(void *pArg)
+{
+	RingWebViewWatchdog *pDog = (RingWebViewWatchdog *)pArg;
+	double nPoll = pDog->nThresholdMs / 4;
+	unsigned int nPollMs = nPoll < 5 ? 5 : (nPoll > 100 ? 100 : (unsigned int)nPoll);
+
+	while (pDog->bRunning)
+	{
+		ring_webview_sleep_ms(nPollMs);
+		ring_webview_mutex_lock(&pDog->oMutex);
+		if (pDog->nDepth > 0 && !pDog->bStalled)
+		{
+			double nElapsedMs = ring_webview_now_ms() - pDog->nBusySince;
+			if (nElapsedMs >= pDog->nThresholdMs)
+			{
+				pDog->bStalled = 1;
+				pDog->nStallDepth = pDog->nDepth;
+				memcpy(pDog->aStallStack, pDog->aStack, sizeof(pDog->aStack));
+				if (pDog->pLog)
+				{
+					char cStack[RING_WEBVIEW_WATCHDOG_REPORT_SIZE];
+					ring_webview_watchdog_stall_stack(cStack, sizeof(cStack), " > ");
+					fprintf(pDog->pLog, "ring-webview: main thread stalled for %.0f ms in %s (stack: %s)\n",
+							nElapsedMs, ring_webview_watchdog_stall_name(), cStack);
+					fflush(pDog->pLog);
+				}
+			}
+		}
+		ring_webview_mutex_unlock(&pDog->oMutex);
+	}
+}
+
+/* Starts watching the main thread. cLogPath may be NULL. Returns 1 on
+ * success, 0 if the watchdog is already running, -1 if the log file can't be
+ * opened and -2 if the thread can't be started. */
+static int ring_webview_watchdog_begin(void *pOwner, double nThresholdMs, const char *cLogPath)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	if (pDog->bRunning)
+	{
+		return 0;
+	}
+	if (!pDog->bMutexReady)
+	{
+		ring_webview_mutex_init(&pDog->oMutex);
+		pDog->bMutexReady = 1;
+	}
+
+	FILE *pLog = NULL;
+	if (cLogPath && cLogPath[0])
+	{
+		pLog = fopen(cLogPath, "a");
+		if (pLog == NULL)
+		{
+			return -1;
+		}
+	}
+
+	ring_webview_mutex_lock(&pDog->oMutex);
+	pDog->pOwner = pOwner;
+	pDog->nThresholdMs = nThresholdMs;
+	pDog->pLog = pLog;
+	pDog->nDepth = 0;
+	pDog->nBusySince = 0;
+	pDog->bStalled = 0;
+	pDog->bReportPending = 0;
+	pDog->bRunning = 1;
+	ring_webview_mutex_unlock(&pDog->oMutex);
+
+	if (!ring_webview_thread_create(&pDog->oThread, ring_webview_watchdog_thread, pDog))
+	{
+		pDog->bRunning = 0;
+		pDog->pOwner = NULL;
+		pDog->pLog = NULL;
+		if (pLog)
+			fclose(pLog);
+		return -2;
+	}
+	return 1;
+}
+
+// Stops the watchdog thread. Must be called from the main thread.
+static int ring_webview_watchdog_end(void)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	if (!pDog->bRunning)
+	{
+		return 0;
+	}
+	pDog->bRunning = 0;
+	ring_webview_thread_join(pDog->oThread);
+	if (pDog->pLog)
+	{
+		fclose(pDog->pLog);
+		pDog->pLog = NULL;
+	}
+	pDog->pOwner = NULL;
+	pDog->bReportPending = 0;
+	return 1;
+}
+
+// A handler starts running Ring code on the main thread.
+static void ring_webview_watchdog_enter(const char *cKind, const char *cName)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	if (!pDog->bRunning)
+	{
+		return;
+	}
+	ring_webview_mutex_lock(&pDog->oMutex);
+	if (pDog->nDepth == 0)
+	{
+		pDog->nBusySince = ring_webview_now_ms();
+		pDog->bStalled = 0;
+	}
+	if (pDog->nDepth < RING_WEBVIEW_WATCHDOG_MAX_STACK)
+	{
+		if (cName)
+			snprintf(pDog->aStack[pDog->nDepth], RING_WEBVIEW_WATCHDOG_NAME_SIZE, "%s:%s", cKind, cName);
+		else
+			snprintf(pDog->aStack[pDog->nDepth], RING_WEBVIEW_WATCHDOG_NAME_SIZE, "%s", cKind);
+	}
+	pDog->nDepth++;
+	ring_webview_mutex_unlock(&pDog->oMutex);
+}
+
+// The innermost handler returned.
+static void ring_webview_watchdog_leave(void)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	if (!pDog->bRunning)
+	{
+		return;
+	}
+	ring_webview_mutex_lock(&pDog->oMutex);
+	if (pDog->nDepth > 0)
+	{
+		pDog->nDepth--;
+		if (pDog->nDepth == 0)
+		{
+			if (pDog->bStalled)
+				ring_webview_watchdog_end_stall(ring_webview_now_ms() - pDog->nBusySince);
+			pDog->nBusySince = 0;
+		}
+	}
+	ring_webview_mutex_unlock(&pDog->oMutex);
+}
+
+// The main loop ran again (e.g. inside webview_yield()); restart the clock.
+static void ring_webview_watchdog_heartbeat(void)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	if (!pDog->bRunning)
+	{
+		return;
+	}
+	ring_webview_mutex_lock(&pDog->oMutex);
+	if (pDog->nDepth > 0)
+	{
+		double nNow = ring_webview_now_ms();
+		if (pDog->bStalled)
+			ring_webview_watchdog_end_stall(nNow - pDog->nBusySince);
+		pDog->nBusySince = nNow;
+	}
+	ring_webview_mutex_unlock(&pDog->oMutex);
+}
+
+/* Takes the queued stall report, if any. Returns the owning webview and
+ * copies the report JSON into cBuf, or returns NULL. */
+static void *ring_webview_watchdog_take_report(char *cBuf, size_t nSize)
+{
+	RingWebViewWatchdog *pDog = &oRingWebViewWatchdog;
+	if (!pDog->bRunning || !pDog->bReportPending)
+	{
+		return NULL;
+	}
+	ring_webview_mutex_lock(&pDog->oMutex);
+	void *pOwner = NULL;
+	if (pDog->bReportPending)
+	{
+		snprintf(cBuf, nSize, "%s", pDog->cReport);
+		pDog->bReportPending = 0;
+		pOwner = pDog->pOwner;
+	}
+	ring_webview_mutex_unlock(&pDog->oMutex);
+	return pOwner;
+}
+
+#endif